@@ -1,4 +1,5 @@
 #include "common.h"
+#include "primitives.h"
 #include "bitstream.h"
 #include "threading.h"
 
@@ -125,3 +126,38 @@ void SyntaxElementWriter::writeUvlc(uint32_t code)
     m_bitIf->write(0, length >> 1);
     m_bitIf->write(code, (length + 1) >> 1);
 }
+
+namespace {
+/* 7.4.1 ...
+ * Within the NAL unit, the following three-byte sequences shall not occur at
+ * any byte-aligned position:
+ *  - 0x000000
+ *  - 0x000001
+ *  - 0x000002 */
+uint32_t nalEscape_c(uint8_t* dst, const uint8_t* src, uint32_t size)
+{
+    uint32_t bytes = 0;
+
+    for (uint32_t i = 0; i < size; i++)
+    {
+        if (bytes >= 2 && !dst[bytes - 2] && !dst[bytes - 1] && src[i] <= 0x03)
+        {
+            /* inject 0x03 to prevent emulating a start code */
+            dst[bytes++] = 3;
+        }
+
+        dst[bytes++] = src[i];
+    }
+
+    return bytes;
+}
+}
+
+namespace X265_NS {
+// x265 private namespace
+
+void setupNalPrimitives_c(EncoderPrimitives &p)
+{
+    p.nalEscape = nalEscape_c;
+}
+}
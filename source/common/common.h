@@ -42,8 +42,8 @@
 
 #include "x265.h"
 
-#if ENABLE_PPA && ENABLE_VTUNE
-#error "PPA and VTUNE cannot both be enabled. Disable one of them."
+#if (ENABLE_PPA + ENABLE_VTUNE + ENABLE_TRACE) > 1
+#error "Only one of PPA, VTUNE and TRACE can be enabled. Disable the others."
 #endif
 #if ENABLE_PPA
 #include "profile/PPA/ppa.h"
@@ -59,6 +59,13 @@
 #define PROFILE_INIT()       vtuneInit()
 #define PROFILE_PAUSE()      __itt_pause()
 #define PROFILE_RESUME()     __itt_resume()
+#elif ENABLE_TRACE
+#include "profile/trace/trace.h"
+#define ProfileScopeEvent(x) TraceScopeEvent _traceEvent(x)
+#define THREAD_NAME(n,i)     traceSetThreadName(n, i)
+#define PROFILE_INIT()
+#define PROFILE_PAUSE()
+#define PROFILE_RESUME()
 #else
 #define ProfileScopeEvent(x)
 #define THREAD_NAME(n,i)
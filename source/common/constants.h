@@ -93,6 +93,8 @@ extern const uint8_t g_intraFilterFlags[NUM_INTRA_MODE];
 
 extern const uint32_t g_depthScanIdx[8][8];
 
+extern const uint16_t g_crc16Table[256];
+
 extern const double g_YUVtoRGB_BT2020[3][3];
 
 #define MIN_HDR_LEGAL_RANGE 64
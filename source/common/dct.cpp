@@ -1068,6 +1068,46 @@ static void psyRdoQuant_c_2(int16_t *m_resiDctCoeff, int16_t *m_fencDctCoeff, in
 	}
 }
 
+/* Per coefficient group, everything RDOQ needs that does not depend on the
+ * CABAC context state: the uncoded cost of each coefficient (written to
+ * costUncoded at its block position) and, for the quantized level L and for
+ * max(L - 1, 0), the unquantized level and its scaled squared distortion.
+ * levelDist and unquantLevel are indexed by raster position within the 4x4
+ * group, [0..15] for L and [16..31] for the lower candidate */
+template<int log2TrSize>
+static void rdoQuantLevelDist_c(const int16_t *m_resiDctCoeff, const int16_t *dstCoeff, const int32_t *unquantScale, int64_t *costUncoded, int64_t *levelDist, int32_t *unquantLevel, uint32_t blkPos, int per, int unquantShift)
+{
+    const int transformShift = MAX_TR_DYNAMIC_RANGE - X265_DEPTH - log2TrSize; /* Represents scaling through forward transform */
+    const int scaleBits = SCALE_BITS - 2 * transformShift;
+    const uint32_t trSize = 1 << log2TrSize;
+    const uint32_t unquantRound = (unquantShift > per) ? 1 << (unquantShift - per - 1) : 0;
+
+    for (int y = 0; y < MLS_CG_SIZE; y++)
+    {
+        for (int x = 0; x < MLS_CG_SIZE; x++)
+        {
+            const int idx = y * MLS_CG_SIZE + x;
+            const int signCoef = m_resiDctCoeff[blkPos + x];
+            const uint32_t level = dstCoeff[blkPos + x];
+            const uint32_t levelScale = (uint32_t)unquantScale[blkPos + x] << per;
+
+            costUncoded[blkPos + x] = ((int64_t)signCoef * signCoef) << scaleBits;
+
+            /* unsigned arithmetic, matching the wrap-around of UNQUANT() in rdoQuant */
+            const int unquant0 = (int)((level * levelScale + unquantRound) >> unquantShift);
+            const int unquant1 = (int)(((level - !!level) * levelScale + unquantRound) >> unquantShift);
+            const int d0 = abs(signCoef) - unquant0;
+            const int d1 = abs(signCoef) - unquant1;
+
+            unquantLevel[idx] = unquant0;
+            unquantLevel[MLS_CG_BLK_SIZE + idx] = unquant1;
+            levelDist[idx] = ((int64_t)d0 * d0) << scaleBits;
+            levelDist[MLS_CG_BLK_SIZE + idx] = ((int64_t)d1 * d1) << scaleBits;
+        }
+        blkPos += trSize;
+    }
+}
+
 namespace X265_NS {
 // x265 private namespace
 void setupDCTPrimitives_c(EncoderPrimitives& p)
@@ -1112,6 +1152,10 @@ void setupDCTPrimitives_c(EncoderPrimitives& p)
 	p.cu[BLOCK_16x16].psyRdoQuant_2p = psyRdoQuant_c_2<4>;
 	p.cu[BLOCK_32x32].psyRdoQuant_1p = psyRdoQuant_c_1<5>;
 	p.cu[BLOCK_32x32].psyRdoQuant_2p = psyRdoQuant_c_2<5>;
+    p.cu[BLOCK_4x4].rdoQuantLevelDist   = rdoQuantLevelDist_c<2>;
+    p.cu[BLOCK_8x8].rdoQuantLevelDist   = rdoQuantLevelDist_c<3>;
+    p.cu[BLOCK_16x16].rdoQuantLevelDist = rdoQuantLevelDist_c<4>;
+    p.cu[BLOCK_32x32].rdoQuantLevelDist = rdoQuantLevelDist_c<5>;
     p.scanPosLast = scanPosLast_c;
     p.findPosFirstLast = findPosFirstLast_c;
     p.costCoeffNxN = costCoeffNxN_c;
@@ -58,9 +58,6 @@ Frame::Frame()
     m_classifyFrame = false;
     m_fieldNum = 0;
     m_picStruct = 0;
-    m_edgePic = NULL;
-    m_gaussianPic = NULL;
-    m_thetaPic = NULL;
     m_edgeBitPlane = NULL;
     m_edgeBitPic = NULL;
     m_isInsideWindow = 0;
@@ -104,20 +101,6 @@ bool Frame::create(x265_param *param, float* quantOffsets)
         CHECKED_MALLOC_ZERO(m_classifyCount, uint32_t, size);
     }
 
-    if (param->rc.aqMode == X265_AQ_EDGE || (param->rc.zonefileCount && param->rc.aqMode != 0))
-    {
-        uint32_t numCuInWidth = (param->sourceWidth + param->maxCUSize - 1) / param->maxCUSize;
-        uint32_t numCuInHeight = (param->sourceHeight + param->maxCUSize - 1) / param->maxCUSize;
-        uint32_t m_lumaMarginX = param->maxCUSize + 32; // search margin and 8-tap filter half-length, padded for 32-byte alignment
-        uint32_t m_lumaMarginY = param->maxCUSize + 16; // margin for 8-tap filter and infinite padding
-        intptr_t m_stride = (numCuInWidth * param->maxCUSize) + (m_lumaMarginX << 1);
-        int maxHeight = numCuInHeight * param->maxCUSize;
-
-        m_edgePic = X265_MALLOC(pixel, m_stride * (maxHeight + (m_lumaMarginY * 2)));
-        m_gaussianPic = X265_MALLOC(pixel, m_stride * (maxHeight + (m_lumaMarginY * 2)));
-        m_thetaPic = X265_MALLOC(pixel, m_stride * (maxHeight + (m_lumaMarginY * 2)));
-    }
-
     if (param->recursionSkipMode == EDGE_BASED_RSKIP)
     {
         uint32_t numCuInWidth = (param->sourceWidth + param->maxCUSize - 1) / param->maxCUSize;
@@ -277,13 +260,6 @@ void Frame::destroy()
         X265_FREE_ZERO(m_classifyCount);
     }
 
-    if (m_param->rc.aqMode == X265_AQ_EDGE || (m_param->rc.zonefileCount && m_param->rc.aqMode != 0))
-    {
-        X265_FREE(m_edgePic);
-        X265_FREE(m_gaussianPic);
-        X265_FREE(m_thetaPic);
-    }
-
     if (m_param->recursionSkipMode == EDGE_BASED_RSKIP)
     {
         X265_FREE_ZERO(m_edgeBitPlane);
@@ -132,11 +132,6 @@ public:
     bool                   m_classifyFrame;
     int                    m_fieldNum;
 
-    /* aq-mode 4 : Gaussian, edge and theta frames for edge information */
-    pixel*                 m_edgePic;
-    pixel*                 m_gaussianPic;
-    pixel*                 m_thetaPic;
-
     /* edge bit plane for rskips 2 and 3 */
     pixel*                 m_edgeBitPlane;
     pixel*                 m_edgeBitPic;
@@ -64,6 +64,8 @@ bool FrameData::create(const x265_param& param, const SPS& sps, int csp)
         return false;
     CHECKED_MALLOC_ZERO(m_cuStat, RCStatCU, sps.numCUsInFrame);
     CHECKED_MALLOC(m_rowStat, RCStatRow, sps.numCuInHeight);
+    if (param.bCTUCostMap)
+        CHECKED_MALLOC(m_ctuCost, CTUCost, sps.numCUsInFrame);
     reinit(sps);
     
     for (int i = 0; i < INTEGRAL_PLANE_NUM; i++)
@@ -81,6 +83,8 @@ void FrameData::reinit(const SPS& sps)
 {
     memset(m_cuStat, 0, sps.numCUsInFrame * sizeof(*m_cuStat));
     memset(m_rowStat, 0, sps.numCuInHeight * sizeof(*m_rowStat));
+    if (m_ctuCost)
+        memset(m_ctuCost, 0, sps.numCUsInFrame * sizeof(*m_ctuCost));
     if (m_param->bDynamicRefine)
     {
         memset(m_picCTU->m_collectCURd, 0, MAX_NUM_DYN_REFINE * sps.numCUsInFrame * sizeof(uint64_t));
@@ -105,6 +109,7 @@ void FrameData::destroy()
     }
     X265_FREE(m_cuStat);
     X265_FREE(m_rowStat);
+    X265_FREE(m_ctuCost);
     for (int i = 0; i < INTEGRAL_PLANE_NUM; i++)
     {
         if (m_meBuffer[i] != NULL)
@@ -151,8 +151,18 @@ public:
         double   sumQpAq;
     };
 
+    /* Encode cost of each CTU, kept when --ctu-cost-map is enabled */
+    struct CTUCost
+    {
+        uint32_t wallTime;      /* microseconds spent in analysis and coding of the CTU */
+        uint32_t rdEvals;       /* RD cost evaluations (full residual coding) of its CUs */
+        uint32_t meSearches;    /* motion searches of its prediction units */
+        uint32_t totalBits;     /* bits of the final CTU coding */
+    };
+
     RCStatCU*      m_cuStat;
     RCStatRow*     m_rowStat;
+    CTUCost*       m_ctuCost;    /* NULL unless --ctu-cost-map */
     FrameStats     m_frameStats; // stats of current frame for multi-pass encodes
     /* data needed for periodic intra refresh */
     struct PeriodicIR
@@ -232,6 +232,54 @@ void all_angs_pred_c(pixel *dest, pixel *refPix, pixel *filtPix, int bLuma)
         }
     }
 }
+
+/* Returns the angular intra mode whose prediction direction runs along the
+ * edge implied by the gradient (gx, gy). The edge slope is quantized to the
+ * nearest intraPredAngle using doubled midpoints between the angle magnitudes
+ * { 0, 2, 5, 9, 13, 17, 21, 26, 32 }, so no division is needed */
+static inline int gradientToIntraMode(int gx, int gy)
+{
+    static const int angThresh[8] = { 2, 7, 14, 22, 30, 38, 47, 58 };
+
+    int absX = abs(gx), absY = abs(gy);
+    bool bVer = absX > absY;
+    int num = bVer ? absY : absX;
+    int den = bVer ? absX : absY;
+
+    int k = 0;
+    for (int i = 0; i < 8; i++)
+        k += (num << 6) > angThresh[i] * den;
+
+    bool bPositive = (gx ^ gy) >= 0;
+    if (bVer)
+        return bPositive ? 26 + k : 26 - k;
+    else
+        return bPositive ? 10 - k : 10 + k;
+}
+
+template<int log2Size>
+void intra_grad_hist_c(const pixel* src, intptr_t srcStride, uint32_t* hist)
+{
+    const int size = 1 << log2Size;
+
+    memset(hist, 0, NUM_INTRA_MODE * sizeof(uint32_t));
+
+    /* 3x3 Sobel over the block interior, weighted by |gx| + |gy| */
+    for (int y = 1; y < size - 1; y++)
+    {
+        const pixel* above = src + (y - 1) * srcStride;
+        const pixel* cur   = src + y * srcStride;
+        const pixel* below = src + (y + 1) * srcStride;
+
+        for (int x = 1; x < size - 1; x++)
+        {
+            int gx = (above[x + 1] + 2 * cur[x + 1] + below[x + 1]) - (above[x - 1] + 2 * cur[x - 1] + below[x - 1]);
+            int gy = (below[x - 1] + 2 * below[x] + below[x + 1]) - (above[x - 1] + 2 * above[x] + above[x + 1]);
+
+            hist[gradientToIntraMode(gx, gy)] += abs(gx) + abs(gy);
+        }
+    }
+}
 }
 
 namespace X265_NS {
@@ -266,5 +314,9 @@ void setupIntraPrimitives_c(EncoderPrimitives& p)
     p.cu[BLOCK_8x8].intra_pred_allangs = all_angs_pred_c<3>;
     p.cu[BLOCK_16x16].intra_pred_allangs = all_angs_pred_c<4>;
     p.cu[BLOCK_32x32].intra_pred_allangs = all_angs_pred_c<5>;
+
+    p.cu[BLOCK_8x8].intra_grad_hist = intra_grad_hist_c<3>;
+    p.cu[BLOCK_16x16].intra_grad_hist = intra_grad_hist_c<4>;
+    p.cu[BLOCK_32x32].intra_grad_hist = intra_grad_hist_c<5>;
 }
 }
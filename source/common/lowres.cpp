@@ -85,7 +85,7 @@ bool Lowres::create(x265_param* param, PicYuv *origPic, uint32_t qgSize)
 
     if (origPic->m_param->bAQMotion)
         CHECKED_MALLOC_ZERO(qpAqMotionOffset, double, cuCountFullRes);
-    if (origPic->m_param->bDynamicRefine || origPic->m_param->bEnableFades)
+    if (origPic->m_param->bDynamicRefine)
         CHECKED_MALLOC_ZERO(blockVariance, uint32_t, cuCountFullRes);
 
     if (!!param->rc.hevcAq)
@@ -261,6 +261,7 @@ void Lowres::init(PicYuv *origPic, int poc)
     bLastMiniGopBFrame = false;
     bKeyframe = false; // Not a keyframe unless identified by lookahead
     bIsFadeEnd = false;
+    bVarianceRise = false;
     frameNum = poc;
     leadingBframes = 0;
     indB = 0;
@@ -268,8 +269,6 @@ void Lowres::init(PicYuv *origPic, int poc)
     memset(weightedCostDelta, 0, sizeof(weightedCostDelta));
     interPCostPercDiff = 0.0;
     intraCostPercDiff = 0.0;
-    m_bIsMaxThres = false;
-    m_bIsHardScenecut = false;
 
     if (qpAqOffset && invQscaleFactor)
         memset(costEstAq, -1, sizeof(costEstAq));
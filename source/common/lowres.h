@@ -179,6 +179,7 @@ struct Lowres : public ReferencePlanes
     bool   bKeyframe;
     bool   bLastMiniGopBFrame;
     bool   bIsFadeEnd;
+    bool   bVarianceRise;    // frameVariance did not drop from the previous input frame, for --fades
 
     double ipCostRatio;
 
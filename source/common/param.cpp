@@ -125,6 +125,8 @@ void x265_param_default(x265_param* param)
     param->logLevel = X265_LOG_INFO;
     param->csvLogLevel = 0;
     param->csvfn = NULL;
+    param->traceFile = NULL;
+    param->bCTUCostMap = 0;
     param->rc.lambdaFileName = NULL;
     param->bLogCuStats = 0;
     param->decodedPictureHashSEI = 0;
@@ -190,6 +192,7 @@ void x265_param_default(x265_param* param)
     param->bEnableConstrainedIntra = 0;
     param->bEnableStrongIntraSmoothing = 1;
     param->bEnableFastIntra = 0;
+    param->intraGradModes = 0;
     param->bEnableSplitRdSkip = 0;
 
     /* Inter Coding tools */
@@ -211,6 +214,7 @@ void x265_param_default(x265_param* param)
     param->bEnableSignHiding = 1;
     param->bEnableTransformSkip = 0;
     param->bEnableTSkipFast = 0;
+    param->bEnableZeroBlockSkip = 1;
     param->maxNumReferences = 3;
     param->bEnableTemporalMvp = 1;
     param->bEnableHME = 0;
@@ -417,6 +421,7 @@ int x265_param_default_preset(x265_param* param, const char* preset, const char*
             param->rc.hevcAq = 0;
             param->rc.qgSize = 32;
             param->bEnableFastIntra = 1;
+            param->intraGradModes = 8;
         }
         else if (!strcmp(preset, "superfast"))
         {
@@ -437,6 +442,7 @@ int x265_param_default_preset(x265_param* param, const char* preset, const char*
             param->rc.qgSize = 32;
             param->bEnableSAO = 0;
             param->bEnableFastIntra = 1;
+            param->intraGradModes = 8;
         }
         else if (!strcmp(preset, "veryfast"))
         {
@@ -450,6 +456,7 @@ int x265_param_default_preset(x265_param* param, const char* preset, const char*
             param->maxNumReferences = 2;
             param->rc.qgSize = 32;
             param->bEnableFastIntra = 1;
+            param->intraGradModes = 10;
         }
         else if (!strcmp(preset, "faster"))
         {
@@ -710,6 +717,7 @@ int x265_zone_param_parse(x265_param* p, const char* name, const char* value)
     if (0);
     OPT("ref") p->maxNumReferences = atoi(value);
     OPT("fast-intra") p->bEnableFastIntra = atobool(value);
+    OPT("intra-grad-modes") p->intraGradModes = atoi(value);
     OPT("early-skip") p->bEnableEarlySkip = atobool(value);
     OPT("rskip") p->recursionSkipMode = atoi(value);
     OPT("rskip-edge-threshold") p->edgeVarThreshold = atoi(value)/100.0f;
@@ -1205,6 +1213,8 @@ int x265_param_parse(x265_param* p, const char* name, const char* value)
         if (0) ;
         OPT("csv") p->csvfn = strdup(value);
         OPT("csv-log-level") p->csvLogLevel = atoi(value);
+        OPT("trace") p->traceFile = strdup(value);
+        OPT("ctu-cost-map") p->bCTUCostMap = atobool(value);
         OPT("qpmin") p->rc.qpMin = atoi(value);
         OPT("analyze-src-pics") p->bSourceReferenceEstimation = atobool(value);
         OPT("log2-max-poc-lsb") p->log2MaxPocLsb = atoi(value);
@@ -1446,6 +1456,8 @@ int x265_param_parse(x265_param* p, const char* name, const char* value)
         OPT("vbv-live-multi-pass") p->bliveVBV2pass = atobool(value);
         OPT("min-vbv-fullness") p->minVbvFullness = atof(value);
         OPT("max-vbv-fullness") p->maxVbvFullness = atof(value);
+        OPT("intra-grad-modes") p->intraGradModes = atoi(value);
+        OPT("zero-block-skip") p->bEnableZeroBlockSkip = atobool(value);
         else
             return X265_PARAM_BAD_NAME;
     }
@@ -1683,6 +1695,8 @@ int x265_check_params(x265_param* param)
         CHECK(param->edgeVarThreshold < 0.0f || param->edgeVarThreshold > 1.0f,
               "Minimum edge density percentage for a CU should be an integer between 0 to 100");
     }
+    CHECK(param->intraGradModes < 0 || param->intraGradModes > 33,
+          "Intra gradient mode count must be between 0 and 33");
     CHECK(param->bframes && param->bframes >= param->lookaheadDepth && !param->rc.bStatRead,
           "Lookahead depth must be greater than the max consecutive bframe count");
     CHECK(param->bframes < 0,
@@ -2037,6 +2051,7 @@ void x265_print_params(x265_param* param)
     TOOLVAL(param->noiseReductionInter, "nr-inter=%d");
     TOOLOPT(param->bEnableTSkipFast, "tskip-fast");
     TOOLOPT(!param->bEnableTSkipFast && param->bEnableTransformSkip, "tskip");
+    TOOLOPT(param->bEnableZeroBlockSkip, "zero-block-skip");
     TOOLVAL(param->limitTU , "limit-tu=%d");
     TOOLOPT(param->bCULossless, "cu-lossless");
     TOOLOPT(param->bEnableSignHiding, "signhide");
@@ -2044,6 +2059,7 @@ void x265_print_params(x265_param* param)
     TOOLOPT(param->bEnableConstrainedIntra, "cip");
     TOOLOPT(param->bIntraInBFrames, "b-intra");
     TOOLOPT(param->bEnableFastIntra, "fast-intra");
+    TOOLVAL(param->intraGradModes, "intra-grad-modes=%d");
     TOOLOPT(param->bEnableStrongIntraSmoothing, "strong-intra-smoothing");
     TOOLVAL(param->lookaheadSlices, "lslices=%d");
     TOOLVAL(param->lookaheadThreads, "lthreads=%d")
@@ -2194,7 +2210,9 @@ char *x265_param2string(x265_param* p, int padx, int pady)
         s += sprintf(s, " rskip-edge-threshold=%f", p->edgeVarThreshold);
 
     BOOL(p->bEnableFastIntra, "fast-intra");
+    s += sprintf(s, " intra-grad-modes=%d", p->intraGradModes);
     BOOL(p->bEnableTSkipFast, "tskip-fast");
+    BOOL(p->bEnableZeroBlockSkip, "zero-block-skip");
     BOOL(p->bCULossless, "cu-lossless");
     BOOL(p->bIntraInBFrames, "b-intra");
     BOOL(p->bEnableSplitRdSkip, "splitrd-skip");
@@ -2423,6 +2441,9 @@ void x265_copy_params(x265_param* dst, x265_param* src)
     dst->csvLogLevel = src->csvLogLevel;
     if (src->csvfn) dst->csvfn = strdup(src->csvfn);
     else dst->csvfn = NULL;
+    if (src->traceFile) dst->traceFile = strdup(src->traceFile);
+    else dst->traceFile = NULL;
+    dst->bCTUCostMap = src->bCTUCostMap;
     dst->internalBitDepth = src->internalBitDepth;
     dst->sourceBitDepth = src->sourceBitDepth;
     dst->internalCsp = src->internalCsp;
@@ -2504,7 +2525,9 @@ void x265_copy_params(x265_param* dst, x265_param* src)
     dst->recursionSkipMode = src->recursionSkipMode;
     dst->edgeVarThreshold = src->edgeVarThreshold;
     dst->bEnableFastIntra = src->bEnableFastIntra;
+    dst->intraGradModes = src->intraGradModes;
     dst->bEnableTSkipFast = src->bEnableTSkipFast;
+    dst->bEnableZeroBlockSkip = src->bEnableZeroBlockSkip;
     dst->bCULossless = src->bCULossless;
     dst->bIntraInBFrames = src->bIntraInBFrames;
     dst->rdPenalty = src->rdPenalty;
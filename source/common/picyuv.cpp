@@ -26,6 +26,7 @@
 #include "picyuv.h"
 #include "slice.h"
 #include "primitives.h"
+#include "threadpool.h"
 
 using namespace X265_NS;
 
@@ -204,9 +205,125 @@ void PicYuv::destroy()
     X265_FREE(m_picBuf[2]);
 }
 
+namespace {
+/* rows converted per task, a multiple of the chroma subsampling */
+#define COPY_STRIP_HEIGHT 64
+#define COPY_MIN_PARALLEL_HEIGHT 720
+
+/* converts the picture strip by strip on the workers of the pool */
+class PlaneCopy : public BondedTaskGroup
+{
+public:
+
+    PicYuv&              pic;
+    const x265_picture&  src;
+    int                  width;
+    int                  height;
+
+    PlaneCopy(PicYuv& p, const x265_picture& s, int w, int h) : pic(p), src(s), width(w), height(h) {}
+
+    void processTasks(int /* workerThreadId */)
+    {
+        for (;;)
+        {
+            m_lock.acquire();
+            int strip = m_jobAcquired < m_jobTotal ? m_jobAcquired++ : -1;
+            m_lock.release();
+
+            if (strip < 0)
+                break;
+
+            int rowBegin = strip * COPY_STRIP_HEIGHT;
+            pic.copyRowsFromPicture(src, width, rowBegin, X265_MIN(rowBegin + COPY_STRIP_HEIGHT, height));
+        }
+    }
+
+protected:
+
+    PlaneCopy operator=(const PlaneCopy&);
+};
+}
+
+/* converts rows [rowBegin, rowEnd) of the picture to the internal bit depth,
+ * along with the chroma rows they cover */
+void PicYuv::copyRowsFromPicture(const x265_picture& pic, int width, int rowBegin, int rowEnd)
+{
+    const bool bChroma = m_param->internalCsp != X265_CSP_I400;
+    const int widthC = width >> m_hChromaShift;
+    const int rowBeginC = rowBegin >> m_vChromaShift;
+    const int rowsC = (rowEnd >> m_vChromaShift) - rowBeginC;
+    const int rows = rowEnd - rowBegin;
+
+    pixel* yPixel = m_picOrg[0] + rowBegin * m_stride;
+    pixel* uPixel = bChroma ? m_picOrg[1] + rowBeginC * m_strideC : NULL;
+    pixel* vPixel = bChroma ? m_picOrg[2] + rowBeginC * m_strideC : NULL;
+
+    if (pic.bitDepth == 8)
+    {
+        const uint8_t* yChar = (uint8_t*)pic.planes[0] + rowBegin * pic.stride[0];
+        const uint8_t* uChar = bChroma ? (uint8_t*)pic.planes[1] + rowBeginC * pic.stride[1] : NULL;
+        const uint8_t* vChar = bChroma ? (uint8_t*)pic.planes[2] + rowBeginC * pic.stride[2] : NULL;
+
+#if (X265_DEPTH > 8)
+        int shift = (X265_DEPTH - 8);
+
+        primitives.planecopy_cp(yChar, pic.stride[0] / sizeof(*yChar), yPixel, m_stride, width, rows, shift);
+        if (bChroma)
+        {
+            primitives.planecopy_cp(uChar, pic.stride[1] / sizeof(*uChar), uPixel, m_strideC, widthC, rowsC, shift);
+            primitives.planecopy_cp(vChar, pic.stride[2] / sizeof(*vChar), vPixel, m_strideC, widthC, rowsC, shift);
+        }
+#else /* Case for (X265_DEPTH == 8) */
+        for (int r = 0; r < rows; r++)
+        {
+            memcpy(yPixel, yChar, width * sizeof(pixel));
+
+            yPixel += m_stride;
+            yChar += pic.stride[0] / sizeof(*yChar);
+        }
+
+        if (bChroma)
+        {
+            for (int r = 0; r < rowsC; r++)
+            {
+                memcpy(uPixel, uChar, widthC * sizeof(pixel));
+                memcpy(vPixel, vChar, widthC * sizeof(pixel));
+
+                uPixel += m_strideC;
+                vPixel += m_strideC;
+                uChar += pic.stride[1] / sizeof(*uChar);
+                vChar += pic.stride[2] / sizeof(*vChar);
+            }
+        }
+#endif /* (X265_DEPTH > 8) */
+    }
+    else /* pic.bitDepth > 8 */
+    {
+        /* defensive programming, mask off bits that are supposed to be zero */
+        uint16_t mask = (1 << X265_DEPTH) - 1;
+        int shift = abs(pic.bitDepth - X265_DEPTH);
+
+        /* shift right and mask pixels to final size, or shift left if the
+         * picture depth is below the internal depth */
+        planecopy_sp_t copy = pic.bitDepth > X265_DEPTH ? primitives.planecopy_sp : primitives.planecopy_sp_shl;
+
+        const uint16_t* yShort = (uint16_t*)((char*)pic.planes[0] + rowBegin * pic.stride[0]);
+        copy(yShort, pic.stride[0] / sizeof(*yShort), yPixel, m_stride, width, rows, shift, mask);
+
+        if (bChroma)
+        {
+            const uint16_t* uShort = (uint16_t*)((char*)pic.planes[1] + rowBeginC * pic.stride[1]);
+            const uint16_t* vShort = (uint16_t*)((char*)pic.planes[2] + rowBeginC * pic.stride[2]);
+
+            copy(uShort, pic.stride[1] / sizeof(*uShort), uPixel, m_strideC, widthC, rowsC, shift, mask);
+            copy(vShort, pic.stride[2] / sizeof(*vShort), vPixel, m_strideC, widthC, rowsC, shift, mask);
+        }
+    }
+}
+
 /* Copy pixels from an x265_picture into internal PicYuv instance.
  * Shift pixels as necessary, mask off bits above X265_DEPTH for safety. */
-void PicYuv::copyFromPicture(const x265_picture& pic, const x265_param& param, int padx, int pady)
+void PicYuv::copyFromPicture(const x265_picture& pic, const x265_param& param, int padx, int pady, ThreadPool* pool)
 {
     /* m_picWidth is the width that is being encoded, padx indicates how many
      * of those pixels are padding to reach multiple of MinCU(4) size.
@@ -241,109 +358,22 @@ void PicYuv::copyFromPicture(const x265_picture& pic, const x265_param& param, i
     uint64_t crSum;
     lumaSum = cbSum = crSum = 0;
 
-    if (m_param->bCopyPicToFrame)
+    /* pictures from x265_encoder_alloc_input() were written in place */
+    if (m_param->bCopyPicToFrame && !pic.inputFrame)
     {
-        if (pic.bitDepth == 8)
+        int strips = (height + COPY_STRIP_HEIGHT - 1) / COPY_STRIP_HEIGHT;
+        if (pool && height >= COPY_MIN_PARALLEL_HEIGHT)
         {
-#if (X265_DEPTH > 8)
-        {
-            pixel *yPixel = m_picOrg[0];
-
-            uint8_t *yChar = (uint8_t*)pic.planes[0];
-            int shift = (X265_DEPTH - 8);
-
-            primitives.planecopy_cp(yChar, pic.stride[0] / sizeof(*yChar), yPixel, m_stride, width, height, shift);
-
-            if (param.internalCsp != X265_CSP_I400)
-            {
-                pixel *uPixel = m_picOrg[1];
-                pixel *vPixel = m_picOrg[2];
-
-                uint8_t *uChar = (uint8_t*)pic.planes[1];
-                uint8_t *vChar = (uint8_t*)pic.planes[2];
-
-                primitives.planecopy_cp(uChar, pic.stride[1] / sizeof(*uChar), uPixel, m_strideC, width >> m_hChromaShift, height >> m_vChromaShift, shift);
-                primitives.planecopy_cp(vChar, pic.stride[2] / sizeof(*vChar), vPixel, m_strideC, width >> m_hChromaShift, height >> m_vChromaShift, shift);
-            }
-        }
-#else /* Case for (X265_DEPTH == 8) */
-            // TODO: Does we need this path? may merge into above in future
-        {
-            pixel *yPixel = m_picOrg[0];
-            uint8_t *yChar = (uint8_t*)pic.planes[0];
-
-            for (int r = 0; r < height; r++)
-            {
-                memcpy(yPixel, yChar, width * sizeof(pixel));
-
-                yPixel += m_stride;
-                yChar += pic.stride[0] / sizeof(*yChar);
-            }
-
-            if (param.internalCsp != X265_CSP_I400)
-            {
-                pixel *uPixel = m_picOrg[1];
-                pixel *vPixel = m_picOrg[2];
-
-                uint8_t *uChar = (uint8_t*)pic.planes[1];
-                uint8_t *vChar = (uint8_t*)pic.planes[2];
-
-                for (int r = 0; r < height >> m_vChromaShift; r++)
-                {
-                    memcpy(uPixel, uChar, (width >> m_hChromaShift) * sizeof(pixel));
-                    memcpy(vPixel, vChar, (width >> m_hChromaShift) * sizeof(pixel));
-
-                    uPixel += m_strideC;
-                    vPixel += m_strideC;
-                    uChar += pic.stride[1] / sizeof(*uChar);
-                    vChar += pic.stride[2] / sizeof(*vChar);
-                }
-            }
-        }
-#endif /* (X265_DEPTH > 8) */
-        }
-        else /* pic.bitDepth > 8 */
-        {
-            /* defensive programming, mask off bits that are supposed to be zero */
-            uint16_t mask = (1 << X265_DEPTH) - 1;
-            int shift = abs(pic.bitDepth - X265_DEPTH);
-            pixel *yPixel = m_picOrg[0];
-
-            uint16_t *yShort = (uint16_t*)pic.planes[0];
-
-            if (pic.bitDepth > X265_DEPTH)
-            {
-                /* shift right and mask pixels to final size */
-                primitives.planecopy_sp(yShort, pic.stride[0] / sizeof(*yShort), yPixel, m_stride, width, height, shift, mask);
-            }
-            else /* Case for (pic.bitDepth <= X265_DEPTH) */
-            {
-                /* shift left and mask pixels to final size */
-                primitives.planecopy_sp_shl(yShort, pic.stride[0] / sizeof(*yShort), yPixel, m_stride, width, height, shift, mask);
-            }
-
-            if (param.internalCsp != X265_CSP_I400)
-            {
-                pixel *uPixel = m_picOrg[1];
-                pixel *vPixel = m_picOrg[2];
-
-                uint16_t *uShort = (uint16_t*)pic.planes[1];
-                uint16_t *vShort = (uint16_t*)pic.planes[2];
-
-                if (pic.bitDepth > X265_DEPTH)
-                {
-                    primitives.planecopy_sp(uShort, pic.stride[1] / sizeof(*uShort), uPixel, m_strideC, width >> m_hChromaShift, height >> m_vChromaShift, shift, mask);
-                    primitives.planecopy_sp(vShort, pic.stride[2] / sizeof(*vShort), vPixel, m_strideC, width >> m_hChromaShift, height >> m_vChromaShift, shift, mask);
-                }
-                else /* Case for (pic.bitDepth <= X265_DEPTH) */
-                {
-                    primitives.planecopy_sp_shl(uShort, pic.stride[1] / sizeof(*uShort), uPixel, m_strideC, width >> m_hChromaShift, height >> m_vChromaShift, shift, mask);
-                    primitives.planecopy_sp_shl(vShort, pic.stride[2] / sizeof(*vShort), vPixel, m_strideC, width >> m_hChromaShift, height >> m_vChromaShift, shift, mask);
-                }
-            }
+            PlaneCopy copy(*this, pic, width, height);
+            copy.m_jobTotal = strips;
+            copy.tryBondPeers(*pool, strips - 1);
+            copy.processTasks(-1);
+            copy.waitForExit();
         }
+        else
+            copyRowsFromPicture(pic, width, 0, height);
     }
-    else
+    else if (!pic.inputFrame)
     {
         m_picOrg[0] = (pixel*)pic.planes[0];
         m_picOrg[1] = (pixel*)pic.planes[1];
@@ -506,37 +536,7 @@ static void md5_plane(MD5Context& md5, const pixel* plane, uint32_t width, uint3
 
 void updateCRC(const pixel* plane, uint32_t& crcVal, uint32_t height, uint32_t width, intptr_t stride)
 {
-    uint32_t crcMsb;
-    uint32_t bitVal;
-    uint32_t bitIdx;
-
-    for (uint32_t y = 0; y < height; y++)
-    {
-        for (uint32_t x = 0; x < width; x++)
-        {
-            // take CRC of first pictureData byte
-            for (bitIdx = 0; bitIdx < 8; bitIdx++)
-            {
-                crcMsb = (crcVal >> 15) & 1;
-                bitVal = (plane[y * stride + x] >> (7 - bitIdx)) & 1;
-                crcVal = (((crcVal << 1) + bitVal) & 0xffff) ^ (crcMsb * 0x1021);
-            }
-
-#if _MSC_VER
-#pragma warning(disable: 4127) // conditional expression is constant
-#endif
-            // take CRC of second pictureData byte if bit depth is greater than 8-bits
-            if (X265_DEPTH > 8)
-            {
-                for (bitIdx = 0; bitIdx < 8; bitIdx++)
-                {
-                    crcMsb = (crcVal >> 15) & 1;
-                    bitVal = (plane[y * stride + x] >> (15 - bitIdx)) & 1;
-                    crcVal = (((crcVal << 1) + bitVal) & 0xffff) ^ (crcMsb * 0x1021);
-                }
-            }
-        }
-    }
+    crcVal = primitives.hashCRC(plane, stride, width, height, crcVal);
 }
 
 void crcFinish(uint32_t& crcVal, uint8_t digest[16])
@@ -555,19 +555,8 @@ void crcFinish(uint32_t& crcVal, uint8_t digest[16])
 
 void updateChecksum(const pixel* plane, uint32_t& checksumVal, uint32_t height, uint32_t width, intptr_t stride, int row, uint32_t cuHeight)
 {
-    uint8_t xor_mask;
-
-    for (uint32_t y = row * cuHeight; y < ((row * cuHeight) + height); y++)
-    {
-        for (uint32_t x = 0; x < width; x++)
-        {
-            xor_mask = (uint8_t)((x & 0xff) ^ (y & 0xff) ^ (x >> 8) ^ (y >> 8));
-            checksumVal = (checksumVal + ((plane[y * stride + x] & 0xff) ^ xor_mask)) & 0xffffffff;
-
-            if (X265_DEPTH > 8)
-                checksumVal = (checksumVal + ((plane[y * stride + x] >> 7 >> 1) ^ xor_mask)) & 0xffffffff;
-        }
-    }
+    uint32_t y0 = row * cuHeight;
+    checksumVal += primitives.hashChecksum(plane + y0 * stride, stride, width, height, y0);
 }
 
 void checksumFinish(uint32_t checksum, uint8_t digest[16])
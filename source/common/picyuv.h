@@ -33,6 +33,7 @@ namespace X265_NS {
 // private namespace
 
 class ShortYuv;
+class ThreadPool;
 struct SPS;
 
 class PicYuv : public x265_picyuv
@@ -82,7 +83,10 @@ public:
     void  destroy();
     int   getLumaBufLen(uint32_t picWidth, uint32_t picHeight, uint32_t picCsp);
 
-    void  copyFromPicture(const x265_picture&, const x265_param& param, int padx, int pady);
+    /* the conversion is split in strips over idle workers of pool, if given */
+    void  copyFromPicture(const x265_picture&, const x265_param& param, int padx, int pady, ThreadPool* pool = NULL);
+
+    void  copyRowsFromPicture(const x265_picture& pic, int width, int rowBegin, int rowEnd);
 
     intptr_t getChromaAddrOffset(uint32_t ctuAddr, uint32_t absPartIdx) const { return m_cuOffsetC[ctuAddr] + m_buOffsetC[absPartIdx]; }
 
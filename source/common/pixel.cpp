@@ -28,6 +28,7 @@
 #include "common.h"
 #include "slicetype.h"      // LOWRES_COST_MASK
 #include "primitives.h"
+#include "constants.h"
 #include "x265.h"
 
 #include <cstdlib> // abs()
@@ -390,6 +391,20 @@ sse_t pixel_ssd_s_c(const int16_t* a, intptr_t dstride)
     return sum;
 }
 
+template<int size>
+uint32_t pixel_sad_s_c(const int16_t* a, intptr_t dstride)
+{
+    uint32_t sum = 0;
+    for (int y = 0; y < size; y++)
+    {
+        for (int x = 0; x < size; x++)
+            sum += abs(a[x]);
+
+        a += dstride;
+    }
+    return sum;
+}
+
 template<int size>
 void blockfill_s_c(int16_t* dst, intptr_t dstride, int16_t val)
 {
@@ -1016,6 +1031,105 @@ static pixel planeClipAndMax_c(pixel *src, intptr_t stride, int width, int heigh
 }
 
 #endif
+
+/* CRC of the picture hash SEI, one byte of the row per table lookup; a pixel
+ * above 8 bits is sent as its low byte then its high byte */
+static uint32_t hash_crc_c(const pixel* plane, intptr_t stride, uint32_t width, uint32_t height, uint32_t crcVal)
+{
+    for (uint32_t y = 0; y < height; y++)
+    {
+        for (uint32_t x = 0; x < width; x++)
+        {
+            crcVal = g_crc16Table[(crcVal >> 8) & 0xff] ^ (((crcVal << 8) & 0xff00) | (plane[x] & 0xff));
+            if (X265_DEPTH > 8)
+                crcVal = g_crc16Table[(crcVal >> 8) & 0xff] ^ (((crcVal << 8) & 0xff00) | (plane[x] >> 7 >> 1));
+        }
+
+        plane += stride;
+    }
+
+    return crcVal;
+}
+
+static uint32_t hash_checksum_c(const pixel* plane, intptr_t stride, uint32_t width, uint32_t height, uint32_t y0)
+{
+    uint32_t sum = 0;
+
+    for (uint32_t y = y0; y < y0 + height; y++)
+    {
+        for (uint32_t x = 0; x < width; x++)
+        {
+            uint8_t xorMask = (uint8_t)((x & 0xff) ^ (y & 0xff) ^ (x >> 8) ^ (y >> 8));
+            sum += (plane[x] & 0xff) ^ xorMask;
+
+            if (X265_DEPTH > 8)
+                sum += (plane[x] >> 7 >> 1) ^ xorMask;
+        }
+
+        plane += stride;
+    }
+
+    return sum;
+}
+
+/* the float magnitude of computeEdge() reaches the threshold exactly when the
+ * squared integer gradients do */
+static uint32_t edge_count_c(const pixel* src, intptr_t stride, int width, int height, int threshold)
+{
+    const int64_t threshold2 = (int64_t)threshold * threshold;
+    uint32_t edges = 0;
+
+    for (int y = 1; y < height - 1; y++)
+    {
+        const pixel* row = src + y * stride;
+        for (int x = 1; x < width - 1; x++)
+        {
+            const pixel* p = row + x;
+            int gH = -3 * p[-stride - 1] + 3 * p[-stride + 1] - 10 * p[-1] + 10 * p[1] - 3 * p[stride - 1] + 3 * p[stride + 1];
+            int gV = -3 * p[-stride - 1] - 10 * p[-stride] - 3 * p[-stride + 1] + 3 * p[stride - 1] + 10 * p[stride] + 3 * p[stride + 1];
+            edges += (int64_t)gH * gH + (int64_t)gV * gV >= threshold2;
+        }
+    }
+
+    return edges;
+}
+
+static void gaussian_row_c(pixel* dst, const pixel* src, intptr_t stride, int width)
+{
+    const pixel* r0 = src - 2 * stride;
+    const pixel* r1 = src - stride;
+    const pixel* r3 = src + stride;
+    const pixel* r4 = src + 2 * stride;
+
+    for (int x = 0; x < width; x++)
+    {
+        /*  5x5 Gaussian filter
+            [2   4   5   4   2]
+         1  [4   9   12  9   4]
+        --- [5   12  15  12  5]
+        159 [4   9   12  9   4]
+            [2   4   5   4   2]*/
+        int sum = 2 * r0[x - 2] + 4 * r0[x - 1] + 5 * r0[x] + 4 * r0[x + 1] + 2 * r0[x + 2] +
+                  4 * r1[x - 2] + 9 * r1[x - 1] + 12 * r1[x] + 9 * r1[x + 1] + 4 * r1[x + 2] +
+                  5 * src[x - 2] + 12 * src[x - 1] + 15 * src[x] + 12 * src[x + 1] + 5 * src[x + 2] +
+                  4 * r3[x - 2] + 9 * r3[x - 1] + 12 * r3[x] + 9 * r3[x + 1] + 4 * r3[x + 2] +
+                  2 * r4[x - 2] + 4 * r4[x - 1] + 5 * r4[x] + 4 * r4[x + 1] + 2 * r4[x + 2];
+        dst[x] = (pixel)(sum / 159);
+    }
+}
+
+static void edge_row_c(pixel* dst, const pixel* src, intptr_t stride, int width, int threshold, pixel white)
+{
+    const int64_t threshold2 = (int64_t)threshold * threshold;
+
+    for (int x = 0; x < width; x++)
+    {
+        const pixel* p = src + x;
+        int gH = -3 * p[-stride - 1] + 3 * p[-stride + 1] - 10 * p[-1] + 10 * p[1] - 3 * p[stride - 1] + 3 * p[stride + 1];
+        int gV = -3 * p[-stride - 1] - 10 * p[-stride] - 3 * p[-stride + 1] + 3 * p[stride - 1] + 10 * p[stride] + 3 * p[stride + 1];
+        dst[x] = (int64_t)gH * gH + (int64_t)gV * gV >= threshold2 ? white : 0;
+    }
+}
 }  // end anonymous namespace
 
 namespace X265_NS {
@@ -1070,6 +1184,7 @@ void setupPixelPrimitives_c(EncoderPrimitives &p)
     p.cu[BLOCK_ ## W ## x ## H].transpose     = transpose<W>; \
     p.cu[BLOCK_ ## W ## x ## H].ssd_s[NONALIGNED]         = pixel_ssd_s_c<W>; \
     p.cu[BLOCK_ ## W ## x ## H].ssd_s[ALIGNED] = pixel_ssd_s_c<W>; \
+    p.cu[BLOCK_ ## W ## x ## H].sad_s         = pixel_sad_s_c<W>; \
     p.cu[BLOCK_ ## W ## x ## H].var           = pixel_var<W>; \
     p.cu[BLOCK_ ## W ## x ## H].calcresidual[NONALIGNED]  = getResidual<W>; \
     p.cu[BLOCK_ ## W ## x ## H].calcresidual[ALIGNED]     = getResidual<W>; \
@@ -1341,6 +1456,11 @@ void setupPixelPrimitives_c(EncoderPrimitives &p)
 #if HIGH_BIT_DEPTH
     p.planeClipAndMax = planeClipAndMax_c;
 #endif
+    p.hashCRC = hash_crc_c;
+    p.hashChecksum = hash_checksum_c;
+    p.edgeCount = edge_count_c;
+    p.gaussianRow = gaussian_row_c;
+    p.edgeRow = edge_row_c;
     p.propagateCost = estimateCUPropagateCost;
     p.fix8Unpack = cuTreeFix8Unpack;
     p.fix8Pack = cuTreeFix8Pack;
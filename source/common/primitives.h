@@ -135,6 +135,7 @@ typedef int  (*pixelcmp_ss_t)(const int16_t* fenc, intptr_t fencstride, const in
 typedef sse_t (*pixel_sse_t)(const pixel* fenc, intptr_t fencstride, const pixel* fref, intptr_t frefstride); // fenc is aligned
 typedef sse_t (*pixel_sse_ss_t)(const int16_t* fenc, intptr_t fencstride, const int16_t* fref, intptr_t frefstride);
 typedef sse_t (*pixel_ssd_s_t)(const int16_t* fenc, intptr_t fencstride);
+typedef uint32_t (*pixel_sad_s_t)(const int16_t* res, intptr_t resstride);
 typedef int(*pixelcmp_ads_t)(int encDC[], uint32_t *sums, int delta, uint16_t *costMvX, int16_t *mvs, int width, int thresh);
 typedef void (*pixelcmp_x4_t)(const pixel* fenc, const pixel* fref0, const pixel* fref1, const pixel* fref2, const pixel* fref3, intptr_t frefstride, int32_t* res);
 typedef void (*pixelcmp_x3_t)(const pixel* fenc, const pixel* fref0, const pixel* fref1, const pixel* fref2, intptr_t frefstride, int32_t* res);
@@ -143,6 +144,7 @@ typedef void (*blockfill_s_t)(int16_t* dst, intptr_t dstride, int16_t val);
 typedef void (*intra_pred_t)(pixel* dst, intptr_t dstStride, const pixel *srcPix, int dirMode, int bFilter);
 typedef void (*intra_allangs_t)(pixel *dst, pixel *refPix, pixel *filtPix, int bLuma);
 typedef void (*intra_filter_t)(const pixel* references, pixel* filtered);
+typedef void (*intra_grad_hist_t)(const pixel* src, intptr_t srcStride, uint32_t* hist);
 
 typedef void (*cpy2Dto1D_shl_t)(int16_t* dst, const int16_t* src, intptr_t srcStride, int shift);
 typedef void (*cpy2Dto1D_shr_t)(int16_t* dst, const int16_t* src, intptr_t srcStride, int shift);
@@ -202,12 +204,19 @@ typedef void (*saoCuStatsE0_t)(const int16_t *diff, const pixel *rec, intptr_t s
 typedef void (*saoCuStatsE1_t)(const int16_t *diff, const pixel *rec, intptr_t stride, int8_t *upBuff1, int endX, int endY, int32_t *stats, int32_t *count);
 typedef void (*saoCuStatsE2_t)(const int16_t *diff, const pixel *rec, intptr_t stride, int8_t *upBuff1, int8_t *upBuff, int endX, int endY, int32_t *stats, int32_t *count);
 typedef void (*saoCuStatsE3_t)(const int16_t *diff, const pixel *rec, intptr_t stride, int8_t *upBuff1, int endX, int endY, int32_t *stats, int32_t *count);
+typedef void (*saoEstOffsets_t)(const int32_t *count, const int32_t *offsetOrg, int32_t *offset, int32_t *distClasses, int64_t *costClasses, int numClasses, int bBandOffset, int64_t lambda);
 
 typedef void (*sign_t)(int8_t *dst, const pixel *src1, const pixel *src2, const int endX);
 typedef void (*planecopy_cp_t) (const uint8_t* src, intptr_t srcStride, pixel* dst, intptr_t dstStride, int width, int height, int shift);
 typedef void (*planecopy_sp_t) (const uint16_t* src, intptr_t srcStride, pixel* dst, intptr_t dstStride, int width, int height, int shift, uint16_t mask);
 typedef void (*planecopy_pp_t) (const pixel* src, intptr_t srcStride, pixel* dst, intptr_t dstStride, int width, int height, int shift);
 typedef pixel (*planeClipAndMax_t)(pixel *src, intptr_t stride, int width, int height, uint64_t *outsum, const pixel minPix, const pixel maxPix);
+typedef uint32_t (*hashCRC_t)(const pixel* plane, intptr_t stride, uint32_t width, uint32_t height, uint32_t crcVal);
+typedef uint32_t (*hashChecksum_t)(const pixel* plane, intptr_t stride, uint32_t width, uint32_t height, uint32_t y0);
+typedef uint32_t (*nalEscape_t)(uint8_t* dst, const uint8_t* src, uint32_t size);
+typedef uint32_t (*edgeCount_t)(const pixel* src, intptr_t stride, int width, int height, int threshold);
+typedef void (*gaussianRow_t)(pixel* dst, const pixel* src, intptr_t stride, int width);
+typedef void (*edgeRow_t)(pixel* dst, const pixel* src, intptr_t stride, int width, int threshold, pixel white);
 
 typedef void (*cutree_propagate_cost) (int* dst, const uint16_t* propagateIn, const int32_t* intraCosts, const uint16_t* interCosts, const int32_t* invQscales, const double* fpsFactor, int len);
 
@@ -230,6 +239,7 @@ typedef void(*nonPsyRdoQuant_t)(int16_t *m_resiDctCoeff, int64_t *costUncoded, i
 typedef void(*psyRdoQuant_t)(int16_t *m_resiDctCoeff, int16_t *m_fencDctCoeff, int64_t *costUncoded, int64_t *totalUncodedCost, int64_t *totalRdCost, int64_t *psyScale, uint32_t blkPos);
 typedef void(*psyRdoQuant_t1)(int16_t *m_resiDctCoeff, int64_t *costUncoded, int64_t *totalUncodedCost, int64_t *totalRdCost,uint32_t blkPos);
 typedef void(*psyRdoQuant_t2)(int16_t *m_resiDctCoeff, int16_t *m_fencDctCoeff, int64_t *costUncoded, int64_t *totalUncodedCost, int64_t *totalRdCost, int64_t *psyScale, uint32_t blkPos);
+typedef void(*rdoQuantLevelDist_t)(const int16_t *m_resiDctCoeff, const int16_t *dstCoeff, const int32_t *unquantScale, int64_t *costUncoded, int64_t *levelDist, int32_t *unquantLevel, uint32_t blkPos, int per, int unquantShift);
 typedef void(*ssimDistortion_t)(const pixel *fenc, uint32_t fStride, const pixel *recon,  intptr_t rstride, uint64_t *ssBlock, int shift, uint64_t *ac_k);
 typedef void(*normFactor_t)(const pixel *src, uint32_t blockSize, int shift, uint64_t *z_k);
 /* Function pointers to optimized encoder primitives. Each pointer can reference
@@ -299,15 +309,18 @@ struct EncoderPrimitives
         pixel_sse_ss_t  sse_ss;        // Sum of Square Error (short, short) fenc alignment not assumed
         pixelcmp_t      psy_cost_pp;   // difference in AC energy between two pixel blocks
         pixel_ssd_s_t   ssd_s[NUM_ALIGNMENT_TYPES];         // Sum of Square Error (residual coeff to self)
+        pixel_sad_s_t   sad_s;         // Sum of Absolute residual values
         pixelcmp_t      sa8d;          // Sum of Transformed Differences (8x8 Hadamard), uses satd for 4x4 intra TU
         transpose_t     transpose;     // transpose pixel block; for use with intra all-angs
         intra_allangs_t intra_pred_allangs;
         intra_filter_t  intra_filter;
         intra_pred_t    intra_pred[NUM_INTRA_MODE];
+        intra_grad_hist_t intra_grad_hist; // Sobel edge-orientation histogram, binned by intra mode
         nonPsyRdoQuant_t nonPsyRdoQuant;
         psyRdoQuant_t    psyRdoQuant;
 		psyRdoQuant_t1   psyRdoQuant_1p;
 		psyRdoQuant_t2   psyRdoQuant_2p;
+        rdoQuantLevelDist_t rdoQuantLevelDist; // RDOQ uncoded cost and level/level-1 distortion of one 4x4 coeff group
         ssimDistortion_t ssimDist;
         normFactor_t     normFact;
     }
@@ -350,6 +363,7 @@ struct EncoderPrimitives
     saoCuStatsE1_t        saoCuStatsE1;
     saoCuStatsE2_t        saoCuStatsE2;
     saoCuStatsE3_t        saoCuStatsE3;
+    saoEstOffsets_t       saoEstOffsets; // RD search of the offset of each SAO class, numClasses is a multiple of 4
 
     downscale_t           frameInitLowres;
     downscale_t           frameInitLowerRes;
@@ -364,6 +378,28 @@ struct EncoderPrimitives
     planecopy_pp_t        planecopy_pp_shr;
     planeClipAndMax_t     planeClipAndMax;
 
+    /* decoded picture hash SEI, the CRC state is updated and returned, the checksum
+     * returns the sum of the rows starting at picture row y0 */
+    hashCRC_t             hashCRC;
+    hashChecksum_t        hashChecksum;
+
+    /* NAL emulation prevention, returns the escaped size. dst must hold
+     * size + size / 2 bytes and may not overlap src */
+    nalEscape_t           nalEscape;
+
+    /* counts the pixels off the border of the block whose Sobel gradient
+     * magnitude, as computed by computeEdge(), is at least threshold */
+    edgeCount_t           edgeCount;
+
+    /* one row of the 5x5 Gaussian filter of --aq-mode 4, reading src rows -2
+     * to 2 and columns -2 to width + 1 */
+    gaussianRow_t         gaussianRow;
+
+    /* one row of the edge map of --aq-mode 4, white where the Sobel gradient
+     * magnitude is at least threshold and 0 elsewhere. Reads src rows -1 to 1
+     * and columns -1 to width */
+    edgeRow_t             edgeRow;
+
     weightp_sp_t          weight_sp;
     weightp_pp_t          weight_pp;
 
@@ -479,6 +479,39 @@ uint32_t Quant::transformNxN(const CUData& cu, const pixel* fenc, uint32_t fencS
     }
 }
 
+/* Every basis value of the forward DCT is at most 90 in magnitude, so the
+ * first stage output of a column is bounded by 90 times the column SAD and
+ * the largest coefficient of the block by 90 * 90 * SAD, less the stage
+ * shifts. If even that coefficient falls inside the dead zone of the
+ * largest rounding offset used by nquant and quant, no coefficient of the
+ * block can survive quantization, whatever RDOQ or sign hiding would do.
+ * Noise reduction is excluded since it accumulates coefficient statistics
+ * even for blocks which quantize to zero. The bound does not hold for the
+ * 16x16 and 32x32 lowpass DCT, whose floored 2x2 averaging can raise a
+ * coefficient above it, so those sizes are never skipped with --lowpass-dct */
+bool Quant::isZeroBlock(const CUData& cu, uint32_t sad, uint32_t log2TrSize, TextType ttype, uint32_t absPartIdx) const
+{
+    if (cu.m_tqBypass[0] || (m_nr && m_nr->offset))
+        return false;
+    if (cu.m_encData->m_param->bLowPassDct && log2TrSize >= 4)
+        return false;
+
+    const uint64_t maxBasis = 90;
+    int shift1 = log2TrSize - 1 + X265_DEPTH - 8;
+    int shift2 = log2TrSize + 6;
+    int transformShift = MAX_TR_DYNAMIC_RANGE - X265_DEPTH - log2TrSize;
+
+    /* each rounded stage output may exceed its exact value by one half */
+    uint64_t firstStageSum = (maxBasis * sad + ((uint64_t)1 << (log2TrSize + shift1 - 1))) >> shift1;
+    uint64_t maxCoeff = (maxBasis * firstStageSum + ((uint64_t)1 << (shift2 - 1))) >> shift2;
+
+    int scalingListType = (cu.isIntra(absPartIdx) ? 0 : 3) + ttype;
+    int qbits = QUANT_SHIFT + m_qpParam[ttype].per + transformShift;
+    uint64_t quantCoef = m_scalingList->m_quantCoefMax[log2TrSize - 2][scalingListType][m_qpParam[ttype].rem];
+
+    return maxCoeff * quantCoef < ((uint64_t)1 << (qbits - 1));
+}
+
 uint64_t Quant::ssimDistortion(const CUData& cu, const pixel* fenc, uint32_t fStride, const pixel* recon, intptr_t rstride, uint32_t log2TrSize, TextType ttype, uint32_t absPartIdx)
 {
     static const int ssim_c1 = (int)(.01 * .01 * PIXEL_MAX * PIXEL_MAX * 64 + .5); // 416
@@ -639,7 +672,6 @@ uint32_t Quant::rdoQuant(const CUData& cu, int16_t* dstCoeff, TextType ttype, ui
 
 #define UNQUANT(lvl)    (((lvl) * (unquantScale[blkPos] << per) + unquantRound) >> unquantShift)
 #define SIGCOST(bits)   ((lambda2 * (bits)) >> 8)
-#define RDCOST(d, bits) ((((int64_t)d * d) << scaleBits) + SIGCOST(bits))
 #define PSYVALUE(rec)   ((psyScale * (rec)) >> X265_MAX(0, (2 * transformShift + 1)))
 
     int64_t costCoeff[trSize * trSize];   /* d*d + lambda * bits */
@@ -864,21 +896,30 @@ uint32_t Quant::rdoQuant(const CUData& cu, int16_t* dstCoeff, TextType ttype, ui
         uint32_t levelThreshold = 3;
         uint32_t c1Idx       = 0;
         uint32_t c2Idx       = 0;
+
+        /* RDOQ measures distortion as the squared difference between the unquantized coded level
+         * and the original DCT coefficient. The result is shifted scaleBits to account for the
+         * FIX15 nature of the CABAC cost tables minus the forward transform scale. None of it
+         * depends on the CABAC state, so the uncoded cost and the distortion of both candidate
+         * levels are measured for the whole coefficient group up front; only the rate terms
+         * are evaluated serially below */
+        ALIGN_VAR_32(int64_t, levelDist[2 * MLS_CG_BLK_SIZE]);
+        ALIGN_VAR_32(int32_t, unquantLevel[2 * MLS_CG_BLK_SIZE]);
+        primitives.cu[log2TrSize - 2].rdoQuantLevelDist(m_resiDctCoeff, dstCoeff, unquantScale, costUncoded, levelDist, unquantLevel,
+                                                        codeParams.scan[cgScanPos << MLS_CG_SIZE], per, unquantShift);
+
         /* iterate over coefficients in each group in reverse scan order */
         for (int scanPosinCG = cgSize - 1; scanPosinCG >= 0; scanPosinCG--)
         {
             scanPos              = (cgScanPos << MLS_CG_SIZE) + scanPosinCG;
             uint32_t blkPos      = codeParams.scan[scanPos];
+            uint32_t cgBlkIdx    = g_scan4x4[codeParams.scanType][scanPosinCG]; /* raster position within the group */
             uint32_t maxAbsLevel = dstCoeff[blkPos];                  /* abs(quantized coeff) */
             int signCoef         = m_resiDctCoeff[blkPos];            /* pre-quantization DCT coeff */
             int predictedCoef    = m_fencDctCoeff[blkPos] - signCoef; /* predicted DCT = source DCT - residual DCT*/
 
-            /* RDOQ measures distortion as the squared difference between the unquantized coded level
-             * and the original DCT coefficient. The result is shifted scaleBits to account for the
-             * FIX15 nature of the CABAC cost tables minus the forward transform scale */
-
             /* cost of not coding this coefficient (all distortion, no signal bits) */
-            costUncoded[blkPos] = ((int64_t)signCoef * signCoef) << scaleBits;
+            X265_CHECK(costUncoded[blkPos] == ((int64_t)signCoef * signCoef) << scaleBits, "uncoded cost mismatch\n");
             X265_CHECK((!!scanPos ^ !!blkPos) == 0, "failed on (blkPos=0 && scanPos!=0)\n");
             if (usePsyMask & scanPos)
                 /* when no residual coefficient is coded, predicted coef == recon coef */
@@ -953,17 +994,15 @@ uint32_t Quant::rdoQuant(const CUData& cu, int16_t* dstCoeff, TextType ttype, ui
                     sigCoefBits = estBitsSbac.significantBits[1][ctxSig];
                 }
 
-                const uint32_t unQuantLevel = (maxAbsLevel * (unquantScale[blkPos] << per) + unquantRound);
                 // NOTE: X265_MAX(maxAbsLevel - 1, 1) ==> (X>=2 -> X-1), (X<2 -> 1)  | (0 < X < 2 ==> X=1)
                 if (maxAbsLevel == 1)
                 {
                     uint32_t levelBits = (c1c2idx & 1) ? greaterOneBits[0] + IEP_RATE : ((1 + goRiceParam) << 15) + IEP_RATE;
                     X265_CHECK(levelBits == getICRateCost(1, 1 - baseLevel, greaterOneBits, levelAbsBits, goRiceParam, c1c2Rate) + IEP_RATE, "levelBits mistake\n");
 
-                    int unquantAbsLevel = unQuantLevel >> unquantShift;
+                    int unquantAbsLevel = unquantLevel[cgBlkIdx];
                     X265_CHECK(UNQUANT(1) == unquantAbsLevel, "DQuant check failed\n");
-                    int d = abs(signCoef) - unquantAbsLevel;
-                    int64_t curCost = RDCOST(d, sigCoefBits + levelBits);
+                    int64_t curCost = levelDist[cgBlkIdx] + SIGCOST(sigCoefBits + levelBits);
 
                     /* Psy RDOQ: bias in favor of higher AC coefficients in the reconstructed frame */
                     if (usePsyMask & scanPos)
@@ -984,17 +1023,13 @@ uint32_t Quant::rdoQuant(const CUData& cu, int16_t* dstCoeff, TextType ttype, ui
                     uint32_t levelBits0 = getICRateCost(maxAbsLevel,     maxAbsLevel     - baseLevel, greaterOneBits, levelAbsBits, goRiceParam, c1c2Rate) + IEP_RATE;
                     uint32_t levelBits1 = getICRateCost(maxAbsLevel - 1, maxAbsLevel - 1 - baseLevel, greaterOneBits, levelAbsBits, goRiceParam, c1c2Rate) + IEP_RATE;
 
-                    const uint32_t preDQuantLevelDiff = (unquantScale[blkPos] << per);
-
-                    const int unquantAbsLevel0 = unQuantLevel >> unquantShift;
+                    const int unquantAbsLevel0 = unquantLevel[cgBlkIdx];
                     X265_CHECK(UNQUANT(maxAbsLevel) == (uint32_t)unquantAbsLevel0, "DQuant check failed\n");
-                    int d0 = abs(signCoef) - unquantAbsLevel0;
-                    int64_t curCost0 = RDCOST(d0, sigCoefBits + levelBits0);
+                    int64_t curCost0 = levelDist[cgBlkIdx] + SIGCOST(sigCoefBits + levelBits0);
 
-                    const int unquantAbsLevel1 = (unQuantLevel - preDQuantLevelDiff) >> unquantShift;
+                    const int unquantAbsLevel1 = unquantLevel[MLS_CG_BLK_SIZE + cgBlkIdx];
                     X265_CHECK(UNQUANT(maxAbsLevel - 1) == (uint32_t)unquantAbsLevel1, "DQuant check failed\n");
-                    int d1 = abs(signCoef) - unquantAbsLevel1;
-                    int64_t curCost1 = RDCOST(d1, sigCoefBits + levelBits1);
+                    int64_t curCost1 = levelDist[MLS_CG_BLK_SIZE + cgBlkIdx] + SIGCOST(sigCoefBits + levelBits1);
 
                     /* Psy RDOQ: bias in favor of higher AC coefficients in the reconstructed frame */
                     if (usePsyMask & scanPos)
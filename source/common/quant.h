@@ -111,6 +111,10 @@ public:
 
     void invtransformNxN(const CUData& cu, int16_t* residual, uint32_t resiStride, const coeff_t* coeff,
                          uint32_t log2TrSize, TextType ttype, bool bIntra, bool useTransformSkip, uint32_t numSig);
+
+    /* returns true if a residual block with the given SAD is certain to
+     * quantize to all zero coefficients, without transforming it */
+    bool isZeroBlock(const CUData& cu, uint32_t sad, uint32_t log2TrSize, TextType ttype, uint32_t absPartIdx) const;
     uint64_t ssimDistortion(const CUData& cu, const pixel* fenc, uint32_t fStride, const pixel* recon, intptr_t rstride,
                             uint32_t log2TrSize, TextType ttype, uint32_t absPartIdx);
 
@@ -387,6 +387,11 @@ void ScalingList::setupQuantMatrices(int internalCsp)
                         dequantCoeff[i] = s_invQuantScales[rem];
                     }
                 }
+
+                int32_t quantMax = 0;
+                for (int i = 0; i < count; i++)
+                    quantMax = X265_MAX(quantMax, quantCoeff[i]);
+                m_quantCoefMax[size][list][rem] = quantMax;
             }
         }
     }
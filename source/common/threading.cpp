@@ -87,6 +87,9 @@ int no_atomic_add(int* ptr, int val)
 /* C shim for forced stack alignment */
 static void stackAlignMain(Thread *instance)
 {
+#if ENABLE_TRACE
+    traceSetSession(instance->m_traceSession);
+#endif
     // defer processing to the virtual function implemented in the derived class
     instance->threadMain();
 }
@@ -104,6 +107,9 @@ bool Thread::start()
 {
     DWORD threadId;
 
+#if ENABLE_TRACE
+    m_traceSession = traceSession();
+#endif
     thread = CreateThread(NULL, 0, (LPTHREAD_START_ROUTINE)ThreadShim, this, 0, &threadId);
 
     return threadId > 0;
@@ -135,6 +141,9 @@ static void *ThreadShim(void *opaque)
 
 bool Thread::start()
 {
+#if ENABLE_TRACE
+    m_traceSession = traceSession();
+#endif
     if (pthread_create(&thread, NULL, ThreadShim, this))
     {
         thread = 0;
@@ -157,6 +166,9 @@ Thread::~Thread() {}
 Thread::Thread()
 {
     thread = 0;
+#if ENABLE_TRACE
+    m_traceSession = 0;
+#endif
 }
 
 }
@@ -520,6 +520,10 @@ public:
     bool start();
 
     void stop();
+
+#if ENABLE_TRACE
+    int m_traceSession; // trace session of the thread which started this one
+#endif
 };
 } // end namespace X265_NS
 
@@ -0,0 +1,135 @@
+/*****************************************************************************
+ * Copyright (C) 2013-2020 MulticoreWare, Inc
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02111, USA.
+ *
+ * This program is also available under a commercial proprietary license.
+ * For more information, contact us at license @ x265.com.
+ *****************************************************************************/
+
+#include "common.h"
+#include "primitives.h"
+#include <immintrin.h> // AVX2
+
+using namespace X265_NS;
+
+namespace {
+
+/* load two rows of four 16bit coefficients, sign extended to 32 bits */
+static inline __m256i load2x4(const int16_t* src, intptr_t stride)
+{
+    __m128i rows = _mm_unpacklo_epi64(_mm_loadl_epi64((const __m128i*)src),
+                                      _mm_loadl_epi64((const __m128i*)(src + stride)));
+    return _mm256_cvtepi16_epi32(rows);
+}
+
+/* squares of eight signed 32bit values, widened to 64 bits and scaled */
+static inline void store_sqr64(int64_t* lo, int64_t* hi, __m256i v, __m128i shift)
+{
+    __m256i v0 = _mm256_cvtepi32_epi64(_mm256_castsi256_si128(v));
+    __m256i v1 = _mm256_cvtepi32_epi64(_mm256_extracti128_si256(v, 1));
+    _mm256_storeu_si256((__m256i*)lo, _mm256_sll_epi64(_mm256_mul_epi32(v0, v0), shift));
+    _mm256_storeu_si256((__m256i*)hi, _mm256_sll_epi64(_mm256_mul_epi32(v1, v1), shift));
+}
+
+template<int log2TrSize>
+void rdoQuantLevelDist(const int16_t *m_resiDctCoeff, const int16_t *dstCoeff, const int32_t *unquantScale, int64_t *costUncoded, int64_t *levelDist, int32_t *unquantLevel, uint32_t blkPos, int per, int unquantShift)
+{
+    const int transformShift = MAX_TR_DYNAMIC_RANGE - X265_DEPTH - log2TrSize;
+    const int scaleBits = SCALE_BITS - 2 * transformShift;
+    const intptr_t trSize = 1 << log2TrSize;
+    const int unquantRound = (unquantShift > per) ? 1 << (unquantShift - per - 1) : 0;
+
+    const __m128i scaleShift = _mm_cvtsi32_si128(scaleBits);
+    const __m128i uqShift = _mm_cvtsi32_si128(unquantShift);
+    const __m128i perShift = _mm_cvtsi32_si128(per);
+    const __m256i round = _mm256_set1_epi32(unquantRound);
+    const __m256i zero = _mm256_setzero_si256();
+
+    /* two rows of the coefficient group per iteration */
+    for (int y = 0; y < MLS_CG_SIZE; y += 2)
+    {
+        __m256i coef = load2x4(m_resiDctCoeff + blkPos, trSize);
+        __m256i level0 = load2x4(dstCoeff + blkPos, trSize);
+        __m256i scale = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)(unquantScale + blkPos))),
+                                                _mm_loadu_si128((const __m128i*)(unquantScale + blkPos + trSize)), 1);
+        scale = _mm256_sll_epi32(scale, perShift);
+
+        /* lower candidate is level - 1, floored at zero (cmpgt yields -1) */
+        __m256i level1 = _mm256_add_epi32(level0, _mm256_cmpgt_epi32(level0, zero));
+
+        /* 32bit wrapping multiply and logical shift match the unsigned scalar unquant */
+        __m256i unquant0 = _mm256_srl_epi32(_mm256_add_epi32(_mm256_mullo_epi32(level0, scale), round), uqShift);
+        __m256i unquant1 = _mm256_srl_epi32(_mm256_add_epi32(_mm256_mullo_epi32(level1, scale), round), uqShift);
+        __m256i absCoef = _mm256_abs_epi32(coef);
+
+        const int idx = y * MLS_CG_SIZE;
+        _mm256_storeu_si256((__m256i*)(unquantLevel + idx), unquant0);
+        _mm256_storeu_si256((__m256i*)(unquantLevel + MLS_CG_BLK_SIZE + idx), unquant1);
+
+        store_sqr64(costUncoded + blkPos, costUncoded + blkPos + trSize, coef, scaleShift);
+        store_sqr64(levelDist + idx, levelDist + idx + MLS_CG_SIZE, _mm256_sub_epi32(absCoef, unquant0), scaleShift);
+        store_sqr64(levelDist + MLS_CG_BLK_SIZE + idx, levelDist + MLS_CG_BLK_SIZE + idx + MLS_CG_SIZE, _mm256_sub_epi32(absCoef, unquant1), scaleShift);
+
+        blkPos += 2 * trSize;
+    }
+}
+
+/* sum of absolute residual values; residuals never reach -32768, the one
+ * value abs_epi16 cannot represent */
+template<int size>
+uint32_t sad_s(const int16_t* res, intptr_t stride)
+{
+    const __m256i one = _mm256_set1_epi16(1);
+    __m256i sum = _mm256_setzero_si256();
+
+    for (int y = 0; y < size; y += (size == 8 ? 2 : 1))
+    {
+        if (size == 8)
+        {
+            __m256i rows = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)(res + y * stride))),
+                                                   _mm_loadu_si128((const __m128i*)(res + (y + 1) * stride)), 1);
+            sum = _mm256_add_epi32(sum, _mm256_madd_epi16(_mm256_abs_epi16(rows), one));
+        }
+        else
+        {
+            for (int x = 0; x < size; x += 16)
+            {
+                __m256i row = _mm256_loadu_si256((const __m256i*)(res + y * stride + x));
+                sum = _mm256_add_epi32(sum, _mm256_madd_epi16(_mm256_abs_epi16(row), one));
+            }
+        }
+    }
+
+    __m128i sum4 = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+    sum4 = _mm_add_epi32(sum4, _mm_shuffle_epi32(sum4, _MM_SHUFFLE(1, 0, 3, 2)));
+    sum4 = _mm_add_epi32(sum4, _mm_shuffle_epi32(sum4, _MM_SHUFFLE(2, 3, 0, 1)));
+    return (uint32_t)_mm_cvtsi128_si32(sum4);
+}
+}
+
+namespace X265_NS {
+void setupIntrinsicDCT_avx2(EncoderPrimitives &p)
+{
+    p.cu[BLOCK_4x4].rdoQuantLevelDist   = rdoQuantLevelDist<2>;
+    p.cu[BLOCK_8x8].rdoQuantLevelDist   = rdoQuantLevelDist<3>;
+    p.cu[BLOCK_16x16].rdoQuantLevelDist = rdoQuantLevelDist<4>;
+    p.cu[BLOCK_32x32].rdoQuantLevelDist = rdoQuantLevelDist<5>;
+
+    p.cu[BLOCK_8x8].sad_s   = sad_s<8>;
+    p.cu[BLOCK_16x16].sad_s = sad_s<16>;
+    p.cu[BLOCK_32x32].sad_s = sad_s<32>;
+}
+}
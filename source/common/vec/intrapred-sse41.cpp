@@ -0,0 +1,141 @@
+/*****************************************************************************
+ * Copyright (C) 2013-2020 MulticoreWare, Inc
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02111, USA.
+ *
+ * This program is also available under a commercial proprietary license.
+ * For more information, contact us at license @ x265.com.
+ *****************************************************************************/
+
+#include "common.h"
+#include "primitives.h"
+#include <xmmintrin.h> // SSE
+#include <smmintrin.h> // SSE4.1
+
+using namespace X265_NS;
+
+namespace {
+
+/* load four horizontally adjacent pixels, zero extended to 32 bits */
+static inline __m128i load4(const pixel* src)
+{
+#if HIGH_BIT_DEPTH
+    return _mm_cvtepu16_epi32(_mm_loadl_epi64((const __m128i*)src));
+#else
+    int32_t v;
+    memcpy(&v, src, sizeof(v));
+    return _mm_cvtepu8_epi32(_mm_cvtsi32_si128(v));
+#endif
+}
+
+static const int angThresh[8] = { 2, 7, 14, 22, 30, 38, 47, 58 };
+
+/* scalar tail, must match gradientToIntraMode() in intrapred.cpp */
+static inline void gradHistPixel(const pixel* above, const pixel* cur, const pixel* below, int x, uint32_t* hist)
+{
+    int gx = (above[x + 1] + 2 * cur[x + 1] + below[x + 1]) - (above[x - 1] + 2 * cur[x - 1] + below[x - 1]);
+    int gy = (below[x - 1] + 2 * below[x] + below[x + 1]) - (above[x - 1] + 2 * above[x] + above[x + 1]);
+
+    int absX = abs(gx), absY = abs(gy);
+    bool bVer = absX > absY;
+    int num = bVer ? absY : absX;
+    int den = bVer ? absX : absY;
+
+    int k = 0;
+    for (int i = 0; i < 8; i++)
+        k += (num << 6) > angThresh[i] * den;
+
+    bool bPositive = (gx ^ gy) >= 0;
+    int mode = bVer ? (bPositive ? 26 + k : 26 - k) : (bPositive ? 10 - k : 10 + k);
+    hist[mode] += absX + absY;
+}
+
+template<int log2Size>
+void intra_grad_hist(const pixel* src, intptr_t srcStride, uint32_t* hist)
+{
+    const int size = 1 << log2Size;
+
+    memset(hist, 0, NUM_INTRA_MODE * sizeof(uint32_t));
+
+    const __m128i c10 = _mm_set1_epi32(10);
+    const __m128i c16 = _mm_set1_epi32(16);
+    __m128i thresh[8];
+    for (int i = 0; i < 8; i++)
+        thresh[i] = _mm_set1_epi32(angThresh[i]);
+
+    ALIGN_VAR_16(int32_t, modes[4]);
+    ALIGN_VAR_16(int32_t, amps[4]);
+
+    for (int y = 1; y < size - 1; y++)
+    {
+        const pixel* above = src + (y - 1) * srcStride;
+        const pixel* cur   = src + y * srcStride;
+        const pixel* below = src + (y + 1) * srcStride;
+
+        int x = 1;
+        /* four pixels per iteration, loads must stay within the block */
+        for (; x + 4 <= size - 1; x += 4)
+        {
+            __m128i aL = load4(above + x - 1), aC = load4(above + x), aR = load4(above + x + 1);
+            __m128i cL = load4(cur + x - 1), cR = load4(cur + x + 1);
+            __m128i bL = load4(below + x - 1), bC = load4(below + x), bR = load4(below + x + 1);
+
+            __m128i gx = _mm_sub_epi32(_mm_add_epi32(_mm_add_epi32(aR, bR), _mm_slli_epi32(cR, 1)),
+                                       _mm_add_epi32(_mm_add_epi32(aL, bL), _mm_slli_epi32(cL, 1)));
+            __m128i gy = _mm_sub_epi32(_mm_add_epi32(_mm_add_epi32(bL, bR), _mm_slli_epi32(bC, 1)),
+                                       _mm_add_epi32(_mm_add_epi32(aL, aR), _mm_slli_epi32(aC, 1)));
+
+            __m128i absX = _mm_abs_epi32(gx);
+            __m128i absY = _mm_abs_epi32(gy);
+            __m128i ver = _mm_cmpgt_epi32(absX, absY);
+            __m128i num = _mm_slli_epi32(_mm_min_epi32(absX, absY), 6);
+            __m128i den = _mm_max_epi32(absX, absY);
+
+            /* k = number of angle thresholds exceeded, accumulated as -1 per compare */
+            __m128i negk = _mm_setzero_si128();
+            for (int i = 0; i < 8; i++)
+                negk = _mm_add_epi32(negk, _mm_cmpgt_epi32(num, _mm_mullo_epi32(thresh[i], den)));
+
+            /* mode = base + k when the offset runs positive, base - k otherwise.
+             * vertical family: base 26, positive slope adds; horizontal
+             * family: base 10, positive slope subtracts */
+            __m128i neg = _mm_srai_epi32(_mm_xor_si128(gx, gy), 31);
+            __m128i addk = _mm_xor_si128(ver, neg);
+            __m128i offset = _mm_blendv_epi8(negk, _mm_sub_epi32(_mm_setzero_si128(), negk), addk);
+            __m128i base = _mm_add_epi32(c10, _mm_and_si128(ver, c16));
+
+            _mm_store_si128((__m128i*)modes, _mm_add_epi32(base, offset));
+            _mm_store_si128((__m128i*)amps, _mm_add_epi32(absX, absY));
+
+            hist[modes[0]] += amps[0];
+            hist[modes[1]] += amps[1];
+            hist[modes[2]] += amps[2];
+            hist[modes[3]] += amps[3];
+        }
+
+        for (; x < size - 1; x++)
+            gradHistPixel(above, cur, below, x, hist);
+    }
+}
+}
+
+namespace X265_NS {
+void setupIntrinsicIntra_sse41(EncoderPrimitives &p)
+{
+    p.cu[BLOCK_8x8].intra_grad_hist = intra_grad_hist<3>;
+    p.cu[BLOCK_16x16].intra_grad_hist = intra_grad_hist<4>;
+    p.cu[BLOCK_32x32].intra_grad_hist = intra_grad_hist<5>;
+}
+}
@@ -0,0 +1,433 @@
+/*****************************************************************************
+ * Copyright (C) 2013-2020 MulticoreWare, Inc
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02111, USA.
+ *
+ * This program is also available under a commercial proprietary license.
+ * For more information, contact us at license @ x265.com.
+ *****************************************************************************/
+
+#include "common.h"
+#include "primitives.h"
+#include "constants.h"
+#include "threading.h"
+#include <immintrin.h> // AVX2, PCLMULQDQ
+
+using namespace X265_NS;
+
+namespace {
+
+static inline uint32_t crcBytes(uint32_t crcVal, const uint8_t* bytes, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++)
+        crcVal = g_crc16Table[(crcVal >> 8) & 0xff] ^ (((crcVal << 8) & 0xff00) | bytes[i]);
+
+    return crcVal;
+}
+
+/* The CRC state is the message polynomial modulo P = x^16 + 0x1021, so the
+ * row is folded 16 bytes at a time into a 128bit accumulator kept congruent to
+ * it: acc * x^128 + data = hi * (x^192 mod P) + lo * (x^128 mod P) + data,
+ * both carry-less products staying below 2^80. The accumulator is reduced
+ * once per row through the byte table, which also takes the remaining bytes.
+ * x86 is little endian, so the bytes of a row are already in the low byte then
+ * high byte order of the SEI */
+uint32_t hash_crc(const pixel* plane, intptr_t stride, uint32_t width, uint32_t height, uint32_t crcVal)
+{
+    const __m128i fold = _mm_set_epi64x(0x650b /* x^192 mod P */, 0xaefc /* x^128 mod P */);
+    const __m128i bswap = _mm_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+    const uint32_t rowBytes = width * sizeof(pixel);
+
+    ALIGN_VAR_16(uint8_t, accBytes[16]);
+
+    for (uint32_t y = 0; y < height; y++)
+    {
+        const uint8_t* bytes = (const uint8_t*)(plane + y * stride);
+        uint32_t x = 0;
+
+        if (rowBytes >= 64)
+        {
+            __m128i acc = _mm_cvtsi32_si128(crcVal);
+            for (; x + 16 <= rowBytes; x += 16)
+            {
+                /* the first byte of the message is the highest order term */
+                __m128i data = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(bytes + x)), bswap);
+                acc = _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(acc, fold, 0x11),
+                                                  _mm_clmulepi64_si128(acc, fold, 0x00)), data);
+            }
+
+            _mm_store_si128((__m128i*)accBytes, _mm_shuffle_epi8(acc, bswap));
+            crcVal = crcBytes(0, accBytes, 16);
+        }
+
+        crcVal = crcBytes(crcVal, bytes + x, rowBytes - x);
+    }
+
+    return crcVal;
+}
+
+/* x is a multiple of the vector width within the loop, so x >> 8 is common to
+ * all lanes and x & 0xff does not wrap */
+uint32_t hash_checksum(const pixel* plane, intptr_t stride, uint32_t width, uint32_t height, uint32_t y0)
+{
+    uint32_t sum = 0;
+
+#if HIGH_BIT_DEPTH
+    const __m256i iota = _mm256_setr_epi16(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    const __m256i lowByte = _mm256_set1_epi16(0xff);
+    const __m256i one = _mm256_set1_epi16(1);
+#else
+    const __m256i iota = _mm256_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15,
+                                          16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31);
+    const __m256i zero = _mm256_setzero_si256();
+#endif
+
+    for (uint32_t y = y0; y < y0 + height; y++, plane += stride)
+    {
+        const uint32_t yMask = (y & 0xff) ^ (y >> 8);
+        __m256i acc = _mm256_setzero_si256();
+        uint32_t x = 0;
+
+#if HIGH_BIT_DEPTH
+        for (; x + 16 <= width; x += 16)
+        {
+            __m256i mask = _mm256_xor_si256(_mm256_add_epi16(_mm256_set1_epi16((int16_t)(x & 0xff)), iota),
+                                            _mm256_set1_epi16((int16_t)(((x >> 8) ^ yMask) & 0xff)));
+            __m256i pix = _mm256_loadu_si256((const __m256i*)(plane + x));
+            __m256i val = _mm256_add_epi16(_mm256_xor_si256(_mm256_and_si256(pix, lowByte), mask),
+                                           _mm256_xor_si256(_mm256_srli_epi16(pix, 8), mask));
+            acc = _mm256_add_epi32(acc, _mm256_madd_epi16(val, one));
+        }
+
+        __m128i sum4 = _mm_add_epi32(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+        sum4 = _mm_add_epi32(sum4, _mm_shuffle_epi32(sum4, _MM_SHUFFLE(1, 0, 3, 2)));
+        sum4 = _mm_add_epi32(sum4, _mm_shuffle_epi32(sum4, _MM_SHUFFLE(2, 3, 0, 1)));
+        sum += (uint32_t)_mm_cvtsi128_si32(sum4);
+#else
+        for (; x + 32 <= width; x += 32)
+        {
+            __m256i mask = _mm256_xor_si256(_mm256_add_epi8(_mm256_set1_epi8((char)(x & 0xff)), iota),
+                                            _mm256_set1_epi8((char)((x >> 8) ^ yMask)));
+            __m256i pix = _mm256_loadu_si256((const __m256i*)(plane + x));
+            acc = _mm256_add_epi64(acc, _mm256_sad_epu8(_mm256_xor_si256(pix, mask), zero));
+        }
+
+        __m128i sum2 = _mm_add_epi64(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+        sum2 = _mm_add_epi64(sum2, _mm_unpackhi_epi64(sum2, sum2));
+        sum += (uint32_t)_mm_cvtsi128_si32(sum2);
+#endif
+
+        for (; x < width; x++)
+        {
+            uint8_t xorMask = (uint8_t)((x & 0xff) ^ (x >> 8) ^ yMask);
+            sum += (plane[x] & 0xff) ^ xorMask;
+#if HIGH_BIT_DEPTH
+            sum += (plane[x] >> 8) ^ xorMask;
+#endif
+        }
+    }
+
+    return sum;
+}
+
+/* a byte is escaped only when it is at most 0x03 and follows two zero input
+ * bytes, an injected 0x03 can only prevent it. 32 bytes are tested at a time
+ * and stored verbatim up to the first such candidate, which is then resolved
+ * against the output written so far, like nalEscape_c() */
+uint32_t nal_escape(uint8_t* dst, const uint8_t* src, uint32_t size)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i three = _mm256_set1_epi8(3);
+
+    /* the first two bytes can never be escaped */
+    uint32_t i = X265_MIN(size, 2u);
+    uint32_t bytes = i;
+    memcpy(dst, src, i);
+
+    while (i + 32 <= size)
+    {
+        __m256i cur = _mm256_loadu_si256((const __m256i*)(src + i));
+        __m256i pair = _mm256_and_si256(_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(src + i - 2)), zero),
+                                        _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(src + i - 1)), zero));
+        __m256i small = _mm256_cmpeq_epi8(_mm256_min_epu8(cur, three), cur);
+        uint32_t cand = (uint32_t)_mm256_movemask_epi8(_mm256_and_si256(pair, small));
+
+        _mm256_storeu_si256((__m256i*)(dst + bytes), cur);
+        if (!cand)
+        {
+            i += 32;
+            bytes += 32;
+            continue;
+        }
+
+        unsigned long skip;
+        CTZ(skip, cand);
+        i += skip;
+        bytes += skip;
+
+        if (!dst[bytes - 2] && !dst[bytes - 1])
+            dst[bytes++] = 3;
+        dst[bytes++] = src[i++];
+    }
+
+    for (; i < size; i++)
+    {
+        if (!dst[bytes - 2] && !dst[bytes - 1] && src[i] <= 0x03)
+            dst[bytes++] = 3;
+        dst[bytes++] = src[i];
+    }
+
+    return bytes;
+}
+
+/* input bit depth conversions, 16 samples per step with a scalar tail. Samples
+ * are converted in 16bit lanes, the 8bit builds truncate them to pixel like the
+ * C primitives do */
+static inline void storePixels16(pixel* dst, __m256i v)
+{
+#if HIGH_BIT_DEPTH
+    _mm256_storeu_si256((__m256i*)dst, v);
+#else
+    v = _mm256_and_si256(v, _mm256_set1_epi16(0xff));
+    _mm_storeu_si128((__m128i*)dst, _mm_packus_epi16(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1)));
+#endif
+}
+
+void planecopy_cp(const uint8_t* src, intptr_t srcStride, pixel* dst, intptr_t dstStride, int width, int height, int shift)
+{
+    const __m128i count = _mm_cvtsi32_si128(shift);
+
+    for (int r = 0; r < height; r++)
+    {
+        int c = 0;
+        for (; c + 16 <= width; c += 16)
+        {
+            __m256i v = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)(src + c)));
+            storePixels16(dst + c, _mm256_sll_epi16(v, count));
+        }
+        for (; c < width; c++)
+            dst[c] = ((pixel)src[c]) << shift;
+
+        dst += dstStride;
+        src += srcStride;
+    }
+}
+
+template<bool shiftLeft>
+void planecopy_sp(const uint16_t* src, intptr_t srcStride, pixel* dst, intptr_t dstStride, int width, int height, int shift, uint16_t mask)
+{
+    const __m128i count = _mm_cvtsi32_si128(shift);
+    const __m256i vmask = _mm256_set1_epi16((int16_t)mask);
+
+    for (int r = 0; r < height; r++)
+    {
+        int c = 0;
+        for (; c + 16 <= width; c += 16)
+        {
+            __m256i v = _mm256_loadu_si256((const __m256i*)(src + c));
+            v = shiftLeft ? _mm256_sll_epi16(v, count) : _mm256_srl_epi16(v, count);
+            storePixels16(dst + c, _mm256_and_si256(v, vmask));
+        }
+        for (; c < width; c++)
+            dst[c] = (pixel)((shiftLeft ? src[c] << shift : src[c] >> shift) & mask);
+
+        dst += dstStride;
+        src += srcStride;
+    }
+}
+
+static inline __m256i loadPixels16(const pixel* src)
+{
+#if HIGH_BIT_DEPTH
+    return _mm256_loadu_si256((const __m256i*)src);
+#else
+    return _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)src));
+#endif
+}
+
+/* Sobel edges of 16 pixels, in 32bit lanes in the order of unpacklo and
+ * unpackhi. The gradients are formed in 16bit lanes: three times the corner
+ * terms cannot overflow, the middle term is then added in two saturating steps
+ * of its own sign, so a 12bit gradient is clamped rather than wrapped. Clamping
+ * both gradients to the threshold before squaring keeps the sum in 32bit and
+ * the test exact */
+static inline void sobelEdges16(const pixel* p, intptr_t stride, __m256i maxGrad, __m256i below, __m256i& lo, __m256i& hi)
+{
+    const __m256i three = _mm256_set1_epi16(3);
+
+    __m256i tl = loadPixels16(p - stride - 1), tm = loadPixels16(p - stride), tr = loadPixels16(p - stride + 1);
+    __m256i ml = loadPixels16(p - 1), mr = loadPixels16(p + 1);
+    __m256i bl = loadPixels16(p + stride - 1), bm = loadPixels16(p + stride), br = loadPixels16(p + stride + 1);
+
+    __m256i gH = _mm256_mullo_epi16(_mm256_add_epi16(_mm256_sub_epi16(tr, tl), _mm256_sub_epi16(br, bl)), three);
+    __m256i d = _mm256_sub_epi16(mr, ml);
+    gH = _mm256_adds_epi16(_mm256_adds_epi16(gH, _mm256_slli_epi16(d, 3)), _mm256_slli_epi16(d, 1));
+
+    __m256i gV = _mm256_mullo_epi16(_mm256_add_epi16(_mm256_sub_epi16(bl, tl), _mm256_sub_epi16(br, tr)), three);
+    d = _mm256_sub_epi16(bm, tm);
+    gV = _mm256_adds_epi16(_mm256_adds_epi16(gV, _mm256_slli_epi16(d, 3)), _mm256_slli_epi16(d, 1));
+
+    /* unsigned, the absolute value of -32768 stays 0x8000 */
+    gH = _mm256_min_epu16(_mm256_abs_epi16(gH), maxGrad);
+    gV = _mm256_min_epu16(_mm256_abs_epi16(gV), maxGrad);
+
+    lo = _mm256_unpacklo_epi16(gH, gV);
+    hi = _mm256_unpackhi_epi16(gH, gV);
+    lo = _mm256_cmpgt_epi32(_mm256_madd_epi16(lo, lo), below);
+    hi = _mm256_cmpgt_epi32(_mm256_madd_epi16(hi, hi), below);
+}
+
+static inline bool sobelEdge(const pixel* p, intptr_t stride, int64_t threshold2)
+{
+    int gH = -3 * p[-stride - 1] + 3 * p[-stride + 1] - 10 * p[-1] + 10 * p[1] - 3 * p[stride - 1] + 3 * p[stride + 1];
+    int gV = -3 * p[-stride - 1] - 10 * p[-stride] - 3 * p[-stride + 1] + 3 * p[stride - 1] + 10 * p[stride] + 3 * p[stride + 1];
+    return (int64_t)gH * gH + (int64_t)gV * gV >= threshold2;
+}
+
+uint32_t edge_count(const pixel* src, intptr_t stride, int width, int height, int threshold)
+{
+    const __m256i maxGrad = _mm256_set1_epi16((int16_t)threshold);
+    const __m256i below = _mm256_set1_epi32(threshold * threshold - 1);
+    const int64_t threshold2 = (int64_t)threshold * threshold;
+
+    __m256i acc = _mm256_setzero_si256();
+    uint32_t edges = 0;
+
+    for (int y = 1; y < height - 1; y++)
+    {
+        const pixel* row = src + y * stride;
+        int x = 1;
+        for (; x + 16 <= width - 1; x += 16)
+        {
+            __m256i lo, hi;
+            sobelEdges16(row + x, stride, maxGrad, below, lo, hi);
+            acc = _mm256_sub_epi32(acc, lo);
+            acc = _mm256_sub_epi32(acc, hi);
+        }
+
+        for (; x < width - 1; x++)
+            edges += sobelEdge(row + x, stride, threshold2);
+    }
+
+    __m128i sum4 = _mm_add_epi32(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+    sum4 = _mm_add_epi32(sum4, _mm_shuffle_epi32(sum4, _MM_SHUFFLE(1, 0, 3, 2)));
+    sum4 = _mm_add_epi32(sum4, _mm_shuffle_epi32(sum4, _MM_SHUFFLE(2, 3, 0, 1)));
+
+    return edges + (uint32_t)_mm_cvtsi128_si32(sum4);
+}
+
+void edge_row(pixel* dst, const pixel* src, intptr_t stride, int width, int threshold, pixel white)
+{
+    const __m256i maxGrad = _mm256_set1_epi16((int16_t)threshold);
+    const __m256i below = _mm256_set1_epi32(threshold * threshold - 1);
+    const __m256i whiteVec = _mm256_set1_epi16((int16_t)white);
+    const int64_t threshold2 = (int64_t)threshold * threshold;
+
+    int x = 0;
+    for (; x + 16 <= width; x += 16)
+    {
+        __m256i lo, hi;
+        sobelEdges16(src + x, stride, maxGrad, below, lo, hi);
+        storePixels16(dst + x, _mm256_and_si256(_mm256_packs_epi32(lo, hi), whiteVec));
+    }
+
+    for (; x < width; x++)
+        dst[x] = sobelEdge(src + x, stride, threshold2) ? white : 0;
+}
+
+/* sum / 159 in 32bit lanes, for 0 <= sum <= 159 * 4095. The quotient is the
+ * high half of sum * ceil(2^32 / 159), which is exact over that range (checked
+ * exhaustively). A float divide is not: -ffast-math turns it into a multiply
+ * by the reciprocal, which truncates 255 * 159 to 254 */
+static inline __m256i div159(__m256i sum)
+{
+    const __m256i magic = _mm256_set1_epi32(27012373);
+    __m256i even = _mm256_srli_epi64(_mm256_mul_epu32(sum, magic), 32);
+    __m256i odd = _mm256_mul_epu32(_mm256_srli_epi64(sum, 32), magic);
+    return _mm256_blend_epi32(even, odd, 0xAA);
+}
+
+/* The symmetric rows and columns of the filter are added in 16bit lanes, at
+ * most four 12bit samples. The weighted sum is formed in 32bit lanes by madd
+ * and divided exactly by div159() */
+void gaussian_row(pixel* dst, const pixel* src, intptr_t stride, int width)
+{
+    const __m256i w24 = _mm256_set1_epi32(2 | (4 << 16));
+    const __m256i w54 = _mm256_set1_epi32(5 | (4 << 16));
+    const __m256i w912 = _mm256_set1_epi32(9 | (12 << 16));
+    const __m256i w512 = _mm256_set1_epi32(5 | (12 << 16));
+    const __m256i w15 = _mm256_set1_epi32(15);
+
+    int x = 0;
+    for (; x + 16 <= width; x += 16)
+    {
+        const pixel* p = src + x;
+        __m256i a[5], b[5], c[5];
+        for (int i = 0; i < 5; i++)
+        {
+            a[i] = _mm256_add_epi16(loadPixels16(p - 2 * stride + i - 2), loadPixels16(p + 2 * stride + i - 2));
+            b[i] = _mm256_add_epi16(loadPixels16(p - stride + i - 2), loadPixels16(p + stride + i - 2));
+            c[i] = loadPixels16(p + i - 2);
+        }
+
+        __m256i a1 = _mm256_add_epi16(a[0], a[4]), a2 = _mm256_add_epi16(a[1], a[3]);
+        __m256i b1 = _mm256_add_epi16(b[0], b[4]), b2 = _mm256_add_epi16(b[1], b[3]);
+        __m256i c1 = _mm256_add_epi16(c[0], c[4]), c2 = _mm256_add_epi16(c[1], c[3]);
+        __m256i zero = _mm256_setzero_si256();
+
+        __m256i lo = _mm256_add_epi32(_mm256_add_epi32(_mm256_madd_epi16(_mm256_unpacklo_epi16(a1, a2), w24),
+                                                       _mm256_madd_epi16(_mm256_unpacklo_epi16(a[2], b1), w54)),
+                                      _mm256_add_epi32(_mm256_madd_epi16(_mm256_unpacklo_epi16(b2, b[2]), w912),
+                                                       _mm256_madd_epi16(_mm256_unpacklo_epi16(c1, c2), w512)));
+        lo = _mm256_add_epi32(lo, _mm256_madd_epi16(_mm256_unpacklo_epi16(c[2], zero), w15));
+
+        __m256i hi = _mm256_add_epi32(_mm256_add_epi32(_mm256_madd_epi16(_mm256_unpackhi_epi16(a1, a2), w24),
+                                                       _mm256_madd_epi16(_mm256_unpackhi_epi16(a[2], b1), w54)),
+                                      _mm256_add_epi32(_mm256_madd_epi16(_mm256_unpackhi_epi16(b2, b[2]), w912),
+                                                       _mm256_madd_epi16(_mm256_unpackhi_epi16(c1, c2), w512)));
+        hi = _mm256_add_epi32(hi, _mm256_madd_epi16(_mm256_unpackhi_epi16(c[2], zero), w15));
+
+        storePixels16(dst + x, _mm256_packus_epi32(div159(lo), div159(hi)));
+    }
+
+    const pixel* r0 = src - 2 * stride;
+    const pixel* r1 = src - stride;
+    const pixel* r3 = src + stride;
+    const pixel* r4 = src + 2 * stride;
+    for (; x < width; x++)
+    {
+        int sum = 2 * (r0[x - 2] + r0[x + 2] + r4[x - 2] + r4[x + 2]) + 4 * (r0[x - 1] + r0[x + 1] + r4[x - 1] + r4[x + 1]) + 5 * (r0[x] + r4[x]) +
+                  4 * (r1[x - 2] + r1[x + 2] + r3[x - 2] + r3[x + 2]) + 9 * (r1[x - 1] + r1[x + 1] + r3[x - 1] + r3[x + 1]) + 12 * (r1[x] + r3[x]) +
+                  5 * (src[x - 2] + src[x + 2]) + 12 * (src[x - 1] + src[x + 1]) + 15 * src[x];
+        dst[x] = (pixel)(sum / 159);
+    }
+}
+}
+
+namespace X265_NS {
+void setupIntrinsicPixel_avx2(EncoderPrimitives &p)
+{
+    p.hashCRC = hash_crc;
+    p.hashChecksum = hash_checksum;
+    p.nalEscape = nal_escape;
+    p.edgeCount = edge_count;
+    p.gaussianRow = gaussian_row;
+    p.edgeRow = edge_row;
+
+    p.planecopy_cp = planecopy_cp;
+    p.planecopy_sp = planecopy_sp<false>;
+    p.planecopy_sp_shl = planecopy_sp<true>;
+}
+}
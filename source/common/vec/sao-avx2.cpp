@@ -0,0 +1,96 @@
+/*****************************************************************************
+ * Copyright (C) 2013-2020 MulticoreWare, Inc
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02111, USA.
+ *
+ * This program is also available under a commercial proprietary license.
+ * For more information, contact us at license @ x265.com.
+ *****************************************************************************/
+
+#include "common.h"
+#include "primitives.h"
+#include <immintrin.h> // AVX2
+
+using namespace X265_NS;
+
+namespace {
+
+/* must match SAO::OFFSET_THRESH, SAO::SAO_BIT_INC is 0 */
+enum { OFFSET_THRESH = 1 << X265_MIN(X265_DEPTH - 5, 5) };
+
+/* four classes per step: the offset magnitudes are walked down in lockstep,
+ * each lane only taking part while the magnitude is within its own initial
+ * offset, so every class sees the same candidates in the same order as
+ * saoEstOffsets_c(). Distortion is 32bit like the scalar estSaoDist(), the
+ * costs are compared in 64 bits */
+void saoEstOffsets(const int32_t *count, const int32_t *offsetOrg, int32_t *offset, int32_t *distClasses, int64_t *costClasses, int numClasses, int bBandOffset, int64_t lambda)
+{
+    X265_CHECK(!(numClasses & 3), "numClasses must be a multiple of 4\n");
+
+    /* rate cost of each offset magnitude, the same for every class */
+    int64_t rateCost[OFFSET_THRESH];
+    for (int m = 1; m < OFFSET_THRESH; m++)
+    {
+        uint32_t rate = m + (bBandOffset ? 2 : 1) - (m == OFFSET_THRESH - 1);
+        rateCost[m] = (rate * lambda + 128) >> 8;
+    }
+
+    const __m256i zeroCost = _mm256_set1_epi64x((lambda + 128) >> 8);
+    const __m256i pack64 = _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7);
+
+    for (int i = 0; i < numClasses; i += 4)
+    {
+        __m128i cnt = _mm_loadu_si128((const __m128i*)(count + i));
+        __m128i org2 = _mm_slli_epi32(_mm_loadu_si128((const __m128i*)(offsetOrg + i)), 1);
+        __m128i off = _mm_loadu_si128((const __m128i*)(offset + i));
+        __m128i absOff = _mm_abs_epi32(off);
+
+        __m128i maxAbs = _mm_max_epi32(absOff, _mm_shuffle_epi32(absOff, _MM_SHUFFLE(1, 0, 3, 2)));
+        maxAbs = _mm_max_epi32(maxAbs, _mm_shuffle_epi32(maxAbs, _MM_SHUFFLE(2, 3, 0, 1)));
+
+        __m256i bestCost = zeroCost;
+        __m128i bestOff = _mm_setzero_si128();
+        __m128i bestDist = _mm_setzero_si128();
+
+        for (int m = _mm_cvtsi128_si32(maxAbs); m > 0; m--)
+        {
+            __m128i mag = _mm_set1_epi32(m);
+            __m128i cur = _mm_sign_epi32(mag, off);
+            __m128i dist = _mm_mullo_epi32(_mm_sub_epi32(_mm_mullo_epi32(cnt, cur), org2), cur);
+            __m256i cost = _mm256_add_epi64(_mm256_cvtepi32_epi64(dist), _mm256_set1_epi64x(rateCost[m]));
+
+            /* cost < bestCost, for the lanes whose walk has reached m */
+            __m256i skip = _mm256_cvtepi32_epi64(_mm_cmpgt_epi32(mag, absOff));
+            __m256i better = _mm256_andnot_si256(skip, _mm256_cmpgt_epi64(bestCost, cost));
+
+            bestCost = _mm256_blendv_epi8(bestCost, cost, better);
+            __m128i better32 = _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(better, pack64));
+            bestOff = _mm_blendv_epi8(bestOff, cur, better32);
+            bestDist = _mm_blendv_epi8(bestDist, dist, better32);
+        }
+
+        _mm_storeu_si128((__m128i*)(offset + i), bestOff);
+        _mm_storeu_si128((__m128i*)(distClasses + i), bestDist);
+        _mm256_storeu_si256((__m256i*)(costClasses + i), bestCost);
+    }
+}
+}
+
+namespace X265_NS {
+void setupIntrinsicSao_avx2(EncoderPrimitives &p)
+{
+    p.saoEstOffsets = saoEstOffsets;
+}
+}
@@ -57,6 +57,10 @@ namespace X265_NS {
 void setupIntrinsicDCT_sse3(EncoderPrimitives&);
 void setupIntrinsicDCT_ssse3(EncoderPrimitives&);
 void setupIntrinsicDCT_sse41(EncoderPrimitives&);
+void setupIntrinsicIntra_sse41(EncoderPrimitives&);
+void setupIntrinsicDCT_avx2(EncoderPrimitives&);
+void setupIntrinsicSao_avx2(EncoderPrimitives&);
+void setupIntrinsicPixel_avx2(EncoderPrimitives&);
 
 /* Use primitives for the best available vector architecture */
 void setupInstrinsicPrimitives(EncoderPrimitives &p, int cpuMask)
@@ -77,6 +81,15 @@ void setupInstrinsicPrimitives(EncoderPrimitives &p, int cpuMask)
     if (cpuMask & X265_CPU_SSE4)
     {
         setupIntrinsicDCT_sse41(p);
+        setupIntrinsicIntra_sse41(p);
+    }
+#endif
+#ifdef HAVE_AVX2
+    if (cpuMask & X265_CPU_AVX2)
+    {
+        setupIntrinsicDCT_avx2(p);
+        setupIntrinsicSao_avx2(p);
+        setupIntrinsicPixel_avx2(p);
     }
 #endif
     (void)p;
@@ -39,6 +39,35 @@ int hdr10plus_json_to_movie_cim(const char* path, uint8_t **&cim)
       return meta.movieMetadataFromJson(path, cim);
 }
 
+struct hdr10plus_movie
+{
+    metadataFromJson meta;
+};
+
+hdr10plus_movie* hdr10plus_open_movie(const char* path, int &numberOfFrames)
+{
+    hdr10plus_movie* movie = new hdr10plus_movie;
+    numberOfFrames = movie->meta.openMovieMetadata(path);
+    if (numberOfFrames <= 0)
+    {
+        numberOfFrames = 0;
+        delete movie;
+        return NULL;
+    }
+    return movie;
+}
+
+bool hdr10plus_movie_frame_cim(hdr10plus_movie* movie, uint32_t frameNumber, uint8_t *cim)
+{
+    return movie && movie->meta.movieFrameMetadata(static_cast<int>(frameNumber), cim);
+}
+
+void hdr10plus_close_movie(hdr10plus_movie*& movie)
+{
+    delete movie;
+    movie = NULL;
+}
+
 bool hdr10plus_json_to_frame_eif(const char* path, uint32_t frameNumber, uint8_t *&eif)
 {
     metadataFromJson meta;
@@ -70,6 +99,9 @@ static const hdr10plus_api libapi =
     &hdr10plus_json_to_frame_eif,
     &hdr10plus_json_to_movie_eif,
     &hdr10plus_clear_movie,
+    &hdr10plus_open_movie,
+    &hdr10plus_movie_frame_cim,
+    &hdr10plus_close_movie,
 };
 
 const hdr10plus_api* hdr10plus_api_get()
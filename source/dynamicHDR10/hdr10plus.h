@@ -27,6 +27,13 @@
 #ifndef HDR10PLUS_H
 #define HDR10PLUS_H
 
+/* size of the bytestream of a frame, including its payload size bytes */
+#define HDR10PLUS_MAX_CIM_SIZE 509
+
+/* hdr10plus_movie:
+ *      Opaque handle of a movie metadata file opened by hdr10plus_open_movie.
+ */
+typedef struct hdr10plus_movie hdr10plus_movie;
 
 /* hdr10plus_json_to_frame_cim:
  *      Parses the json file containing the  Creative Intent Metadata DTM for a frame of 
@@ -48,6 +55,31 @@ bool hdr10plus_json_to_frame_cim(const char* path, uint32_t frameNumber, uint8_t
  */
 int hdr10plus_json_to_movie_cim(const char* path, uint8_t **&cim);
 
+/* hdr10plus_open_movie:
+ *      Indexes the json file containing the Creative Intent Metadata DTM for the video
+ *      without parsing the metadata of its frames, so that the bytestream of each frame
+ *      can be generated as the frame is encoded. Only the position of each frame in the
+ *      file is kept in memory.
+ *      path is the file path of the JSON file containing the DTM for the video.
+ *      numberOfFrames will get the number of frames in the movie.
+ *      Returns NULL if the process fails to index the metadata.
+ */
+hdr10plus_movie* hdr10plus_open_movie(const char* path, int &numberOfFrames);
+
+/* hdr10plus_movie_frame_cim:
+ *      Parses the metadata of one frame of a movie opened by hdr10plus_open_movie into
+ *      a bytestream to be encoded into the resulting video stream.
+ *      frameNumber is the number of the frame to get the metadata for.
+ *      cim will get filled with the metadata, it must hold HDR10PLUS_MAX_CIM_SIZE bytes.
+ *      Returns true in case of success.
+ */
+bool hdr10plus_movie_frame_cim(hdr10plus_movie* movie, uint32_t frameNumber, uint8_t *cim);
+
+/* hdr10plus_close_movie:
+ *      Closes a movie opened by hdr10plus_open_movie and sets movie to NULL.
+ */
+void hdr10plus_close_movie(hdr10plus_movie*& movie);
+
 /* hdr10plus_json_to_frame_eif:
 *      Parses the json file containing the Extended InfoFrame metadata for a frame of video
 *      into a bytestream to be encoded into the resulting video stream.
@@ -88,6 +120,9 @@ typedef struct hdr10plus_api
     bool          (*hdr10plus_json_to_frame_eif)(const char *, uint32_t, uint8_t *&);
     int           (*hdr10plus_json_to_movie_eif)(const char *, uint8_t **&);
     void          (*hdr10plus_clear_movie)(uint8_t **&, const int);
+    hdr10plus_movie* (*hdr10plus_open_movie)(const char *, int &);
+    bool          (*hdr10plus_movie_frame_cim)(hdr10plus_movie *, uint32_t, uint8_t *);
+    void          (*hdr10plus_close_movie)(hdr10plus_movie *&);
 } hdr10plus_api;
 
 /* hdr10plus_api:
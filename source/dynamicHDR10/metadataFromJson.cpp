@@ -240,8 +240,164 @@ public:
 
 };
 
+/* Positions of the frame objects of a movie metadata file, found by a single
+ * pass over the text which only follows strings, comments and nesting. Each
+ * frame is parsed when it is requested */
+class metadataFromJson::MovieIndex
+{
+public:
+    MovieIndex() :
+        jsonType(LEGACY)
+    {}
+
+    std::ifstream file;
+    std::vector<int64_t> frameStart;
+    std::vector<int64_t> frameEnd;
+    JsonType jsonType;
+
+    bool build()
+    {
+        const std::string sceneInfo("SceneInfo");
+        char buf[1 << 16];
+        int64_t pos = 0;
+        int depth = 0, arrayDepth = -1;
+        int comment = 0; // 1: line comment, 2: block comment
+        bool inString = false, escape = false, slash = false, star = false;
+        bool inFrame = false, rootFound = false;
+        std::string str, lastString, key;
+
+        while (file.read(buf, sizeof(buf)) || file.gcount())
+        {
+            int len = static_cast<int>(file.gcount());
+            for (int i = 0; i < len; ++i, ++pos)
+            {
+                char c = buf[i];
+                if (inString)
+                {
+                    if (escape)
+                        escape = false;
+                    else if (c == '\\')
+                        escape = true;
+                    else if (c == '"')
+                    {
+                        inString = false;
+                        lastString = str;
+                        continue;
+                    }
+                    if (depth == 1)
+                        str += c;
+                    continue;
+                }
+                if (comment == 1)
+                {
+                    if (c == '\n')
+                        comment = 0;
+                    continue;
+                }
+                if (comment == 2)
+                {
+                    if (star && c == '/')
+                        comment = 0;
+                    star = c == '*';
+                    continue;
+                }
+                if (slash)
+                {
+                    slash = false;
+                    if (c == '/' || c == '*')
+                    {
+                        comment = c == '/' ? 1 : 2;
+                        star = false;
+                        continue;
+                    }
+                }
+                if (c == '/')
+                {
+                    slash = true;
+                    continue;
+                }
+                if (c == ' ' || c == '\t' || c == '\r' || c == '\n')
+                    continue;
+
+                if (!rootFound)
+                {
+                    /* legacy files are an array of frames, LLC files an object
+                     * with the frames in SceneInfo */
+                    rootFound = true;
+                    jsonType = c == '[' ? LEGACY : LLC;
+                    if (c == '[')
+                        arrayDepth = 1;
+                }
+                else if (depth == arrayDepth)
+                {
+                    if (c == ',' || c == ']')
+                    {
+                        if (inFrame)
+                            frameEnd.push_back(pos);
+                        inFrame = false;
+                        if (c == ']' && jsonType == LEGACY)
+                            return !frameStart.empty();
+                        if (c == ']')
+                            arrayDepth = -1;
+                    }
+                    else if (!inFrame)
+                    {
+                        frameStart.push_back(pos);
+                        inFrame = true;
+                    }
+                }
+                else if (jsonType == LLC && depth == 1)
+                {
+                    /* the last SceneInfo of the object is used, as by the parser */
+                    if (c == ':')
+                        key = lastString;
+                    else if (c == ',')
+                        key.clear();
+                    else if (c == '[' && key == sceneInfo)
+                    {
+                        arrayDepth = 2;
+                        frameStart.clear();
+                        frameEnd.clear();
+                    }
+                }
+
+                if (c == '"')
+                {
+                    inString = true;
+                    str.clear();
+                }
+                else if (c == '{' || c == '[')
+                    depth++;
+                else if (c == '}' || c == ']')
+                {
+                    depth--;
+                    if (jsonType == LLC && !depth)
+                        return !frameStart.empty() && frameStart.size() == frameEnd.size();
+                }
+            }
+        }
+        return false;
+    }
+
+    bool readFrame(int frame, Json &frameData)
+    {
+        size_t size = static_cast<size_t>(frameEnd[frame] - frameStart[frame]);
+        std::string frameText(size, ' ');
+        file.clear();
+        file.seekg(frameStart[frame]);
+        if (!file.read(&frameText[0], size))
+        {
+            return false;
+        }
+        std::string err;
+        frameData = Json::parse(frameText, err, JsonParse::COMMENTS);
+        return err.empty();
+    }
+};
+
 metadataFromJson::metadataFromJson() :
-    mPimpl(new DynamicMetaIO())
+    mPimpl(new DynamicMetaIO()),
+    mIndex(NULL)
 {
 
 }
@@ -249,6 +405,7 @@ metadataFromJson::metadataFromJson() :
 metadataFromJson::~metadataFromJson()
 {
     delete mPimpl;
+    delete mIndex;
 }
 
 bool metadataFromJson::frameMetadataFromJson(const char* filePath,
@@ -314,6 +471,57 @@ int metadataFromJson::movieMetadataFromJson(const char* filePath, uint8_t **&met
     return numFrames;
 }
 
+int metadataFromJson::openMovieMetadata(const char* filePath)
+{
+    std::string path(filePath);
+    std::size_t ext = path.find_last_of('.');
+    std::string extension = ext == std::string::npos ? std::string() : path.substr(ext + 1);
+    if(extension.compare("json") && extension.compare("JSON"))
+    {
+        std::cout << "Fail open file, extension not valid!" << std::endl;
+        return -1;
+    }
+
+    delete mIndex;
+    mIndex = new MovieIndex();
+    mIndex->file.open(filePath, std::ios::in | std::ios::binary);
+    if(!mIndex->file.is_open())
+    {
+        std::cout << "Fail open file, file doesn't exist" << std::endl;
+    }
+    else if(mIndex->build())
+    {
+        return static_cast<int>(mIndex->frameStart.size());
+    }
+
+    delete mIndex;
+    mIndex = NULL;
+    return -1;
+}
+
+bool metadataFromJson::movieFrameMetadata(int frame, uint8_t *metadata)
+{
+    if(!mIndex || frame < 0 || frame >= static_cast<int>(mIndex->frameStart.size()))
+    {
+        return false;
+    }
+
+    Json frameData;
+    if(!mIndex->readFrame(frame, frameData))
+    {
+        return false;
+    }
+
+    JsonArray fileData(1, frameData);
+    memset(metadata, 0, 509);
+    mPimpl->mCurrentStreamBit = 8;
+    mPimpl->mCurrentStreamByte = 1;
+
+    fillMetadataArray(fileData, 0, mIndex->jsonType, metadata);
+    mPimpl->setPayloadSize(metadata, 0, mPimpl->mCurrentStreamByte);
+    return true;
+}
+
 bool metadataFromJson::extendedInfoFrameMetadataFromJson(const char* filePath,
     int frame,
     uint8_t *&metadata)
@@ -66,6 +66,24 @@ public:
     int movieMetadataFromJson(const char* filePath,
                                 uint8_t **&metadata);
 
+    /**
+     * @brief openMovieMetadata: Indexes the frames of a Json file with all metadata information
+     *          from movie without parsing them. Only the position of each frame in the file is
+     *          kept, the file stays open for movieFrameMetadata().
+     * @param filePath: path to Json file containing movie metadata information.
+     * @return int: number of frames in the movie, -1 if the file cannot be indexed.
+     */
+    int openMovieMetadata(const char* filePath);
+
+    /**
+     * @brief movieFrameMetadata: Generates the metadata array of one frame of the movie opened
+     *          by openMovieMetadata(), parsing only the Json of that frame.
+     * @param frame: frame Id number in respect to the movie.
+     * @param metadata (output): array of at least 509 bytes receiving the metadata.
+     * @return True if succesful
+     */
+    bool movieFrameMetadata(int frame, uint8_t *metadata);
+
     /**
     * @brief extendedInfoFrameMetadataFromJson: Generates Extended InfoFrame metadata array from Json file
     *           with all metadata information from movie.
@@ -103,6 +121,8 @@ private:
 
     class DynamicMetaIO;
     DynamicMetaIO *mPimpl;
+    class MovieIndex;
+    MovieIndex *mIndex;
     void fillMetadataArray(const JsonArray &fileData, int frame, const JsonType jsonType, uint8_t *&metadata);
 };
 
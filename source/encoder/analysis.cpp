@@ -705,7 +705,7 @@ void Analysis::processPmode(PMODE& pmode, Analysis& slave)
         slave.m_frame = m_frame;
         slave.m_param = m_param;
         slave.m_bChromaSa8d = m_param->rdLevel >= 3;
-        slave.setLambdaFromQP(md.pred[PRED_2Nx2N].cu, m_rdCost.m_qp);
+        slave.setLambdaFromQP(md.pred[PRED_2Nx2N].cu, pmode.qp);
         slave.invalidateContexts(0);
         slave.m_rqt[pmode.cuGeom.depth].cur.load(m_rqt[pmode.cuGeom.depth].cur);
     }
@@ -726,7 +726,7 @@ void Analysis::processPmode(PMODE& pmode, Analysis& slave)
                 break;
 
             case PRED_2Nx2N:
-                refMasks[0] = m_splitRefIdx[0] | m_splitRefIdx[1] | m_splitRefIdx[2] | m_splitRefIdx[3];
+                refMasks[0] = pmode.splitRefs[0] | pmode.splitRefs[1] | pmode.splitRefs[2] | pmode.splitRefs[3];
 
                 slave.checkInter_rd0_4(md.pred[PRED_2Nx2N], pmode.cuGeom, SIZE_2Nx2N, refMasks);
                 if (m_slice->m_sliceType == B_SLICE)
@@ -734,43 +734,43 @@ void Analysis::processPmode(PMODE& pmode, Analysis& slave)
                 break;
 
             case PRED_Nx2N:
-                refMasks[0] = m_splitRefIdx[0] | m_splitRefIdx[2]; /* left */
-                refMasks[1] = m_splitRefIdx[1] | m_splitRefIdx[3]; /* right */
+                refMasks[0] = pmode.splitRefs[0] | pmode.splitRefs[2]; /* left */
+                refMasks[1] = pmode.splitRefs[1] | pmode.splitRefs[3]; /* right */
 
                 slave.checkInter_rd0_4(md.pred[PRED_Nx2N], pmode.cuGeom, SIZE_Nx2N, refMasks);
                 break;
 
             case PRED_2NxN:
-                refMasks[0] = m_splitRefIdx[0] | m_splitRefIdx[1]; /* top */
-                refMasks[1] = m_splitRefIdx[2] | m_splitRefIdx[3]; /* bot */
+                refMasks[0] = pmode.splitRefs[0] | pmode.splitRefs[1]; /* top */
+                refMasks[1] = pmode.splitRefs[2] | pmode.splitRefs[3]; /* bot */
 
                 slave.checkInter_rd0_4(md.pred[PRED_2NxN], pmode.cuGeom, SIZE_2NxN, refMasks);
                 break;
 
             case PRED_2NxnU:
-                refMasks[0] = m_splitRefIdx[0] | m_splitRefIdx[1]; /* 25% top */
-                refMasks[1] = m_splitRefIdx[0] | m_splitRefIdx[1] | m_splitRefIdx[2] | m_splitRefIdx[3]; /* 75% bot */
+                refMasks[0] = pmode.splitRefs[0] | pmode.splitRefs[1]; /* 25% top */
+                refMasks[1] = pmode.splitRefs[0] | pmode.splitRefs[1] | pmode.splitRefs[2] | pmode.splitRefs[3]; /* 75% bot */
 
                 slave.checkInter_rd0_4(md.pred[PRED_2NxnU], pmode.cuGeom, SIZE_2NxnU, refMasks);
                 break;
 
             case PRED_2NxnD:
-                refMasks[0] = m_splitRefIdx[0] | m_splitRefIdx[1] | m_splitRefIdx[2] | m_splitRefIdx[3]; /* 75% top */
-                refMasks[1] = m_splitRefIdx[2] | m_splitRefIdx[3]; /* 25% bot */
+                refMasks[0] = pmode.splitRefs[0] | pmode.splitRefs[1] | pmode.splitRefs[2] | pmode.splitRefs[3]; /* 75% top */
+                refMasks[1] = pmode.splitRefs[2] | pmode.splitRefs[3]; /* 25% bot */
 
                 slave.checkInter_rd0_4(md.pred[PRED_2NxnD], pmode.cuGeom, SIZE_2NxnD, refMasks);
                 break;
 
             case PRED_nLx2N:
-                refMasks[0] = m_splitRefIdx[0] | m_splitRefIdx[2]; /* 25% left */
-                refMasks[1] = m_splitRefIdx[0] | m_splitRefIdx[1] | m_splitRefIdx[2] | m_splitRefIdx[3]; /* 75% right */
+                refMasks[0] = pmode.splitRefs[0] | pmode.splitRefs[2]; /* 25% left */
+                refMasks[1] = pmode.splitRefs[0] | pmode.splitRefs[1] | pmode.splitRefs[2] | pmode.splitRefs[3]; /* 75% right */
 
                 slave.checkInter_rd0_4(md.pred[PRED_nLx2N], pmode.cuGeom, SIZE_nLx2N, refMasks);
                 break;
 
             case PRED_nRx2N:
-                refMasks[0] = m_splitRefIdx[0] | m_splitRefIdx[1] | m_splitRefIdx[2] | m_splitRefIdx[3]; /* 75% left */
-                refMasks[1] = m_splitRefIdx[1] | m_splitRefIdx[3]; /* 25% right */
+                refMasks[0] = pmode.splitRefs[0] | pmode.splitRefs[1] | pmode.splitRefs[2] | pmode.splitRefs[3]; /* 75% left */
+                refMasks[1] = pmode.splitRefs[1] | pmode.splitRefs[3]; /* 25% right */
 
                 slave.checkInter_rd0_4(md.pred[PRED_nRx2N], pmode.cuGeom, SIZE_nRx2N, refMasks);
                 break;
@@ -791,7 +791,7 @@ void Analysis::processPmode(PMODE& pmode, Analysis& slave)
                 break;
 
             case PRED_2Nx2N:
-                refMasks[0] = m_splitRefIdx[0] | m_splitRefIdx[1] | m_splitRefIdx[2] | m_splitRefIdx[3];
+                refMasks[0] = pmode.splitRefs[0] | pmode.splitRefs[1] | pmode.splitRefs[2] | pmode.splitRefs[3];
 
                 slave.checkInter_rd5_6(md.pred[PRED_2Nx2N], pmode.cuGeom, SIZE_2Nx2N, refMasks);
                 md.pred[PRED_BIDIR].rdCost = MAX_INT64;
@@ -804,42 +804,42 @@ void Analysis::processPmode(PMODE& pmode, Analysis& slave)
                 break;
 
             case PRED_Nx2N:
-                refMasks[0] = m_splitRefIdx[0] | m_splitRefIdx[2]; /* left */
-                refMasks[1] = m_splitRefIdx[1] | m_splitRefIdx[3]; /* right */
+                refMasks[0] = pmode.splitRefs[0] | pmode.splitRefs[2]; /* left */
+                refMasks[1] = pmode.splitRefs[1] | pmode.splitRefs[3]; /* right */
 
                 slave.checkInter_rd5_6(md.pred[PRED_Nx2N], pmode.cuGeom, SIZE_Nx2N, refMasks);
                 break;
 
             case PRED_2NxN:
-                refMasks[0] = m_splitRefIdx[0] | m_splitRefIdx[1]; /* top */
-                refMasks[1] = m_splitRefIdx[2] | m_splitRefIdx[3]; /* bot */
+                refMasks[0] = pmode.splitRefs[0] | pmode.splitRefs[1]; /* top */
+                refMasks[1] = pmode.splitRefs[2] | pmode.splitRefs[3]; /* bot */
 
                 slave.checkInter_rd5_6(md.pred[PRED_2NxN], pmode.cuGeom, SIZE_2NxN, refMasks);
                 break;
 
             case PRED_2NxnU:
-                refMasks[0] = m_splitRefIdx[0] | m_splitRefIdx[1]; /* 25% top */
-                refMasks[1] = m_splitRefIdx[0] | m_splitRefIdx[1] | m_splitRefIdx[2] | m_splitRefIdx[3]; /* 75% bot */
+                refMasks[0] = pmode.splitRefs[0] | pmode.splitRefs[1]; /* 25% top */
+                refMasks[1] = pmode.splitRefs[0] | pmode.splitRefs[1] | pmode.splitRefs[2] | pmode.splitRefs[3]; /* 75% bot */
 
                 slave.checkInter_rd5_6(md.pred[PRED_2NxnU], pmode.cuGeom, SIZE_2NxnU, refMasks);
                 break;
 
             case PRED_2NxnD:
-                refMasks[0] = m_splitRefIdx[0] | m_splitRefIdx[1] | m_splitRefIdx[2] | m_splitRefIdx[3]; /* 75% top */
-                refMasks[1] = m_splitRefIdx[2] | m_splitRefIdx[3]; /* 25% bot */
+                refMasks[0] = pmode.splitRefs[0] | pmode.splitRefs[1] | pmode.splitRefs[2] | pmode.splitRefs[3]; /* 75% top */
+                refMasks[1] = pmode.splitRefs[2] | pmode.splitRefs[3]; /* 25% bot */
                 slave.checkInter_rd5_6(md.pred[PRED_2NxnD], pmode.cuGeom, SIZE_2NxnD, refMasks);
                 break;
 
             case PRED_nLx2N:
-                refMasks[0] = m_splitRefIdx[0] | m_splitRefIdx[2]; /* 25% left */
-                refMasks[1] = m_splitRefIdx[0] | m_splitRefIdx[1] | m_splitRefIdx[2] | m_splitRefIdx[3]; /* 75% right */
+                refMasks[0] = pmode.splitRefs[0] | pmode.splitRefs[2]; /* 25% left */
+                refMasks[1] = pmode.splitRefs[0] | pmode.splitRefs[1] | pmode.splitRefs[2] | pmode.splitRefs[3]; /* 75% right */
 
                 slave.checkInter_rd5_6(md.pred[PRED_nLx2N], pmode.cuGeom, SIZE_nLx2N, refMasks);
                 break;
 
             case PRED_nRx2N:
-                refMasks[0] = m_splitRefIdx[0] | m_splitRefIdx[1] | m_splitRefIdx[2] | m_splitRefIdx[3]; /* 75% left */
-                refMasks[1] = m_splitRefIdx[1] | m_splitRefIdx[3]; /* 25% right */
+                refMasks[0] = pmode.splitRefs[0] | pmode.splitRefs[1] | pmode.splitRefs[2] | pmode.splitRefs[3]; /* 75% left */
+                refMasks[1] = pmode.splitRefs[1] | pmode.splitRefs[3]; /* 25% right */
                 slave.checkInter_rd5_6(md.pred[PRED_nRx2N], pmode.cuGeom, SIZE_nRx2N, refMasks);
                 break;
 
@@ -858,6 +858,59 @@ void Analysis::processPmode(PMODE& pmode, Analysis& slave)
     while (task >= 0);
 }
 
+/* initialize the prediction CUs of the given candidate modes and release them
+ * as tasks of the PMODE group. Tasks may be released while bonded peers are
+ * already processing earlier ones, so the job total is published under lock */
+void Analysis::queuePmodeTasks(PMODE& pmode, const CUData& parentCTU, int32_t qp, bool bIntra, bool bInter)
+{
+    const CUGeom& cuGeom = pmode.cuGeom;
+    ModeDepth& md = m_modeDepth[cuGeom.depth];
+    int modes[MAX_PRED_TYPES];
+    int count = 0;
+
+    if (bIntra)
+    {
+        md.pred[PRED_INTRA].cu.initSubCU(parentCTU, cuGeom, qp);
+        if (cuGeom.log2CUSize == 3 && m_slice->m_sps->quadtreeTULog2MinSize < 3 && m_param->rdLevel >= 5)
+            md.pred[PRED_INTRA_NxN].cu.initSubCU(parentCTU, cuGeom, qp);
+        modes[count++] = PRED_INTRA;
+    }
+    if (bInter)
+    {
+        md.pred[PRED_2Nx2N].cu.initSubCU(parentCTU, cuGeom, qp); modes[count++] = PRED_2Nx2N;
+        md.pred[PRED_BIDIR].cu.initSubCU(parentCTU, cuGeom, qp);
+        if (m_param->bEnableRectInter)
+        {
+            md.pred[PRED_2NxN].cu.initSubCU(parentCTU, cuGeom, qp); modes[count++] = PRED_2NxN;
+            md.pred[PRED_Nx2N].cu.initSubCU(parentCTU, cuGeom, qp); modes[count++] = PRED_Nx2N;
+        }
+        if (m_slice->m_sps->maxAMPDepth > cuGeom.depth)
+        {
+            md.pred[PRED_2NxnU].cu.initSubCU(parentCTU, cuGeom, qp); modes[count++] = PRED_2NxnU;
+            md.pred[PRED_2NxnD].cu.initSubCU(parentCTU, cuGeom, qp); modes[count++] = PRED_2NxnD;
+            md.pred[PRED_nLx2N].cu.initSubCU(parentCTU, cuGeom, qp); modes[count++] = PRED_nLx2N;
+            md.pred[PRED_nRx2N].cu.initSubCU(parentCTU, cuGeom, qp); modes[count++] = PRED_nRx2N;
+        }
+        pmode.bInterQueued = true;
+    }
+
+    if (!count)
+        return;
+
+    pmode.m_lock.acquire();
+    for (int i = 0; i < count; i++)
+        pmode.modes[pmode.m_jobTotal + i] = modes[i];
+    pmode.m_jobTotal += count;
+    pmode.m_lock.release();
+
+    /* prefer idle workers of this frame's job provider, then borrow any idle
+     * worker of the pool (lookahead or other frame encoders) */
+    JobProvider& jp = *m_frame->m_encData->m_jobProvider;
+    int bonded = pmode.tryBondPeers(jp, count);
+    if (bonded < count)
+        pmode.tryBondPeers(*jp.m_pool, count - bonded);
+}
+
 uint32_t Analysis::compressInterCU_dist(const CUData& parentCTU, const CUGeom& cuGeom, int32_t qp)
 {
     uint32_t depth = cuGeom.depth;
@@ -895,8 +948,23 @@ uint32_t Analysis::compressInterCU_dist(const CUData& parentCTU, const CUGeom& c
             bNoSplit = recursionDepthCheck(parentCTU, cuGeom, *md.bestMode);
     }
 
+    bool bResetLambda = m_slice->m_pps->bUseDQP && depth <= m_slice->m_pps->maxCuDQPDepth && m_slice->m_pps->maxCuDQPDepth != 0;
+    if (mightNotSplit && depth >= minDepth)
+        pmode.qp = bResetLambda ? qp : m_rdCost.m_qp;
+
     if (mightSplit && !bNoSplit)
     {
+        /* Inter mode tasks do not depend on the split analysis unless the
+         * depth reference masks are in use, so they are released before
+         * recursing and bonded peers measure them while this thread analyzes
+         * the sub-CUs. Intra tasks must wait, intra TU coding uses the CU's
+         * area of the recon picture as scratch, as do the sub-CUs */
+        if (mightNotSplit && depth >= minDepth && !(m_param->limitReferences & X265_REF_LIMIT_DEPTH))
+        {
+            ProfileCounter(parentCTU, countPModeEarlyMasters);
+            queuePmodeTasks(pmode, parentCTU, qp, false, true);
+        }
+
         Mode* splitPred = &md.pred[PRED_SPLIT];
         splitPred->initCosts();
         CUData* splitCU = &splitPred->cu;
@@ -948,34 +1016,14 @@ uint32_t Analysis::compressInterCU_dist(const CUData& parentCTU, const CUGeom& c
         int bTryAmp = m_slice->m_sps->maxAMPDepth > depth;
         int bTryIntra = (m_slice->m_sliceType != B_SLICE || m_param->bIntraInBFrames) && (!m_param->limitReferences || splitIntra) && (cuGeom.log2CUSize != MAX_LOG2_CU_SIZE);
 
-        if (m_slice->m_pps->bUseDQP && depth <= m_slice->m_pps->maxCuDQPDepth && m_slice->m_pps->maxCuDQPDepth != 0)
+        if (bResetLambda)
             setLambdaFromQP(parentCTU, qp);
+        X265_CHECK(pmode.qp == m_rdCost.m_qp, "pmode lambda QP mismatch\n");
 
-        if (bTryIntra)
-        {
-            md.pred[PRED_INTRA].cu.initSubCU(parentCTU, cuGeom, qp);
-            if (cuGeom.log2CUSize == 3 && m_slice->m_sps->quadtreeTULog2MinSize < 3 && m_param->rdLevel >= 5)
-                md.pred[PRED_INTRA_NxN].cu.initSubCU(parentCTU, cuGeom, qp);
-            pmode.modes[pmode.m_jobTotal++] = PRED_INTRA;
-        }
-        md.pred[PRED_2Nx2N].cu.initSubCU(parentCTU, cuGeom, qp); pmode.modes[pmode.m_jobTotal++] = PRED_2Nx2N;
-        md.pred[PRED_BIDIR].cu.initSubCU(parentCTU, cuGeom, qp);
-        if (m_param->bEnableRectInter)
-        {
-            md.pred[PRED_2NxN].cu.initSubCU(parentCTU, cuGeom, qp); pmode.modes[pmode.m_jobTotal++] = PRED_2NxN;
-            md.pred[PRED_Nx2N].cu.initSubCU(parentCTU, cuGeom, qp); pmode.modes[pmode.m_jobTotal++] = PRED_Nx2N;
-        }
-        if (bTryAmp)
-        {
-            md.pred[PRED_2NxnU].cu.initSubCU(parentCTU, cuGeom, qp); pmode.modes[pmode.m_jobTotal++] = PRED_2NxnU;
-            md.pred[PRED_2NxnD].cu.initSubCU(parentCTU, cuGeom, qp); pmode.modes[pmode.m_jobTotal++] = PRED_2NxnD;
-            md.pred[PRED_nLx2N].cu.initSubCU(parentCTU, cuGeom, qp); pmode.modes[pmode.m_jobTotal++] = PRED_nLx2N;
-            md.pred[PRED_nRx2N].cu.initSubCU(parentCTU, cuGeom, qp); pmode.modes[pmode.m_jobTotal++] = PRED_nRx2N;
-        }
-
-        m_splitRefIdx[0] = splitRefs[0]; m_splitRefIdx[1] = splitRefs[1]; m_splitRefIdx[2] = splitRefs[2]; m_splitRefIdx[3] = splitRefs[3];
-
-        pmode.tryBondPeers(*m_frame->m_encData->m_jobProvider, pmode.m_jobTotal);
+        /* the split dependencies are resolved, release the remaining mode tasks */
+        if (!pmode.bInterQueued)
+            memcpy(pmode.splitRefs, splitRefs, sizeof(splitRefs));
+        queuePmodeTasks(pmode, parentCTU, qp, !!bTryIntra, !pmode.bInterQueued);
 
         /* participate in processing jobs, until all are distributed */
         processPmode(pmode, *this);
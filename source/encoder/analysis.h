@@ -93,8 +93,16 @@ public:
         Analysis&     master;
         const CUGeom& cuGeom;
         int           modes[MAX_PRED_TYPES];
+        uint32_t      splitRefs[4]; // reference masks of the split sub-CUs, for inter tasks
+        int           qp;           // lambda QP of the mode tasks
+        bool          bInterQueued; // inter tasks were already released
 
-        PMODE(Analysis& m, const CUGeom& g) : master(m), cuGeom(g) {}
+        PMODE(Analysis& m, const CUGeom& g) : master(m), cuGeom(g)
+        {
+            splitRefs[0] = splitRefs[1] = splitRefs[2] = splitRefs[3] = 0;
+            qp = 0;
+            bInterQueued = false;
+        }
 
         void processTasks(int workerThreadId);
 
@@ -104,6 +112,7 @@ public:
     };
 
     void processPmode(PMODE& pmode, Analysis& slave);
+    void queuePmodeTasks(PMODE& pmode, const CUData& parentCTU, int32_t qp, bool bIntra, bool bInter);
 
     ModeDepth m_modeDepth[NUM_CU_DEPTH];
     bool      m_bTryLossless;
@@ -131,7 +140,6 @@ protected:
     x265_analysis_MV*          m_reuseMv[2];
     uint8_t*             m_reuseMvpIdx[2];
 
-    uint32_t             m_splitRefIdx[4];
     uint64_t*            cacheCost;
 
     uint8_t                 m_evaluateInter;
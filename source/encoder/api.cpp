@@ -732,6 +732,28 @@ int x265_encoder_ctu_info(x265_encoder *enc, int poc, x265_ctu_info_t** ctu)
     return 0;
 }
 
+int x265_encoder_alloc_input(x265_encoder *enc, x265_picture *pic)
+{
+    if (!enc || !pic)
+        return -1;
+
+    Encoder *encoder = static_cast<Encoder*>(enc);
+#ifdef SVT_HEVC
+    if (encoder->m_param->bEnableSvtHevc)
+        return -1;
+#endif
+    return encoder->allocInputPicture(pic);
+}
+
+void x265_encoder_free_input(x265_encoder *enc, x265_picture *pic)
+{
+    if (!enc || !pic || !pic->inputFrame)
+        return;
+
+    Encoder *encoder = static_cast<Encoder*>(enc);
+    encoder->freeInputPicture(pic);
+}
+
 int x265_get_slicetype_poc_and_scenecut(x265_encoder *enc, int *slicetype, int *poc, int *sceneCut)
 {
     if (!enc)
@@ -1073,7 +1095,9 @@ static const x265_api libapi =
     &x265_calculate_vmaf_framelevelscore,
     &x265_vmaf_encoder_log,
 #endif
-    &PARAM_NS::x265_zone_param_parse
+    &PARAM_NS::x265_zone_param_parse,
+    &x265_encoder_alloc_input,
+    &x265_encoder_free_input,
 };
 
 typedef const x265_api* (*api_get_func)(int bitDepth);
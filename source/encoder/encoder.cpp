@@ -110,6 +110,7 @@ Encoder::Encoder()
     m_analysisFileIn = NULL;
     m_analysisFileOut = NULL;
     m_naluFile = NULL;
+    m_ctuCostFile = NULL;
     m_offsetEmergency = NULL;
     m_iFrameNum = 0;
     m_iPPSQpMinus26 = 0;
@@ -125,7 +126,7 @@ Encoder::Encoder()
 #if ENABLE_HDR10_PLUS
     m_hdr10plus_api = hdr10plus_api_get();
     m_numCimInfo = 0;
-    m_cim = NULL;
+    m_toneMapMovie = NULL;
 #endif
 
 #if SVT_HEVC
@@ -135,11 +136,9 @@ Encoder::Encoder()
     m_startPoint = 0;
     m_saveCTUSize = 0;
     m_edgePic = NULL;
-    m_edgeHistThreshold = 0;
-    m_chromaHistThreshold = 0.0;
-    m_scaledEdgeThreshold = 0.0;
-    m_scaledChromaThreshold = 0.0;
+    m_inputPic[0] = m_inputPic[1] = m_inputPic[2] = NULL;
     m_zoneIndex = 0;
+    m_traceSession = 0;
 }
 
 inline char *strcatFilename(const char *input, const char *suffix)
@@ -166,17 +165,36 @@ void Encoder::create()
 
     x265_param* p = m_param;
 
+    /* before any thread is started: the threads started below inherit the
+     * session of this one, so only the threads of this encoder are traced */
+#if ENABLE_TRACE
+    if (p->traceFile)
+    {
+        m_traceSession = traceOpen(p->traceFile);
+        if (!m_traceSession)
+            x265_log(p, X265_LOG_WARNING, "unable to write trace file <%s> or another encoder is tracing, trace disabled\n", p->traceFile);
+    }
+    TraceSessionScope traceScope(m_traceSession);
+#else
+    if (p->traceFile)
+        x265_log(p, X265_LOG_WARNING, "--trace requires a build configured with ENABLE_TRACE, ignored\n");
+#endif
+
     int rows = (p->sourceHeight + p->maxCUSize - 1) >> g_log2Size[p->maxCUSize];
     int cols = (p->sourceWidth  + p->maxCUSize - 1) >> g_log2Size[p->maxCUSize];
 
     if (m_param->bEnableFrameDuplication)
     {
+        /* the buffered pictures are kept at the internal bit depth, with
+         * strides equal to the plane widths */
         size_t framesize = 0;
-        int pixelbytes = p->sourceBitDepth > 8 ? 2 : 1;
+        uint32_t blocks = 0;
         for (int i = 0; i < x265_cli_csps[p->internalCsp].planes; i++)
         {
-            int stride = (p->sourceWidth >> x265_cli_csps[p->internalCsp].width[i]) * pixelbytes;
-            framesize += (stride * (p->sourceHeight >> x265_cli_csps[p->internalCsp].height[i]));
+            int width = p->sourceWidth >> x265_cli_csps[p->internalCsp].width[i];
+            int height = p->sourceHeight >> x265_cli_csps[p->internalCsp].height[i];
+            framesize += width * height * sizeof(pixel);
+            blocks += (width >> 3) * (height >> 3);
         }
 
         //Sets the picture structure and emits it in the picture timing SEI message
@@ -190,58 +208,11 @@ void Encoder::create()
             x265_picture_init(p, m_dupBuffer[i]->dupPic);
             m_dupBuffer[i]->dupPlane = NULL;
             m_dupBuffer[i]->dupPlane = X265_MALLOC(char, framesize);
+            m_dupBuffer[i]->blockSum = X265_MALLOC(uint32_t, X265_MAX(blocks, 1));
             m_dupBuffer[i]->dupPic->planes[0] = m_dupBuffer[i]->dupPlane;
             m_dupBuffer[i]->bOccupied = false;
             m_dupBuffer[i]->bDup = false;
         }
-
-        if (!(p->sourceBitDepth == 8 && p->internalBitDepth == 8))
-        {
-            int size = p->sourceWidth * p->sourceHeight;
-            int hshift = CHROMA_H_SHIFT(p->internalCsp);
-            int vshift = CHROMA_V_SHIFT(p->internalCsp);
-            int widthC = p->sourceWidth >> hshift;
-            int heightC = p->sourceHeight >> vshift;
-
-            m_dupPicOne[0] = X265_MALLOC(pixel, size);
-            m_dupPicTwo[0] = X265_MALLOC(pixel, size);
-            if (p->internalCsp != X265_CSP_I400)
-            {
-                for (int k = 1; k < 3; k++)
-                {
-                    m_dupPicOne[k] = X265_MALLOC(pixel, widthC * heightC);
-                    m_dupPicTwo[k] = X265_MALLOC(pixel, widthC * heightC);
-                }
-            }
-        }
-    }
-
-    if (m_param->bHistBasedSceneCut)
-    {
-        m_planeSizes[0] = (m_param->sourceWidth >> x265_cli_csps[p->internalCsp].width[0]) * (m_param->sourceHeight >> x265_cli_csps[m_param->internalCsp].height[0]);
-        uint32_t pixelbytes = m_param->internalBitDepth > 8 ? 2 : 1;
-        m_edgePic = X265_MALLOC(pixel, m_planeSizes[0] * pixelbytes);
-        m_edgeHistThreshold = m_param->edgeTransitionThreshold;
-        m_chromaHistThreshold = x265_min(m_edgeHistThreshold * 10.0, MAX_SCENECUT_THRESHOLD);
-        m_scaledEdgeThreshold = x265_min(m_edgeHistThreshold * SCENECUT_STRENGTH_FACTOR, MAX_SCENECUT_THRESHOLD);
-        m_scaledChromaThreshold = x265_min(m_chromaHistThreshold * SCENECUT_STRENGTH_FACTOR, MAX_SCENECUT_THRESHOLD);
-        if (m_param->sourceBitDepth != m_param->internalBitDepth)
-        {
-            int size = m_param->sourceWidth * m_param->sourceHeight;
-            int hshift = CHROMA_H_SHIFT(m_param->internalCsp);
-            int vshift = CHROMA_V_SHIFT(m_param->internalCsp);
-            int widthC = m_param->sourceWidth >> hshift;
-            int heightC = m_param->sourceHeight >> vshift;
-
-            m_inputPic[0] = X265_MALLOC(pixel, size);
-            if (m_param->internalCsp != X265_CSP_I400)
-            {
-                for (int j = 1; j < 3; j++)
-                {
-                    m_inputPic[j] = X265_MALLOC(pixel, widthC * heightC);
-                }
-            }
-        }
     }
 
     // Do not allow WPP if only one row or fewer than 3 columns, it is pointless and unstable
@@ -356,6 +327,40 @@ void Encoder::create()
         for (int i = 0; i < pools; i++)
             lookAheadThreadPool[i].start();
     m_lookahead->m_numPools = pools;
+    if (m_param->bHistBasedSceneCut)
+    {
+        m_lookahead->m_histWidth = m_param->sourceWidth - m_conformanceWindow.rightOffset;
+        m_lookahead->m_histHeight = m_param->sourceHeight - m_conformanceWindow.bottomOffset;
+
+        /* frame duplication drops pictures by their histograms before they are
+         * queued, analysis load replaces the scene cut decisions and edge based
+         * recursion skip reuses the edge picture; these keep the histograms on
+         * the API thread */
+        m_lookahead->m_bHistPreAnalysis = !m_param->bEnableFrameDuplication && !m_param->analysisLoad &&
+                                          m_param->recursionSkipMode != EDGE_BASED_RSKIP;
+        if (!m_lookahead->m_bHistPreAnalysis)
+        {
+            if (m_param->recursionSkipMode == EDGE_BASED_RSKIP)
+                m_edgePic = X265_MALLOC(pixel, m_param->sourceWidth * m_param->sourceHeight);
+            if (m_param->sourceBitDepth != m_param->internalBitDepth)
+            {
+                int size = m_param->sourceWidth * m_param->sourceHeight;
+                int hshift = CHROMA_H_SHIFT(m_param->internalCsp);
+                int vshift = CHROMA_V_SHIFT(m_param->internalCsp);
+                int widthC = m_param->sourceWidth >> hshift;
+                int heightC = m_param->sourceHeight >> vshift;
+
+                m_inputPic[0] = X265_MALLOC(pixel, size);
+                if (m_param->internalCsp != X265_CSP_I400)
+                {
+                    for (int j = 1; j < 3; j++)
+                    {
+                        m_inputPic[j] = X265_MALLOC(pixel, widthC * heightC);
+                    }
+                }
+            }
+        }
+    }
     m_dpb = new DPB(m_param);
     m_rateControl = new RateControl(*m_param, this);
     if (!m_param->bResetZoneConfig)
@@ -487,6 +492,27 @@ void Encoder::create()
         }
     }
 
+    if (m_param->bCTUCostMap)
+    {
+        char* name = strcatFilename(m_param->csvfn, ".ctucost");
+        if (name)
+            m_ctuCostFile = x265_fopen(name, "wb");
+        if (m_ctuCostFile)
+        {
+            /* magic, version, then the CTU grid of every frame */
+            uint32_t header[6] = { 1, m_param->maxCUSize, (uint32_t)m_param->sourceWidth, (uint32_t)m_param->sourceHeight,
+                                   (uint32_t)cols, (uint32_t)rows };
+            fwrite("x265ctu", 1, 8, m_ctuCostFile);
+            fwrite(header, sizeof(uint32_t), 6, m_ctuCostFile);
+        }
+        else
+        {
+            x265_log_file(m_param, X265_LOG_WARNING, "unable to open CTU cost map %s, disabled\n", name ? name : m_param->csvfn);
+            m_param->bCTUCostMap = 0;
+        }
+        X265_FREE(name);
+    }
+
     if (m_param->analysisMultiPassRefine || m_param->analysisMultiPassDistortion)
     {
         const char* name = m_param->analysisReuseFileName;
@@ -541,7 +567,11 @@ void Encoder::create()
 
 #if ENABLE_HDR10_PLUS
     if (m_bToneMap)
-        m_numCimInfo = m_hdr10plus_api->hdr10plus_json_to_movie_cim(m_param->toneMapFile, m_cim);
+    {
+        m_toneMapMovie = m_hdr10plus_api->hdr10plus_open_movie(m_param->toneMapFile, m_numCimInfo);
+        if (!m_toneMapMovie)
+            x265_log(m_param, X265_LOG_WARNING, "unable to read dhdr10-info file %s\n", m_param->toneMapFile);
+    }
 #endif
     if (m_param->bDynamicRefine)
     {
@@ -837,7 +867,7 @@ void Encoder::destroy()
 {
 #if ENABLE_HDR10_PLUS
     if (m_bToneMap)
-        m_hdr10plus_api->hdr10plus_clear_movie(m_cim, m_numCimInfo);
+        m_hdr10plus_api->hdr10plus_close_movie(m_toneMapMovie);
 #endif
 
     if (m_param->bDynamicRefine)
@@ -857,45 +887,18 @@ void Encoder::destroy()
         for (uint32_t i = 0; i < DUP_BUFFER; i++)
         {
             X265_FREE(m_dupBuffer[i]->dupPlane);
+            X265_FREE(m_dupBuffer[i]->blockSum);
             x265_picture_free(m_dupBuffer[i]->dupPic);
             X265_FREE(m_dupBuffer[i]);
         }
-
-        if (!(m_param->sourceBitDepth == 8 && m_param->internalBitDepth == 8))
-        {
-            for (int k = 0; k < 3; k++)
-            {
-                if (k == 0)
-                {
-                    X265_FREE(m_dupPicOne[k]);
-                    X265_FREE(m_dupPicTwo[k]);
-                }
-                else if(k >= 1 && m_param->internalCsp != X265_CSP_I400)
-                {
-                    X265_FREE(m_dupPicOne[k]);
-                    X265_FREE(m_dupPicTwo[k]);
-                }
-            }
-        }
     }
 
     if (m_param->bHistBasedSceneCut)
     {
-        if (m_edgePic != NULL)
-        {
-            X265_FREE_ZERO(m_edgePic);
-        }
-
-        if (m_param->sourceBitDepth != m_param->internalBitDepth)
+        X265_FREE_ZERO(m_edgePic);
+        for (int i = 0; i < 3; i++)
         {
-            X265_FREE_ZERO(m_inputPic[0]);
-            if (m_param->internalCsp != X265_CSP_I400)
-            {
-                for (int i = 1; i < 3; i++)
-                {
-                    X265_FREE_ZERO(m_inputPic[i]);
-                }
-            }
+            X265_FREE_ZERO(m_inputPic[i]);
         }
     }
 
@@ -918,6 +921,15 @@ void Encoder::destroy()
         delete m_lookahead;
     }
 
+#if ENABLE_TRACE
+    /* every thread of this encoder has been stopped */
+    if (m_traceSession)
+        traceClose();
+#endif
+
+    /* frames still lent to the application are freed with the DPB */
+    while (m_dpb && !m_inputFrames.empty())
+        m_dpb->m_freeList.pushBack(*m_inputFrames.popBack());
     delete m_dpb;
     if (!m_param->bResetZoneConfig && m_param->rc.zonefileCount)
     {
@@ -964,6 +976,9 @@ void Encoder::destroy()
     if (m_naluFile)
         fclose(m_naluFile);
 
+    if (m_ctuCostFile)
+        fclose(m_ctuCostFile);
+
 #ifdef SVT_HEVC
     X265_FREE(m_svtAppData);
 #endif
@@ -977,6 +992,7 @@ void Encoder::destroy()
         free((char*)m_param->analysisReuseFileName);
         free((char*)m_param->scalingLists);
         free((char*)m_param->csvfn);
+        free((char*)m_param->traceFile);
         free((char*)m_param->numaPools);
         free((char*)m_param->masteringDisplayColorVolume);
         free((char*)m_param->toneMapFile);
@@ -1055,16 +1071,22 @@ void Encoder::copyUserSEIMessages(Frame *frame, const x265_picture* pic_in)
         int currentPOC = m_pocLast;
         if (currentPOC < m_numCimInfo)
         {
-            int32_t i = 0;
-            toneMap.payloadSize = 0;
-            while (m_cim[currentPOC][i] == 0xFF)
-                toneMap.payloadSize += m_cim[currentPOC][i++];
-            toneMap.payloadSize += m_cim[currentPOC][i];
-
-            toneMap.payload = (uint8_t*)x265_malloc(sizeof(uint8_t) * toneMap.payloadSize);
-            toneMap.payloadType = USER_DATA_REGISTERED_ITU_T_T35;
-            memcpy(toneMap.payload, &m_cim[currentPOC][i + 1], toneMap.payloadSize);
-            toneMapPayload = 1;
+            /* only the metadata of the frame being encoded is parsed */
+            if (m_hdr10plus_api->hdr10plus_movie_frame_cim(m_toneMapMovie, currentPOC, m_cim))
+            {
+                int32_t i = 0;
+                toneMap.payloadSize = 0;
+                while (m_cim[i] == 0xFF)
+                    toneMap.payloadSize += m_cim[i++];
+                toneMap.payloadSize += m_cim[i];
+
+                toneMap.payload = (uint8_t*)x265_malloc(sizeof(uint8_t) * toneMap.payloadSize);
+                toneMap.payloadType = USER_DATA_REGISTERED_ITU_T_T35;
+                memcpy(toneMap.payload, &m_cim[i + 1], toneMap.payloadSize);
+                toneMapPayload = 1;
+            }
+            else
+                x265_log(m_param, X265_LOG_WARNING, "unable to parse dhdr10-info of frame %d\n", currentPOC);
         }
     }
 #endif
@@ -1212,9 +1234,6 @@ double Encoder::ComputePSNR(x265_picture *firstPic, x265_picture *secPic, x265_p
     int height = firstPic->height;
     int hshift = CHROMA_H_SHIFT(firstPic->colorSpace);
     int vshift = CHROMA_V_SHIFT(firstPic->colorSpace);
-    pixel *yFirstPic = NULL, *ySecPic = NULL;
-    pixel *uFirstPic = NULL, *uSecPic = NULL;
-    pixel *vFirstPic = NULL, *vSecPic = NULL;
 
     strideL = widthL = width;
     heightL = height;
@@ -1228,139 +1247,117 @@ double Encoder::ComputePSNR(x265_picture *firstPic, x265_picture *secPic, x265_p
     double refValueY = (double)maxvalY * maxvalY * size;
     double refValueC = (double)maxvalC * maxvalC * size / 4.0;
 
-    if (firstPic->bitDepth == 8 && X265_DEPTH == 8)
+    /* both pictures were converted to the internal bit depth by copyPicture() */
+    ssdY = computeSSD((pixel*)firstPic->planes[0], (pixel*)secPic->planes[0], strideL, widthL, heightL, param);
+    psnrY = (ssdY ? 10.0 * log10(refValueY / (double)ssdY) : 99.99);
+
+    if (param->internalCsp != X265_CSP_I400)
     {
-        yFirstPic = (pixel*)firstPic->planes[0];
-        ySecPic = (pixel*)secPic->planes[0];
-        if (param->internalCsp != X265_CSP_I400)
-        {
-            uFirstPic = (pixel*)firstPic->planes[1];
-            uSecPic = (pixel*)secPic->planes[1];
-            vFirstPic = (pixel*)firstPic->planes[2];
-            vSecPic = (pixel*)secPic->planes[2];
-        }
+        ssdU = computeSSD((pixel*)firstPic->planes[1], (pixel*)secPic->planes[1], strideC, widthC, heightC, param);
+        ssdV = computeSSD((pixel*)firstPic->planes[2], (pixel*)secPic->planes[2], strideC, widthC, heightC, param);
+        psnrU = (ssdU ? 10.0 * log10(refValueC / (double)ssdU) : 99.99);
+        psnrV = (ssdV ? 10.0 * log10(refValueC / (double)ssdV) : 99.99);
     }
-    else if (firstPic->bitDepth == 8 && X265_DEPTH > 8)
-    {
-        int shift = (X265_DEPTH - 8);
-        uint8_t *yChar1, *yChar2, *uChar1, *uChar2, *vChar1, *vChar2;
-
-        yChar1 = (uint8_t*)firstPic->planes[0];
-        yChar2 = (uint8_t*)secPic->planes[0];
-
-        primitives.planecopy_cp(yChar1, firstPic->stride[0] / sizeof(*yChar1), m_dupPicOne[0], firstPic->stride[0] / sizeof(*yChar1), width, height, shift);
-        primitives.planecopy_cp(yChar2, secPic->stride[0] / sizeof(*yChar2), m_dupPicTwo[0], secPic->stride[0] / sizeof(*yChar2), width, height, shift);
 
-        if (param->internalCsp != X265_CSP_I400)
-        {
-            uChar1 = (uint8_t*)firstPic->planes[1];
-            uChar2 = (uint8_t*)secPic->planes[1];
-            vChar1 = (uint8_t*)firstPic->planes[2];
-            vChar2 = (uint8_t*)secPic->planes[2];
+    //Compute PSNR(picN,pic(N+1))
+    return psnrWeight = (psnrY * 6 + psnrU + psnrV) / 8;
+}
 
-            primitives.planecopy_cp(uChar1, firstPic->stride[1] / sizeof(*uChar1), m_dupPicOne[1], firstPic->stride[1] / sizeof(*uChar1), widthC, heightC, shift);
-            primitives.planecopy_cp(uChar2, secPic->stride[1] / sizeof(*uChar2), m_dupPicTwo[1], secPic->stride[1] / sizeof(*uChar2), widthC, heightC, shift);
+/* Decides whether ComputePSNR() of the two pictures reaches --dup-threshold.
+ * Over any block, (sumA - sumB)^2 <= N * SSD, so the block sums of the two
+ * pictures bound each plane's SSD from below and thereby the PSNR weight from
+ * above. Pictures which differ visibly are rejected from the thumbnails and
+ * only near duplicates are compared in full */
+bool Encoder::isDuplicatePicture(AdaptiveFrameDuplication* first, AdaptiveFrameDuplication* second)
+{
+    const int csp = m_param->internalCsp;
+    const int size = m_param->sourceWidth * m_param->sourceHeight;
+    const int maxval = 255 << (X265_DEPTH - 8);
+    const uint32_t* sumA = first->blockSum;
+    const uint32_t* sumB = second->blockSum;
+    double psnr[3] = { 0, 0, 0 };
 
-            primitives.planecopy_cp(vChar1, firstPic->stride[2] / sizeof(*vChar1), m_dupPicOne[2], firstPic->stride[2] / sizeof(*vChar1), widthC, heightC, shift);
-            primitives.planecopy_cp(vChar2, secPic->stride[2] / sizeof(*vChar2), m_dupPicTwo[2], secPic->stride[2] / sizeof(*vChar2), widthC, heightC, shift);
-        }
-    }
-    else
+    for (int i = 0; i < x265_cli_csps[csp].planes; i++)
     {
-        uint16_t *yShort1, *yShort2, *uShort1, *uShort2, *vShort1, *vShort2;
-        /* defensive programming, mask off bits that are supposed to be zero */
-        uint16_t mask = (1 << X265_DEPTH) - 1;
-        int shift = abs(firstPic->bitDepth - X265_DEPTH);
-
-        yShort1 = (uint16_t*)firstPic->planes[0];
-        yShort2 = (uint16_t*)secPic->planes[0];
-
-        if (firstPic->bitDepth > X265_DEPTH)
+        int blocks = ((m_param->sourceWidth >> x265_cli_csps[csp].width[i]) >> 3) *
+                     ((m_param->sourceHeight >> x265_cli_csps[csp].height[i]) >> 3);
+        uint64_t ssdBound = 0;
+        for (int b = 0; b < blocks; b++)
         {
-            /* shift right and mask pixels to final size */
-            primitives.planecopy_sp(yShort1, firstPic->stride[0] / sizeof(*yShort1), m_dupPicOne[0], firstPic->stride[0] / sizeof(*yShort1), width, height, shift, mask);
-            primitives.planecopy_sp(yShort2, secPic->stride[0] / sizeof(*yShort2), m_dupPicTwo[0], secPic->stride[0] / sizeof(*yShort2), width, height, shift, mask);
-        }
-        else /* Case for (pic.bitDepth <= X265_DEPTH) */
-        {
-            /* shift left and mask pixels to final size */
-            primitives.planecopy_sp_shl(yShort1, firstPic->stride[0] / sizeof(*yShort1), m_dupPicOne[0], firstPic->stride[0] / sizeof(*yShort1), width, height, shift, mask);
-            primitives.planecopy_sp_shl(yShort2, secPic->stride[0] / sizeof(*yShort2), m_dupPicTwo[0], secPic->stride[0] / sizeof(*yShort2), width, height, shift, mask);
+            int64_t diff = (int64_t)sumA[b] - sumB[b];
+            ssdBound += (uint64_t)(diff * diff);
         }
+        ssdBound >>= 6;
+        sumA += blocks;
+        sumB += blocks;
 
-        if (param->internalCsp != X265_CSP_I400)
-        {
-            uShort1 = (uint16_t*)firstPic->planes[1];
-            uShort2 = (uint16_t*)secPic->planes[1];
-            vShort1 = (uint16_t*)firstPic->planes[2];
-            vShort2 = (uint16_t*)secPic->planes[2];
+        double refValue = (double)maxval * maxval * size / (i ? 4.0 : 1.0);
+        psnr[i] = ssdBound ? 10.0 * log10(refValue / (double)ssdBound) : X265_MAX(99.99, 10.0 * log10(refValue));
+    }
 
-            if (firstPic->bitDepth > X265_DEPTH)
-            {
-                primitives.planecopy_sp(uShort1, firstPic->stride[1] / sizeof(*uShort1), m_dupPicOne[1], firstPic->stride[1] / sizeof(*uShort1), widthC, heightC, shift, mask);
-                primitives.planecopy_sp(uShort2, secPic->stride[1] / sizeof(*uShort2), m_dupPicTwo[1], secPic->stride[1] / sizeof(*uShort2), widthC, heightC, shift, mask);
+    /* the margin absorbs rounding differences against ComputePSNR() */
+    if ((psnr[0] * 6 + psnr[1] + psnr[2]) / 8 + 1e-6 < m_param->dupThreshold)
+        return false;
 
-                primitives.planecopy_sp(vShort1, firstPic->stride[2] / sizeof(*vShort1), m_dupPicOne[2], firstPic->stride[2] / sizeof(*vShort1), widthC, heightC, shift, mask);
-                primitives.planecopy_sp(vShort2, secPic->stride[2] / sizeof(*vShort2), m_dupPicTwo[2], secPic->stride[2] / sizeof(*vShort2), widthC, heightC, shift, mask);
-            }
-            else /* Case for (pic.bitDepth <= X265_DEPTH) */
-            {
-                primitives.planecopy_sp_shl(uShort1, firstPic->stride[1] / sizeof(*uShort1), m_dupPicOne[1], firstPic->stride[1] / sizeof(*uShort1), widthC, heightC, shift, mask);
-                primitives.planecopy_sp_shl(uShort2, secPic->stride[1] / sizeof(*uShort2), m_dupPicTwo[1], secPic->stride[1] / sizeof(*uShort2), widthC, heightC, shift, mask);
+    return ComputePSNR(first->dupPic, second->dupPic, m_param) >= m_param->dupThreshold;
+}
 
-                primitives.planecopy_sp_shl(vShort1, firstPic->stride[2] / sizeof(*vShort1), m_dupPicOne[2], firstPic->stride[2] / sizeof(*vShort1), widthC, heightC, shift, mask);
-                primitives.planecopy_sp_shl(vShort2, secPic->stride[2] / sizeof(*vShort2), m_dupPicTwo[2], secPic->stride[2] / sizeof(*vShort2), widthC, heightC, shift, mask);
-            }
+/* Converts the input picture to the internal bit depth in the duplication
+ * buffer and sums its 8x8 blocks for isDuplicatePicture() */
+void Encoder::copyPicture(AdaptiveFrameDuplication *dest, const x265_picture *src)
+{
+    x265_picture* pic = dest->dupPic;
+    pic->poc = src->poc;
+    pic->pts = src->pts;
+    pic->userSEI = src->userSEI;
+    pic->bitDepth = X265_DEPTH;
+    pic->height = src->height;
+    pic->width = src->width;
+    pic->colorSpace = src->colorSpace;
+    pic->rpu.payload = src->rpu.payload;
+    pic->picStruct = src->picStruct;
+
+    pixel* plane = (pixel*)dest->dupPlane;
+    uint32_t* blockSum = dest->blockSum;
+    for (int i = 0; i < x265_cli_csps[src->colorSpace].planes; i++)
+    {
+        int width = src->width >> x265_cli_csps[src->colorSpace].width[i];
+        int height = src->height >> x265_cli_csps[src->colorSpace].height[i];
+
+        if (src->bitDepth == 8)
+        {
+            const uint8_t* srcChar = (uint8_t*)src->planes[i];
+#if (X265_DEPTH > 8)
+            primitives.planecopy_cp(srcChar, src->stride[i] / sizeof(*srcChar), plane, width, width, height, X265_DEPTH - 8);
+#else
+            for (int y = 0; y < height; y++)
+                memcpy(plane + y * width, srcChar + y * src->stride[i], width * sizeof(pixel));
+#endif
+        }
+        else
+        {
+            /* defensive programming, mask off bits that are supposed to be zero */
+            uint16_t mask = (1 << X265_DEPTH) - 1;
+            int shift = abs(src->bitDepth - X265_DEPTH);
+            planecopy_sp_t copy = src->bitDepth > X265_DEPTH ? primitives.planecopy_sp : primitives.planecopy_sp_shl;
+            const uint16_t* srcShort = (uint16_t*)src->planes[i];
+            copy(srcShort, src->stride[i] / sizeof(*srcShort), plane, width, width, height, shift, mask);
         }
-    }
-
-    if (!(firstPic->bitDepth == 8 && X265_DEPTH == 8))
-    {
-        yFirstPic = m_dupPicOne[0]; ySecPic = m_dupPicTwo[0];
-        uFirstPic = m_dupPicOne[1]; uSecPic = m_dupPicTwo[1];
-        vFirstPic = m_dupPicOne[2]; vSecPic = m_dupPicTwo[2];
-    }
 
-    //Compute SSD
-    ssdY = computeSSD(yFirstPic, ySecPic, strideL, widthL, heightL, param);
-    psnrY = (ssdY ? 10.0 * log10(refValueY / (double)ssdY) : 99.99);
+        for (int y = 0; y + 8 <= height; y += 8)
+            for (int x = 0; x + 8 <= width; x += 8)
+                *blockSum++ = (uint32_t)primitives.cu[BLOCK_8x8].var(plane + y * width + x, width);
 
-    if (param->internalCsp != X265_CSP_I400)
-    {
-        ssdU = computeSSD(uFirstPic, uSecPic, strideC, widthC, heightC, param);
-        ssdV = computeSSD(vFirstPic, vSecPic, strideC, widthC, heightC, param);
-        psnrU = (ssdU ? 10.0 * log10(refValueC / (double)ssdU) : 99.99);
-        psnrV = (ssdV ? 10.0 * log10(refValueC / (double)ssdV) : 99.99);
+        pic->planes[i] = plane;
+        pic->stride[i] = (int)(width * sizeof(pixel));
+        plane += width * height;
     }
-
-    //Compute PSNR(picN,pic(N+1))
-    return psnrWeight = (psnrY * 6 + psnrU + psnrV) / 8;
-}
-
-void Encoder::copyPicture(x265_picture *dest, const x265_picture *src)
-{
-    dest->poc = src->poc;
-    dest->pts = src->pts;
-    dest->userSEI = src->userSEI;
-    dest->bitDepth = src->bitDepth;
-    dest->framesize = src->framesize;
-    dest->height = src->height;
-    dest->width = src->width;
-    dest->colorSpace = src->colorSpace;
-    dest->userSEI = src->userSEI;
-    dest->rpu.payload = src->rpu.payload;
-    dest->picStruct = src->picStruct;
-    dest->stride[0] = src->stride[0];
-    dest->stride[1] = src->stride[1];
-    dest->stride[2] = src->stride[2];
-    memcpy(dest->planes[0], src->planes[0], src->framesize * sizeof(char));
-    dest->planes[1] = (char*)dest->planes[0] + src->stride[0] * src->height;
-    dest->planes[2] = (char*)dest->planes[1] + src->stride[1] * (src->height >> x265_cli_csps[src->colorSpace].height[1]);
 }
 
 bool Encoder::computeHistograms(x265_picture *pic)
 {
     pixel *src = NULL, *planeV = NULL, *planeU = NULL;
+    intptr_t stride[3];
     uint32_t widthC, heightC;
     int hshift, vshift;
 
@@ -1371,6 +1368,8 @@ bool Encoder::computeHistograms(x265_picture *pic)
 
     if (pic->bitDepth == X265_DEPTH)
     {
+        for (int i = 0; i < 3; i++)
+            stride[i] = pic->stride[i] / sizeof(pixel);
         src = (pixel*)pic->planes[0];
         if (m_param->internalCsp != X265_CSP_I400)
         {
@@ -1383,6 +1382,10 @@ bool Encoder::computeHistograms(x265_picture *pic)
         int shift = (X265_DEPTH - 8);
         uint8_t *yChar, *uChar, *vChar;
 
+        /* the copies keep the strides of the input */
+        for (int i = 0; i < 3; i++)
+            stride[i] = pic->stride[i] / sizeof(*yChar);
+
         yChar = (uint8_t*)pic->planes[0];
         primitives.planecopy_cp(yChar, pic->stride[0] / sizeof(*yChar), m_inputPic[0], pic->stride[0] / sizeof(*yChar), pic->width, pic->height, shift);
         src = m_inputPic[0];
@@ -1406,6 +1409,8 @@ bool Encoder::computeHistograms(x265_picture *pic)
         yShort = (uint16_t*)pic->planes[0];
         uShort = (uint16_t*)pic->planes[1];
         vShort = (uint16_t*)pic->planes[2];
+        for (int i = 0; i < 3; i++)
+            stride[i] = pic->stride[i] / sizeof(*yShort);
 
         if (pic->bitDepth > X265_DEPTH)
         {
@@ -1433,140 +1438,155 @@ bool Encoder::computeHistograms(x265_picture *pic)
         planeV = m_inputPic[2];
     }
 
-    size_t bufSize = sizeof(pixel) * m_planeSizes[0];
-    memset(m_edgePic, 0, bufSize);
-
-    if (!computeEdge(m_edgePic, src, NULL, pic->width, pic->height, pic->width, false, 1))
-    {
-        x265_log(m_param, X265_LOG_ERROR, "Failed to compute edge!");
-        return false;
-    }
-
-    pixel pixelVal;
-    int32_t *edgeHist = m_curEdgeHist;
-    memset(edgeHist, 0, EDGE_BINS * sizeof(int32_t));
-    for (uint32_t i = 0; i < m_planeSizes[0]; i++)
+    /* the edge picture is only needed by edge based recursion skip */
+    if (m_edgePic)
     {
-        if (m_edgePic[i])
-            edgeHist[1]++;
-        else
-            edgeHist[0]++;
-    }
-
-    /* Y Histogram Calculation */
-    int32_t *yHist = m_curYUVHist[0];
-    memset(yHist, 0, HISTOGRAM_BINS * sizeof(int32_t));
-    for (uint32_t i = 0; i < m_planeSizes[0]; i++)
-    {
-        pixelVal = src[i];
-        yHist[pixelVal]++;
-    }
-
-    if (pic->colorSpace != X265_CSP_I400)
-    {
-        /* U Histogram Calculation */
-        int32_t *uHist = m_curYUVHist[1];
-        memset(uHist, 0, sizeof(m_curYUVHist[1]));
-        for (uint32_t i = 0; i < m_planeSizes[1]; i++)
+        memset(m_edgePic, 0, sizeof(pixel) * m_param->sourceWidth * m_param->sourceHeight);
+        if (!computeEdge(m_edgePic, src, NULL, pic->width, pic->height, pic->width, false, 1))
         {
-            pixelVal = planeU[i];
-            uHist[pixelVal]++;
-        }
-
-        /* V Histogram Calculation */
-        pixelVal = 0;
-        int32_t *vHist = m_curYUVHist[2];
-        memset(vHist, 0, sizeof(m_curYUVHist[2]));
-        for (uint32_t i = 0; i < m_planeSizes[2]; i++)
-        {
-            pixelVal = planeV[i];
-            vHist[pixelVal]++;
+            x265_log(m_param, X265_LOG_ERROR, "Failed to compute edge!");
+            return false;
         }
     }
+
+    const pixel* planes[3] = { src, planeU, planeV };
+    int32_t* yuvHist[3] = { m_curYUVHist[0], m_curYUVHist[1], m_curYUVHist[2] };
+    computeSceneCutHistograms(planes, stride, pic->width, pic->height, pic->colorSpace, m_curEdgeHist, yuvHist);
     return true;
 }
 
-void Encoder::computeHistogramSAD(double *normalizedMaxUVSad, double *normalizedEdgeSad, int curPoc)
+/* returns a recycled frame, or a newly allocated one if none are free */
+Frame* Encoder::getFreeFrame(x265_param* p, float* quantOffsets)
 {
-
-    if (curPoc == 0)
-    {   /* first frame is scenecut by default no sad computation for the same. */
-        *normalizedMaxUVSad = 0.0;
-        *normalizedEdgeSad = 0.0;
-    }
-    else
+    Frame *inFrame;
+    if (m_dpb->m_freeList.empty())
     {
-        /* compute sum of absolute differences of histogram bins of chroma and luma edge response between the current and prev pictures. */
-        int32_t edgeHistSad = 0;
-        int32_t uHistSad = 0;
-        int32_t vHistSad = 0;
-        double normalizedUSad = 0.0;
-        double normalizedVSad = 0.0;
-
-        for (int j = 0; j < HISTOGRAM_BINS; j++)
+        inFrame = new Frame;
+        if (inFrame->create(p, quantOffsets))
         {
-            if (j < 2)
+            /* the first PicYuv created is asked to generate the CU and block unit offset
+             * arrays which are then shared with all subsequent PicYuv (orig and recon) 
+             * allocated by this top level encoder */
+            if (m_sps.cuOffsetY)
+            {
+                inFrame->m_fencPic->m_cuOffsetY = m_sps.cuOffsetY;
+                inFrame->m_fencPic->m_buOffsetY = m_sps.buOffsetY;
+                if (m_param->internalCsp != X265_CSP_I400)
+                {
+                    inFrame->m_fencPic->m_cuOffsetC = m_sps.cuOffsetC;
+                    inFrame->m_fencPic->m_buOffsetC = m_sps.buOffsetC;
+                }
+            }
+            else
+            {
+                if (!inFrame->m_fencPic->createOffsets(m_sps))
+                {
+                    m_aborted = true;
+                    x265_log(m_param, X265_LOG_ERROR, "memory allocation failure, aborting encode\n");
+                    inFrame->destroy();
+                    delete inFrame;
+                    return NULL;
+                }
+                else
+                {
+                    m_sps.cuOffsetY = inFrame->m_fencPic->m_cuOffsetY;
+                    m_sps.buOffsetY = inFrame->m_fencPic->m_buOffsetY;
+                    if (m_param->internalCsp != X265_CSP_I400)
+                    {
+                        m_sps.cuOffsetC = inFrame->m_fencPic->m_cuOffsetC;
+                        m_sps.cuOffsetY = inFrame->m_fencPic->m_cuOffsetY;
+                        m_sps.buOffsetC = inFrame->m_fencPic->m_buOffsetC;
+                        m_sps.buOffsetY = inFrame->m_fencPic->m_buOffsetY;
+                    }
+                }
+            }
+            if (m_param->recursionSkipMode == EDGE_BASED_RSKIP && m_param->bHistBasedSceneCut)
             {
-                edgeHistSad += abs(m_curEdgeHist[j] - m_prevEdgeHist[j]);
+                pixel* src = m_edgePic;
+                primitives.planecopy_pp_shr(src, inFrame->m_fencPic->m_picWidth, inFrame->m_edgeBitPic, inFrame->m_fencPic->m_stride,
+                    inFrame->m_fencPic->m_picWidth, inFrame->m_fencPic->m_picHeight, 0);
             }
-            uHistSad += abs(m_curYUVHist[1][j] - m_prevYUVHist[1][j]);
-            vHistSad += abs(m_curYUVHist[2][j] - m_prevYUVHist[2][j]);
         }
-        *normalizedEdgeSad = normalizeRange(edgeHistSad, 0, 2 * m_planeSizes[0], 0.0, 1.0);
-        normalizedUSad = normalizeRange(uHistSad, 0, 2 * m_planeSizes[1], 0.0, 1.0);
-        normalizedVSad = normalizeRange(vHistSad, 0, 2 * m_planeSizes[2], 0.0, 1.0);
-        *normalizedMaxUVSad = x265_max(normalizedUSad, normalizedVSad);
+        else
+        {
+            m_aborted = true;
+            x265_log(m_param, X265_LOG_ERROR, "memory allocation failure, aborting encode\n");
+            inFrame->destroy();
+            delete inFrame;
+            return NULL;
+        }
+    }
+    else
+    {
+        inFrame = m_dpb->m_freeList.popBack();
+        /* Set lowres scencut and satdCost here to aovid overwriting ANALYSIS_READ
+           decision by lowres init*/
+        inFrame->m_lowres.bScenecut = false;
+        inFrame->m_lowres.m_bIsMaxThres = false;
+        inFrame->m_lowres.m_bIsHardScenecut = false;
+        inFrame->m_lowres.satdCost = (int64_t)-1;
+        inFrame->m_lowresInit = false;
+        inFrame->m_isInsideWindow = 0;
     }
 
-    /* store histograms of previous frame for reference */
-    memcpy(m_prevEdgeHist, m_curEdgeHist, sizeof(m_curEdgeHist));
-    memcpy(m_prevYUVHist, m_curYUVHist, sizeof(m_curYUVHist));
+    return inFrame;
 }
 
-double Encoder::normalizeRange(int32_t value, int32_t minValue, int32_t maxValue, double rangeStart, double rangeEnd)
+int Encoder::allocInputPicture(x265_picture* pic)
 {
-    return (double)(value - minValue) * (rangeEnd - rangeStart) / (maxValue - minValue) + rangeStart;
-}
+    if (m_param->bEnableFrameDuplication || m_param->bHistBasedSceneCut || !m_param->bCopyPicToFrame)
+    {
+        x265_log(m_param, X265_LOG_ERROR, "input picture buffers are not available with frame-dup, hist-scenecut or no-copy-pic\n");
+        return -1;
+    }
+    if (m_aborted)
+        return -1;
 
-void Encoder::findSceneCuts(x265_picture *pic, bool& bDup, double maxUVSad, double edgeSad, bool& isMaxThres, bool& isHardSC)
-{
-    double minEdgeT = m_edgeHistThreshold * MIN_EDGE_FACTOR;
-    double minChromaT = minEdgeT * SCENECUT_CHROMA_FACTOR;
-    double maxEdgeT = m_edgeHistThreshold * MAX_EDGE_FACTOR;
-    double maxChromaT = maxEdgeT * SCENECUT_CHROMA_FACTOR;
-    pic->frameData.bScenecut = false;
+    x265_param *p = (m_reconfigure || m_reconfigureRc) ? m_latestParam : m_param;
+    Frame* frame = getFreeFrame(p, NULL);
+    if (!frame)
+        return -1;
+    m_inputFrames.pushBack(*frame);
 
-    if (pic->poc == 0)
+    PicYuv* fenc = frame->m_fencPic;
+    pic->inputFrame = frame;
+    pic->bitDepth = X265_DEPTH;
+    pic->colorSpace = m_param->internalCsp;
+    pic->width = m_param->sourceWidth;
+    pic->height = m_param->sourceHeight;
+    pic->framesize = 0;
+    for (int i = 0; i < 3; i++)
     {
-        /* for first frame */
-        pic->frameData.bScenecut = false;
-        bDup = false;
+        bool bPlane = i < x265_cli_csps[m_param->internalCsp].planes;
+        pic->planes[i] = bPlane ? fenc->m_picOrg[i] : NULL;
+        pic->stride[i] = bPlane ? (int)((i ? fenc->m_strideC : fenc->m_stride) * sizeof(pixel)) : 0;
     }
-    else
+
+    return 0;
+}
+
+Frame* Encoder::takeInputFrame(void* handle)
+{
+    for (Frame* frame = m_inputFrames.first(); frame; frame = frame->m_next)
     {
-        if (edgeSad == 0.0 && maxUVSad == 0.0)
-        {
-            bDup = true;
-        }
-        else if (edgeSad < minEdgeT && maxUVSad < minChromaT)
-        {
-            pic->frameData.bScenecut = false;
-        }
-        else if (edgeSad > maxEdgeT && maxUVSad > maxChromaT)
-        {
-            pic->frameData.bScenecut = true;
-            isMaxThres = true;
-            isHardSC = true;
-        }
-        else if (edgeSad > m_scaledEdgeThreshold || maxUVSad >= m_scaledChromaThreshold
-                 || (edgeSad > m_edgeHistThreshold && maxUVSad >= m_chromaHistThreshold))
+        if (frame == handle)
         {
-            pic->frameData.bScenecut = true;
-            bDup = false;
-            if (edgeSad > m_scaledEdgeThreshold || maxUVSad >= m_scaledChromaThreshold)
-                isHardSC = true;
+            m_inputFrames.remove(*frame);
+            return frame;
         }
     }
+
+    return NULL;
+}
+
+void Encoder::freeInputPicture(x265_picture* pic)
+{
+    Frame* frame = takeInputFrame(pic->inputFrame);
+    if (frame)
+        m_dpb->m_freeList.pushBack(*frame);
+
+    pic->inputFrame = NULL;
+    pic->planes[0] = pic->planes[1] = pic->planes[2] = NULL;
 }
 
 /**
@@ -1592,6 +1612,11 @@ int Encoder::encode(const x265_picture* pic_in, x265_picture* pic_out)
     if (m_aborted)
         return -1;
 
+#if ENABLE_TRACE
+    /* the lookahead work done on the calling thread */
+    TraceSessionScope traceScope(m_traceSession);
+#endif
+
     const x265_picture* inputPic = NULL;
     static int written = 0, read = 0;
     bool dontRead = false;
@@ -1610,22 +1635,16 @@ int Encoder::encode(const x265_picture* pic_in, x265_picture* pic_out)
     }
     if ((pic_in && (!m_param->chunkEnd || (m_encodedFrameNum < m_param->chunkEnd))) || (m_param->bEnableFrameDuplication && !pic_in && (read < written)))
     {
-        if (m_param->bHistBasedSceneCut && pic_in)
+        if (m_param->bHistBasedSceneCut && !m_lookahead->m_bHistPreAnalysis && pic_in)
         {
             x265_picture *pic = (x265_picture *) pic_in;
 
-            if (pic->poc == 0)
-            {
-                /* for entire encode compute the chroma plane sizes only once */
-                for (int i = 1; i < x265_cli_csps[m_param->internalCsp].planes; i++)
-                    m_planeSizes[i] = (pic->width >> x265_cli_csps[m_param->internalCsp].width[i]) * (pic->height >> x265_cli_csps[m_param->internalCsp].height[i]);
-            }
-
             if (computeHistograms(pic))
             {
-                double maxUVSad = 0.0, edgeSad = 0.0;
-                computeHistogramSAD(&maxUVSad, &edgeSad, pic_in->poc);
-                findSceneCuts(pic, bdropFrame, maxUVSad, edgeSad, isMaxThres, isHardSC);
+                bool bScenecut;
+                int32_t* yuvHist[3] = { m_curYUVHist[0], m_curYUVHist[1], m_curYUVHist[2] };
+                m_lookahead->histBasedSceneCut(m_curEdgeHist, yuvHist, pic->poc == 0, bScenecut, bdropFrame, isMaxThres, isHardSC);
+                pic->frameData.bScenecut = bScenecut;
             }
         }
 
@@ -1654,20 +1673,18 @@ int Encoder::encode(const x265_picture* pic_in, x265_picture* pic_out)
 
         if (m_param->bEnableFrameDuplication)
         {
-            double psnrWeight = 0;
-
             if (!dontRead)
             {
                 if (!m_dupBuffer[0]->bOccupied)
                 {
-                    copyPicture(m_dupBuffer[0]->dupPic, pic_in);
+                    copyPicture(m_dupBuffer[0], pic_in);
                     m_dupBuffer[0]->bOccupied = true;
                     written++;
                     return 0;
                 }
                 else if (!m_dupBuffer[1]->bOccupied)
                 {
-                    copyPicture(m_dupBuffer[1]->dupPic, pic_in);
+                    copyPicture(m_dupBuffer[1], pic_in);
                     m_dupBuffer[1]->bOccupied = true;
                     written++;
                 }
@@ -1675,22 +1692,14 @@ int Encoder::encode(const x265_picture* pic_in, x265_picture* pic_out)
                 if (m_param->bEnableFrameDuplication && m_param->bHistBasedSceneCut)
                 {
                     if (!bdropFrame && m_dupBuffer[1]->dupPic->frameData.bScenecut == false)
-                    {
-                        psnrWeight = ComputePSNR(m_dupBuffer[0]->dupPic, m_dupBuffer[1]->dupPic, m_param);
-                        if (psnrWeight >= m_param->dupThreshold)
-                            dropflag = true;
-                    }
+                        dropflag = isDuplicatePicture(m_dupBuffer[0], m_dupBuffer[1]);
                     else
                     {
                         dropflag = true;
                     }
                 }
                 else if (m_param->bEnableFrameDuplication)
-                {
-                    psnrWeight = ComputePSNR(m_dupBuffer[0]->dupPic, m_dupBuffer[1]->dupPic, m_param);
-                    if (psnrWeight >= m_param->dupThreshold)
-                        dropflag = true;
-                }
+                    dropflag = isDuplicatePicture(m_dupBuffer[0], m_dupBuffer[1]);
 
                 if (dropflag)
                 {
@@ -1726,83 +1735,32 @@ int Encoder::encode(const x265_picture* pic_in, x265_picture* pic_out)
 
         Frame *inFrame;
         x265_param *p = (m_reconfigure || m_reconfigureRc) ? m_latestParam : m_param;
-        if (m_dpb->m_freeList.empty())
+        if (inputPic->inputFrame)
         {
-            inFrame = new Frame;
-            inFrame->m_encodeStartTime = x265_mdate();
-            if (inFrame->create(p, inputPic->quantOffsets))
+            /* the picture was written in place, into a frame lent out by
+             * allocInputPicture() */
+            inFrame = takeInputFrame(inputPic->inputFrame);
+            if (!inFrame)
             {
-                /* the first PicYuv created is asked to generate the CU and block unit offset
-                 * arrays which are then shared with all subsequent PicYuv (orig and recon) 
-                 * allocated by this top level encoder */
-                if (m_sps.cuOffsetY)
-                {
-                    inFrame->m_fencPic->m_cuOffsetY = m_sps.cuOffsetY;
-                    inFrame->m_fencPic->m_buOffsetY = m_sps.buOffsetY;
-                    if (m_param->internalCsp != X265_CSP_I400)
-                    {
-                        inFrame->m_fencPic->m_cuOffsetC = m_sps.cuOffsetC;
-                        inFrame->m_fencPic->m_buOffsetC = m_sps.buOffsetC;
-                    }
-                }
-                else
-                {
-                    if (!inFrame->m_fencPic->createOffsets(m_sps))
-                    {
-                        m_aborted = true;
-                        x265_log(m_param, X265_LOG_ERROR, "memory allocation failure, aborting encode\n");
-                        inFrame->destroy();
-                        delete inFrame;
-                        return -1;
-                    }
-                    else
-                    {
-                        m_sps.cuOffsetY = inFrame->m_fencPic->m_cuOffsetY;
-                        m_sps.buOffsetY = inFrame->m_fencPic->m_buOffsetY;
-                        if (m_param->internalCsp != X265_CSP_I400)
-                        {
-                            m_sps.cuOffsetC = inFrame->m_fencPic->m_cuOffsetC;
-                            m_sps.cuOffsetY = inFrame->m_fencPic->m_cuOffsetY;
-                            m_sps.buOffsetC = inFrame->m_fencPic->m_buOffsetC;
-                            m_sps.buOffsetY = inFrame->m_fencPic->m_buOffsetY;
-                        }
-                    }
-                }
-                if (m_param->recursionSkipMode == EDGE_BASED_RSKIP && m_param->bHistBasedSceneCut)
-                {
-                    pixel* src = m_edgePic;
-                    primitives.planecopy_pp_shr(src, inFrame->m_fencPic->m_picWidth, inFrame->m_edgeBitPic, inFrame->m_fencPic->m_stride,
-                        inFrame->m_fencPic->m_picWidth, inFrame->m_fencPic->m_picHeight, 0);
-                }
-            }
-            else
-            {
-                m_aborted = true;
-                x265_log(m_param, X265_LOG_ERROR, "memory allocation failure, aborting encode\n");
-                inFrame->destroy();
-                delete inFrame;
+                x265_log(m_param, X265_LOG_ERROR, "input picture buffer was not allocated by this encoder\n");
                 return -1;
             }
         }
         else
         {
-            inFrame = m_dpb->m_freeList.popBack();
-            inFrame->m_encodeStartTime = x265_mdate();
-            /* Set lowres scencut and satdCost here to aovid overwriting ANALYSIS_READ
-               decision by lowres init*/
-            inFrame->m_lowres.bScenecut = false;
-            inFrame->m_lowres.satdCost = (int64_t)-1;
-            inFrame->m_lowresInit = false;
-            inFrame->m_isInsideWindow = 0;
+            inFrame = getFreeFrame(p, inputPic->quantOffsets);
+            if (!inFrame)
+                return -1;
         }
+        inFrame->m_encodeStartTime = x265_mdate();
 
         /* Copy input picture into a Frame and PicYuv, send to lookahead */
-        inFrame->m_fencPic->copyFromPicture(*inputPic, *m_param, m_sps.conformanceWindow.rightOffset, m_sps.conformanceWindow.bottomOffset);
+        inFrame->m_fencPic->copyFromPicture(*inputPic, *m_param, m_sps.conformanceWindow.rightOffset, m_sps.conformanceWindow.bottomOffset, m_threadPool);
 
         inFrame->m_poc       = ++m_pocLast;
         inFrame->m_userData  = inputPic->userData;
         inFrame->m_pts       = inputPic->pts;
-        if (m_param->bHistBasedSceneCut)
+        if (m_param->bHistBasedSceneCut && !m_lookahead->m_bHistPreAnalysis)
         {
             inFrame->m_lowres.bScenecut = (inputPic->frameData.bScenecut == 1) ? true : false;
             inFrame->m_lowres.m_bIsMaxThres = isMaxThres;
@@ -1826,7 +1784,7 @@ int Encoder::encode(const x265_picture* pic_in, x265_picture* pic_out)
                 }
             }
         }
-        if (m_param->bHistBasedSceneCut && m_param->analysisSave)
+        if (m_param->bHistBasedSceneCut && !m_lookahead->m_bHistPreAnalysis && m_param->analysisSave)
         {
             memcpy(inFrame->m_analysisData.edgeHist, m_curEdgeHist, EDGE_BINS * sizeof(int32_t));
             memcpy(inFrame->m_analysisData.yuvHist[0], m_curYUVHist[0], HISTOGRAM_BINS *sizeof(int32_t));
@@ -1859,6 +1817,10 @@ int Encoder::encode(const x265_picture* pic_in, x265_picture* pic_out)
                 cuCount = inFrame->m_lowres.maxBlocksInRowFullRes * inFrame->m_lowres.maxBlocksInColFullRes;
             else
                 cuCount = inFrame->m_lowres.maxBlocksInRow * inFrame->m_lowres.maxBlocksInCol;
+            /* frames lent out by allocInputPicture(), or recycled from pictures
+             * without offsets, have no buffer for them yet */
+            if (!inFrame->m_quantOffsets)
+                inFrame->m_quantOffsets = new float[cuCount];
             memcpy(inFrame->m_quantOffsets, inputPic->quantOffsets, cuCount * sizeof(float));
         }
 
@@ -1969,7 +1931,11 @@ int Encoder::encode(const x265_picture* pic_in, x265_picture* pic_out)
                 m_dupBuffer[0]->bOccupied = m_dupBuffer[1]->bOccupied = false;
             else
             {
-                copyPicture(m_dupBuffer[0]->dupPic, m_dupBuffer[1]->dupPic);
+                /* the next picture becomes the reference for comparisons,
+                 * the buffers trade their planes rather than copying them */
+                std::swap(m_dupBuffer[0]->dupPic, m_dupBuffer[1]->dupPic);
+                std::swap(m_dupBuffer[0]->dupPlane, m_dupBuffer[1]->dupPlane);
+                std::swap(m_dupBuffer[0]->blockSum, m_dupBuffer[1]->blockSum);
                 m_dupBuffer[1]->bOccupied = false;
             }
         }
@@ -2166,6 +2132,8 @@ int Encoder::encode(const x265_picture* pic_in, x265_picture* pic_out)
 
             if ((m_outputCount + 1)  >= m_param->chunkStart)
                 finishFrameStats(outFrame, curEncoder, frameData, m_pocLast);
+            if (m_ctuCostFile)
+                writeCTUCostMap(outFrame);
             if (m_param->analysisSave)
             {
                 pic_out->analysisData.frameBits = frameData->bits;
@@ -2491,6 +2459,7 @@ int Encoder::reconfigureParam(x265_param* encParam, x265_param* param)
     {
         encParam->maxNumReferences = param->maxNumReferences; // never uses more refs than specified in stream headers
         encParam->bEnableFastIntra = param->bEnableFastIntra;
+        encParam->intraGradModes = param->intraGradModes;
         encParam->bEnableEarlySkip = param->bEnableEarlySkip;
         encParam->recursionSkipMode = param->recursionSkipMode;
         encParam->searchMethod = param->searchMethod;
@@ -2870,6 +2839,14 @@ void Encoder::printSummary()
                  100.0 * cuStats.weightAnalyzeTime / totalWorkerTime,
                  ELAPSED_MSEC(cuStats.weightAnalyzeTime) / cuStats.countWeightAnalyze);
     }
+    if (cuStats.countFrames)
+        x265_log(m_param, X265_LOG_INFO, "CU: frame threads spent %.3lf ms per frame coding slices and %.3lf ms in rate control\n",
+                 ELAPSED_MSEC(cuStats.entropyElapsedTime) / cuStats.countFrames,
+                 ELAPSED_MSEC(cuStats.rateControlElapsedTime) / cuStats.countFrames);
+    if (cuStats.countZeroBlockChecks)
+        x265_log(m_param, X265_LOG_INFO, "CU: %%%05.2lf of %.3lf inter TUs per CTU predicted zero, transform and quant skipped\n",
+                 100.0 * cuStats.countZeroBlockSkips / cuStats.countZeroBlockChecks,
+                 (double)cuStats.countZeroBlockChecks / cuStats.totalCTUs);
     if (m_param->bDistributeModeAnalysis && cuStats.countPModeMasters)
     {
         x265_log(m_param, X265_LOG_INFO, "CU: %.3lf PMODE masters per CTU, each blocked an average of %.3lf ns\n",
@@ -2878,6 +2855,8 @@ void Encoder::printSummary()
         x265_log(m_param, X265_LOG_INFO, "CU:       %.3lf slaves per PMODE master, each took average of %.3lf ms\n",
                  (double)cuStats.countPModeTasks / cuStats.countPModeMasters,
                  ELAPSED_MSEC(cuStats.pmodeTime) / cuStats.countPModeTasks);
+        x265_log(m_param, X265_LOG_INFO, "CU:       %%%05.2lf of PMODE masters released mode tasks before split analysis\n",
+                 100.0 * cuStats.countPModeEarlyMasters / cuStats.countPModeMasters);
     }
 
     x265_log(m_param, X265_LOG_INFO, "CU: %%%05.2lf time spent in slicetypeDecide (avg %.3lfms) and prelookahead (avg %.3lfms)\n",
@@ -2994,6 +2973,28 @@ void Encoder::fetchStats(x265_stats *stats, size_t statsSizeBytes)
      * future safety) */
 }
 
+/* Each frame of the CTU cost map is its POC, encode order and slice type
+ * (the character of the CSV log) as int32, followed by the FrameData::CTUCost
+ * of every CTU in raster order */
+void Encoder::writeCTUCostMap(Frame* curFrame)
+{
+    FrameData& curEncData = *curFrame->m_encData;
+    Slice* slice = curEncData.m_slice;
+
+    char c = (slice->isIntra() ? (curFrame->m_lowres.sliceType == X265_TYPE_IDR ? 'I' : 'i') : slice->isInterP() ? 'P' : 'B');
+    if (!IS_REFERENCED(curFrame))
+        c += 32;
+    int32_t frameHeader[3] = { slice->m_poc, curFrame->m_encodeOrder, c };
+
+    if (fwrite(frameHeader, sizeof(int32_t), 3, m_ctuCostFile) != 3 ||
+        fwrite(curEncData.m_ctuCost, sizeof(FrameData::CTUCost), m_sps.numCUsInFrame, m_ctuCostFile) != m_sps.numCUsInFrame)
+    {
+        x265_log(m_param, X265_LOG_WARNING, "error writing CTU cost map, disabled\n");
+        fclose(m_ctuCostFile);
+        m_ctuCostFile = NULL;
+    }
+}
+
 void Encoder::finishFrameStats(Frame* curFrame, FrameEncoder *curEncoder, x265_frame_stats* frameStats, int inPoc)
 {
     PicYuv* reconPic = curFrame->m_reconPic;
@@ -3479,6 +3480,7 @@ void Encoder::configureZone(x265_param *p, x265_param *zone)
     {
         p->maxNumReferences = zone->maxNumReferences;
         p->bEnableFastIntra = zone->bEnableFastIntra;
+        p->intraGradModes = zone->intraGradModes;
         p->bEnableEarlySkip = zone->bEnableEarlySkip;
         p->recursionSkipMode = zone->recursionSkipMode;
         p->searchMethod = zone->searchMethod;
@@ -4211,6 +4213,12 @@ void Encoder::configure(x265_param *p)
     if (p->bLogCuStats)
         x265_log(p, X265_LOG_WARNING, "--cu-stats option is now deprecated\n");
 
+    if (p->bCTUCostMap && !p->csvfn)
+    {
+        x265_log(p, X265_LOG_WARNING, "--ctu-cost-map is written next to the CSV log, requires --csv. Disabling\n");
+        p->bCTUCostMap = 0;
+    }
+
     if (p->log2MaxPocLsb < 4)
     {
         x265_log(p, X265_LOG_WARNING, "maximum of the picture order count can not be less than 4\n");
@@ -5823,6 +5831,7 @@ void Encoder::printReconfigureParams()
 #define TOOLCMP(COND1, COND2, STR)  if (COND1 != COND2) { sprintf(tmp, STR, COND1, COND2); x265_log(newParam, X265_LOG_DEBUG, tmp); }
     TOOLCMP(oldParam->maxNumReferences, newParam->maxNumReferences, "ref=%d to %d\n");
     TOOLCMP(oldParam->bEnableFastIntra, newParam->bEnableFastIntra, "fast-intra=%d to %d\n");
+    TOOLCMP(oldParam->intraGradModes, newParam->intraGradModes, "intra-grad-modes=%d to %d\n");
     TOOLCMP(oldParam->bEnableEarlySkip, newParam->bEnableEarlySkip, "early-skip=%d to %d\n");
     TOOLCMP(oldParam->recursionSkipMode, newParam->recursionSkipMode, "rskip=%d to %d\n");
     TOOLCMP(oldParam->searchMethod, newParam->searchMethod, "me=%d to %d\n");
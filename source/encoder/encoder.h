@@ -31,6 +31,7 @@
 #include "x265.h"
 #include "nal.h"
 #include "framedata.h"
+#include "piclist.h"
 #include "svt.h"
 #ifdef ENABLE_HDR10_PLUS
     #include "dynamicHDR10/hdr10plus.h"
@@ -149,6 +150,9 @@ struct AdaptiveFrameDuplication
     x265_picture* dupPic;
     char* dupPlane;
 
+    /* sums of the 8x8 blocks of each plane, compared before the SSD */
+    uint32_t* blockSum;
+
     //Flag to denote the availability of the picture buffer.
     bool bOccupied;
 
@@ -163,12 +167,6 @@ class RateControl;
 class ThreadPool;
 class FrameData;
 
-#define MAX_SCENECUT_THRESHOLD 1.0
-#define SCENECUT_STRENGTH_FACTOR 2.0
-#define MIN_EDGE_FACTOR 0.5
-#define MAX_EDGE_FACTOR 1.5
-#define SCENECUT_CHROMA_FACTOR 10.0
-
 class Encoder : public x265_encoder
 {
 public:
@@ -202,17 +200,16 @@ public:
     FrameEncoder*      m_frameEncoder[X265_MAX_FRAME_THREADS];
     DPB*               m_dpb;
     Frame*             m_exportedPic;
+    PicList            m_inputFrames;     // free frames lent out by allocInputPicture()
     FILE*              m_analysisFileIn;
     FILE*              m_analysisFileOut;
     FILE*              m_naluFile;
+    FILE*              m_ctuCostFile;     // --ctu-cost-map output
     x265_param*        m_param;
     x265_param*        m_latestParam;     // Holds latest param during a reconfigure
     RateControl*       m_rateControl;
     Lookahead*         m_lookahead;
     AdaptiveFrameDuplication* m_dupBuffer[DUP_BUFFER];      // picture buffer of size 2
-    /*Frame duplication: Two pictures used to compute PSNR */
-    pixel*             m_dupPicOne[3];
-    pixel*             m_dupPicTwo[3];
 
     bool               m_externalFlush;
     /* Collect statistics globally */
@@ -254,24 +251,20 @@ public:
     double             m_cR;
 
     int                m_bToneMap; // Enables tone-mapping
+    int                m_traceSession; // the --trace recording this encoder opened, 0 for none
     int                m_enableNal;
 
-    /* For histogram based scene-cut detection */
+    /* For histogram based scene-cut detection on the API thread, otherwise
+     * the lookahead computes them during pre-analysis */
     pixel*             m_edgePic;
     pixel*             m_inputPic[3];
     int32_t            m_curYUVHist[3][HISTOGRAM_BINS];
-    int32_t            m_prevYUVHist[3][HISTOGRAM_BINS];
     int32_t            m_curEdgeHist[2];
-    int32_t            m_prevEdgeHist[2];
-    uint32_t           m_planeSizes[3];
-    double             m_edgeHistThreshold;
-    double             m_chromaHistThreshold;
-    double             m_scaledEdgeThreshold;
-    double             m_scaledChromaThreshold;
 
 #ifdef ENABLE_HDR10_PLUS
     const hdr10plus_api     *m_hdr10plus_api;
-    uint8_t                 **m_cim;
+    hdr10plus_movie         *m_toneMapMovie; // dhdr10-info, parsed a frame at a time
+    uint8_t                 m_cim[HDR10PLUS_MAX_CIM_SIZE];
     int                     m_numCimInfo;
 #endif
 
@@ -311,6 +304,10 @@ public:
 
     int encode(const x265_picture* pic, x265_picture *pic_out);
 
+    int allocInputPicture(x265_picture* pic);
+
+    void freeInputPicture(x265_picture* pic);
+
     int reconfigureParam(x265_param* encParam, x265_param* param);
 
     bool isReconfigureRc(x265_param* latestParam, x265_param* param_in);
@@ -361,6 +358,8 @@ public:
 
     void finishFrameStats(Frame* pic, FrameEncoder *curEncoder, x265_frame_stats* frameStats, int inPoc);
 
+    void writeCTUCostMap(Frame* pic);
+
     int validateAnalysisData(x265_analysis_validate* param, int readWriteFlag);
 
     void readUserSeiFile(x265_sei_payload& seiMsg, int poc);
@@ -371,12 +370,15 @@ public:
 
     double ComputePSNR(x265_picture *firstPic, x265_picture *secPic, x265_param *param);
 
-    void copyPicture(x265_picture *dest, const x265_picture *src);
+    bool isDuplicatePicture(AdaptiveFrameDuplication* first, AdaptiveFrameDuplication* second);
+
+    void copyPicture(AdaptiveFrameDuplication* dest, const x265_picture *src);
+
+    Frame* getFreeFrame(x265_param* p, float* quantOffsets);
+
+    Frame* takeInputFrame(void* handle);
 
     bool computeHistograms(x265_picture *pic);
-    void computeHistogramSAD(double *maxUVNormalizedSAD, double *edgeNormalizedSAD, int curPoc);
-    double normalizeRange(int32_t value, int32_t minValue, int32_t maxValue, double rangeStart, double rangeEnd);
-    void findSceneCuts(x265_picture *pic, bool& bDup, double m_maxUVSADVal, double m_edgeSADVal, bool& isMaxThres, bool& isHardSC);
 
     void initRefIdx();
     void analyseRefIdx(int *numRefIdx);
@@ -221,12 +221,21 @@ static const uint8_t INIT_TRANSFORMSKIP_FLAG[3][2 * NUM_TRANSFORMSKIP_FLAG_CTX]
     { 139,  139 },
 };
 
+static int32_t s_entropyInstances;
+
 Entropy::Entropy()
 {
     markValid();
     m_fracBits = 0;
     m_pad = 0;
     m_meanQP = 0;
+    m_ctxSrc = NULL;
+    m_ctxSrcId = m_ctxSrcGen = 0;
+    m_ctxId = (uint32_t)ATOMIC_INC(&s_entropyInstances);
+    m_ctxGen = 0;
+    m_ctxDirty = true;
+    m_estSrc = NULL;
+    m_estSrcId = m_estSrcGen = m_estKey = 0;
     X265_CHECK(sizeof(m_contextState) >= sizeof(m_contextState[0]) * MAX_OFF_CTX_MOD, "context state table is too small\n");
 }
 
@@ -1348,6 +1357,10 @@ void Entropy::resetEntropy(const Slice& slice)
     initBuffer(&m_contextState[OFF_TQUANT_BYPASS_FLAG_CTX], sliceType, qp, (uint8_t*)INIT_CU_TRANSQUANT_BYPASS_FLAG, NUM_TQUANT_BYPASS_FLAG_CTX);
     // new structure
 
+    /* every context was rewritten, this is no longer a copy of anything */
+    m_ctxSrc = NULL;
+    m_ctxGen++;
+
     start();
 }
 
@@ -1504,6 +1517,7 @@ void Entropy::loadIntraDirModeLuma(const Entropy& src)
     X265_CHECK(src.m_valid, "invalid copy source context\n");
     m_fracBits = src.m_fracBits;
     m_contextState[OFF_ADI_CTX] = src.m_contextState[OFF_ADI_CTX];
+    m_ctxDirty = true;
 }
 
 void Entropy::copyFrom(const Entropy& src)
@@ -1511,9 +1525,7 @@ void Entropy::copyFrom(const Entropy& src)
     X265_CHECK(src.m_valid, "invalid copy source context\n");
 
     copyState(src);
-
-    memcpy(m_contextState, src.m_contextState, MAX_OFF_CTX_MOD * sizeof(uint8_t));
-    markValid();
+    copyContextsFrom(src);
 }
 
 void Entropy::codePartSize(const CUData& cu, uint32_t absPartIdx, uint32_t depth)
@@ -2067,6 +2079,7 @@ void Entropy::codeCoeffNxN(const CUData& cu, const coeff_t* coeff, uint32_t absP
                 const uint8_t *tabSigCtx = table_cnt[(log2TrSize == 2) ? 4 : (uint32_t)patternSigCtx];
                 X265_CHECK(numNonZero <= 1, "numNonZero check failure");
                 uint32_t sum = primitives.costCoeffNxN(g_scan4x4[codingParameters.scanType], &coeff[blkPosBase], (intptr_t)trSize, absCoeff + numNonZero, tabSigCtx, scanFlagMask, baseCtx, offset + posOffset, scanPosSigOff, subPosBase);
+                m_ctxDirty = true;
 
 #if CHECKED_BUILD || _DEBUG
                 numNonZero = coeffNum[subSet];
@@ -2099,6 +2112,7 @@ void Entropy::codeCoeffNxN(const CUData& cu, const coeff_t* coeff, uint32_t absP
             if (!m_bitIf)
             {
                 uint32_t sum = primitives.costC1C2Flag(absCoeff, numC1Flag, baseCtxMod, (bIsLuma ? 0 : NUM_ABS_FLAG_CTX_LUMA - NUM_ONE_FLAG_CTX_LUMA) + (OFF_ABS_FLAG_CTX - OFF_ONE_FLAG_CTX) - 3 * ctxSet);
+                m_ctxDirty = true;
                 uint32_t firstC2Idx = (sum >> 28);
                 c1 = ((sum >> 26) & 3);
                 m_fracBits += sum & 0x00FFFFFF;
@@ -2214,8 +2228,26 @@ void Entropy::codeSaoMaxUvlc(uint32_t code, uint32_t maxSymbol)
 }
 
 /* estimate bit cost for CBP, significant map and significant coefficients */
-void Entropy::estBit(EstBitsSbac& estBitsSbac, uint32_t log2TrSize, bool bIsLuma) const
+void Entropy::estBit(EstBitsSbac& estBitsSbac, uint32_t log2TrSize, bool bIsLuma)
 {
+    /* RD trials reload the same snapshot and re-estimate the same TU shape
+     * many times; a clean copy of the snapshot m_estBitsSbac was derived
+     * from needs no rebuild */
+    const uint32_t key = (log2TrSize << 1) | bIsLuma;
+    const bool bCacheable = &estBitsSbac == &m_estBitsSbac && !m_ctxDirty && m_ctxSrc;
+    if (bCacheable && m_estSrc == m_ctxSrc && m_estSrcId == m_ctxSrcId && m_estSrcGen == m_ctxSrcGen && m_estKey == key)
+    {
+#if CHECKED_BUILD || _DEBUG
+        EstBitsSbac check = m_estBitsSbac;
+        estCBFBit(check);
+        estSignificantCoeffGroupMapBit(check, bIsLuma);
+        estSignificantMapBit(check, log2TrSize, bIsLuma);
+        estSignificantCoefficientsBit(check, bIsLuma);
+        X265_CHECK(!memcmp(&check, &m_estBitsSbac, sizeof(check)), "stale cached bit estimates\n");
+#endif
+        return;
+    }
+
     estCBFBit(estBitsSbac);
 
     estSignificantCoeffGroupMapBit(estBitsSbac, bIsLuma);
@@ -2225,6 +2257,14 @@ void Entropy::estBit(EstBitsSbac& estBitsSbac, uint32_t log2TrSize, bool bIsLuma
 
     // encode significant coefficients
     estSignificantCoefficientsBit(estBitsSbac, bIsLuma);
+
+    if (&estBitsSbac == &m_estBitsSbac)
+    {
+        m_estSrc = bCacheable ? m_ctxSrc : NULL;
+        m_estSrcId = m_ctxSrcId;
+        m_estSrcGen = m_ctxSrcGen;
+        m_estKey = key;
+    }
 }
 
 /* estimate bit cost for each CBP bit */
@@ -2390,6 +2430,13 @@ void Entropy::copyContextsFrom(const Entropy& src)
     X265_CHECK(src.m_valid, "invalid copy source context\n");
 
     memcpy(m_contextState, src.m_contextState, MAX_OFF_CTX_MOD * sizeof(m_contextState[0]));
+
+    /* a source that has been coded into since its own last copy has no stable identity */
+    m_ctxSrc = src.m_ctxDirty ? NULL : &src;
+    m_ctxSrcId = src.m_ctxId;
+    m_ctxSrcGen = src.m_ctxGen;
+    m_ctxGen++;
+    m_ctxDirty = false;
     markValid();
 }
 
@@ -2456,6 +2503,7 @@ void Entropy::encodeBin(uint32_t binValue, uint8_t &ctxModel)
     uint32_t mstate = ctxModel;
 
     ctxModel = sbacNext(mstate, binValue);
+    m_ctxDirty = true;
 
     if (!m_bitIf)
     {
@@ -113,6 +113,24 @@ public:
     EstBitsSbac   m_estBitsSbac;
     double        m_meanQP;
 
+    /* Context snapshot identity. m_ctxSrc/m_ctxSrcId/m_ctxSrcGen name the coder
+     * our contexts were last copied from (NULL if that source had itself been
+     * coded into), m_ctxDirty is set by any context update since the copy.
+     * Two clean copies with the same identity hold the same contexts, which
+     * lets estBit() skip rebuilding m_estBitsSbac between RD trials */
+    const Entropy* m_ctxSrc;
+    uint32_t       m_ctxSrcId;
+    uint32_t       m_ctxSrcGen;
+    uint32_t       m_ctxId;     // unique per instance, guards against address reuse
+    uint32_t       m_ctxGen;    // bumped by every context copy into this coder
+    bool           m_ctxDirty;
+
+    /* snapshot identity and TU shape m_estBitsSbac was last derived from */
+    const Entropy* m_estSrc;
+    uint32_t       m_estSrcId;
+    uint32_t       m_estSrcGen;
+    uint32_t       m_estKey;
+
     Entropy();
 
     void setBitstream(Bitstream* p)    { m_bitIf = p; }
@@ -187,7 +205,7 @@ public:
     void codeSaoOffsetBO(int *offset, int bandPos, int plane);
 
     /* RDO functions */
-    void estBit(EstBitsSbac& estBitsSbac, uint32_t log2TrSize, bool bIsLuma) const;
+    void estBit(EstBitsSbac& estBitsSbac, uint32_t log2TrSize, bool bIsLuma);
     void estCBFBit(EstBitsSbac& estBitsSbac) const;
     void estSignificantCoeffGroupMapBit(EstBitsSbac& estBitsSbac, bool bIsLuma) const;
     void estSignificantMapBit(EstBitsSbac& estBitsSbac, uint32_t log2TrSize, bool bIsLuma) const;
@@ -49,6 +49,7 @@ FrameEncoder::FrameEncoder()
     m_completionCount = 0;
     m_outStreams = NULL;
     m_backupStreams = NULL;
+    m_escapedStreams = NULL;
     m_substreamSizes = NULL;
     m_nr = NULL;
     m_tld = NULL;
@@ -85,6 +86,7 @@ void FrameEncoder::destroy()
     delete[] m_rows;
     delete[] m_outStreams;
     delete[] m_backupStreams;
+    delete[] m_escapedStreams;
     X265_FREE(m_sliceBaseRow);
     X265_FREE((void*)m_bAllRowsStop);
     X265_FREE((void*)m_vbvResetTriggerRow);
@@ -354,6 +356,45 @@ void FrameEncoder::WeightAnalysis::processTasks(int /* workerThreadId */)
     weightAnalyse(*frame->m_encData->m_slice, *frame, *master.m_param);
 }
 
+void FrameEncoder::PlaneHash::processTasks(int /* workerThreadId */)
+{
+    PicYuv* reconPic = master.m_frame->m_reconPic;
+    const int hChromaShift = CHROMA_H_SHIFT(master.m_param->internalCsp);
+    const int vChromaShift = CHROMA_V_SHIFT(master.m_param->internalCsp);
+
+    for (;;)
+    {
+        m_lock.acquire();
+        int plane = m_jobAcquired < m_jobTotal ? m_jobAcquired++ : -1;
+        m_lock.release();
+
+        if (plane < 0)
+            break;
+
+        if (!plane)
+            updateMD5Plane(master.m_seiReconPictureDigest.m_state[0], reconPic->getLumaAddr(cuAddr),
+                           reconPic->m_picWidth, height, reconPic->m_stride);
+        else
+            updateMD5Plane(master.m_seiReconPictureDigest.m_state[plane], reconPic->getChromaAddr(plane, cuAddr),
+                           reconPic->m_picWidth >> hChromaShift, height >> vChromaShift, reconPic->m_strideC);
+    }
+}
+
+void FrameEncoder::SubstreamEscape::processTasks(int /* workerThreadId */)
+{
+    for (;;)
+    {
+        m_lock.acquire();
+        int s = m_jobAcquired < m_jobTotal ? m_jobAcquired++ : -1;
+        m_lock.release();
+
+        if (s < 0)
+            break;
+
+        master.m_escapedStreams[s].escape(master.m_outStreams[s]);
+    }
+}
+
 
 uint32_t getBsLength( int32_t code )
 {
@@ -570,8 +611,14 @@ void FrameEncoder::compressFrame()
 
     /* Get the QP for this frame from rate control. This call may block until
      * frames ahead of it in encode order have called rateControlEnd() */
+#if DETAILED_CU_STATS
+    int64_t rateControlStartTime = x265_mdate();
+#endif
     int qp = m_top->m_rateControl->rateControlStart(m_frame, &m_rce, m_top);
     m_rce.newQp = qp;
+#if DETAILED_CU_STATS
+    m_cuStats.rateControlElapsedTime += x265_mdate() - rateControlStartTime;
+#endif
 
     if (m_nr)
     {
@@ -645,6 +692,7 @@ void FrameEncoder::compressFrame()
     if (!m_outStreams)
     {
         m_outStreams = new Bitstream[numSubstreams];
+        m_escapedStreams = new EscapedSubstream[numSubstreams];
         if (!m_param->bEnableWavefront)
             m_backupStreams = new Bitstream[numSubstreams];
         m_substreamSizes = X265_MALLOC(uint32_t, numSubstreams);
@@ -1000,14 +1048,28 @@ void FrameEncoder::compressFrame()
         m_frame->m_encData->m_frameStats.avgResEnergy = (double)(m_frame->m_encData->m_frameStats.resEnergy) / m_frame->m_encData->m_frameStats.totalCtu;
     }
 
+#if DETAILED_CU_STATS
+    int64_t entropyStartTime = x265_mdate();
+#endif
     m_bs.resetBits();
     m_entropyCoder.load(m_initSliceContext);
     m_entropyCoder.setBitstream(&m_bs);
 
     // finish encode of each CTU row, only required when SAO is enabled
     if (slice->m_bUseSao)
+    {
         encodeSlice(0);
 
+        /* without SAO each row was escaped by the worker which coded it, here
+         * the idle workers of this frame share the escaping of the rows */
+        SubstreamEscape escape(*this);
+        escape.m_jobTotal = numSubstreams;
+        if (m_pool && numSubstreams > 1)
+            escape.tryBondPeers(*this, numSubstreams - 1);
+        escape.processTasks(-1);
+        escape.waitForExit();
+    }
+
     m_entropyCoder.setBitstream(&m_bs);
 
     if (m_param->maxSlices > 1)
@@ -1032,7 +1094,7 @@ void FrameEncoder::compressFrame()
                 nextSliceRow++;
 
             // serialize each row, record final lengths in slice header
-            uint32_t maxStreamSize = m_nalList.serializeSubstreams(&m_substreamSizes[prevSliceRow], (nextSliceRow - prevSliceRow), &m_outStreams[prevSliceRow]);
+            uint32_t maxStreamSize = m_nalList.serializeSubstreams(&m_substreamSizes[prevSliceRow], (nextSliceRow - prevSliceRow), &m_escapedStreams[prevSliceRow]);
 
             // complete the slice header by writing WPP row-starts
             m_entropyCoder.setBitstream(&m_bs);
@@ -1054,7 +1116,7 @@ void FrameEncoder::compressFrame()
         m_entropyCoder.codeSliceHeader(*slice, *m_frame->m_encData, 0, 0, slice->m_sliceQp);
 
         // serialize each row, record final lengths in slice header
-        uint32_t maxStreamSize = m_nalList.serializeSubstreams(m_substreamSizes, numSubstreams, m_outStreams);
+        uint32_t maxStreamSize = m_nalList.serializeSubstreams(m_substreamSizes, numSubstreams, m_escapedStreams);
 
         // complete the slice header by writing WPP row-starts
         m_entropyCoder.setBitstream(&m_bs);
@@ -1067,6 +1129,9 @@ void FrameEncoder::compressFrame()
 
     if (m_param->decodedPictureHashSEI)
         writeTrailingSEIMessages();
+#if DETAILED_CU_STATS
+    m_cuStats.entropyElapsedTime += x265_mdate() - entropyStartTime;
+#endif
 
     uint64_t bytes = 0;
     for (uint32_t i = 0; i < m_nalList.m_numNal; i++)
@@ -1084,9 +1149,15 @@ void FrameEncoder::compressFrame()
     m_accessUnitBits = bytes << 3;
 
     int filler = 0;
+#if DETAILED_CU_STATS
+    int64_t rateControlEndTime = x265_mdate();
+#endif
     /* rateControlEnd may also block for earlier frames to call rateControlUpdateStats */
     if (m_top->m_rateControl->rateControlEnd(m_frame, m_accessUnitBits, &m_rce, &filler) < 0)
         m_top->m_aborted = true;
+#if DETAILED_CU_STATS
+    m_cuStats.rateControlElapsedTime += x265_mdate() - rateControlEndTime;
+#endif
 
     if (filler > 0)
     {
@@ -1161,6 +1232,7 @@ void FrameEncoder::compressFrame()
      * per-frame stats here, but currently we do not. */
     for (int i = 0; i < numTLD; i++)
         m_cuStats.accumulate(m_tld[i].analysis.m_stats[m_jpId], *m_param);
+    m_cuStats.countFrames++;
 #endif
 
     m_endFrameTime = x265_mdate();  
@@ -1178,25 +1250,23 @@ void FrameEncoder::initDecodedPictureHashSEI(int row, int cuAddr, int height)
 
     if (m_param->decodedPictureHashSEI == 1)
     {
-        if (!row)
-            MD5Init(&m_seiReconPictureDigest.m_state[0]);
+        const int planes = (m_param->internalCsp != X265_CSP_I400) ? 3 : 1;
 
-        updateMD5Plane(m_seiReconPictureDigest.m_state[0], reconPic->getLumaAddr(cuAddr), width, height, stride);
-        if (m_param->internalCsp != X265_CSP_I400)
+        if (!row)
         {
-            if (!row)
-            {
-                MD5Init(&m_seiReconPictureDigest.m_state[1]);
-                MD5Init(&m_seiReconPictureDigest.m_state[2]);
-            }
-
-            width >>= hChromaShift;
-            height >>= vChromaShift;
-            stride = reconPic->m_strideC;
-
-            updateMD5Plane(m_seiReconPictureDigest.m_state[1], reconPic->getCbAddr(cuAddr), width, height, stride);
-            updateMD5Plane(m_seiReconPictureDigest.m_state[2], reconPic->getCrAddr(cuAddr), width, height, stride);
+            for (int i = 0; i < planes; i++)
+                MD5Init(&m_seiReconPictureDigest.m_state[i]);
         }
+
+        /* MD5 is serial within a plane, but the planes are independent. Idle
+         * workers of this frame take the chroma planes while this thread
+         * hashes the luma */
+        PlaneHash hash(*this, cuAddr, height);
+        hash.m_jobTotal = planes;
+        if (m_pool && planes > 1)
+            hash.tryBondPeers(*this, planes - 1);
+        hash.processTasks(-1);
+        hash.waitForExit();
     }
     else if (m_param->decodedPictureHashSEI == 2)
     {
@@ -1210,7 +1280,8 @@ void FrameEncoder::initDecodedPictureHashSEI(int row, int cuAddr, int height)
             width >>= hChromaShift;
             height >>= vChromaShift;
             stride = reconPic->m_strideC;
-            m_seiReconPictureDigest.m_crc[1] = m_seiReconPictureDigest.m_crc[2] = 0xffff;
+            if (!row)
+                m_seiReconPictureDigest.m_crc[1] = m_seiReconPictureDigest.m_crc[2] = 0xffff;
 
             updateCRC(reconPic->getCbAddr(cuAddr), m_seiReconPictureDigest.m_crc[1], height, width, stride);
             updateCRC(reconPic->getCrAddr(cuAddr), m_seiReconPictureDigest.m_crc[2], height, width, stride);
@@ -1517,6 +1588,8 @@ void FrameEncoder::processRowEncoder(int intRow, ThreadLocalData& tld)
         if (m_param->dynamicRd && (int32_t)(m_rce.qpaRc - m_rce.qpNoVbv) > 0)
             ctu->m_vbvAffected = true;
 
+        int64_t ctuStartTime = curEncData.m_ctuCost ? x265_mdate() : 0;
+
         // Does all the CU analysis, returns best top level mode decision
         Mode& best = tld.analysis.compressCTU(*ctu, *m_frame, m_cuGeoms[m_ctuGeomMap[cuAddr]], rowCoder);
 
@@ -1534,6 +1607,10 @@ void FrameEncoder::processRowEncoder(int intRow, ThreadLocalData& tld)
          * if SAO is disabled, rowCoder writes the final CTU bitstream */
         rowCoder.encodeCTU(*ctu, m_cuGeoms[m_ctuGeomMap[cuAddr]]);
 
+        /* accumulated, a CTU re-encoded for VBV is charged for every pass */
+        if (curEncData.m_ctuCost)
+            curEncData.m_ctuCost[cuAddr].wallTime += (uint32_t)(x265_mdate() - ctuStartTime);
+
         if (m_param->bEnableWavefront && col == 1)
             // Save CABAC state for next row
             curRow.bufferedEntropy.loadContexts(rowCoder);
@@ -1560,6 +1637,9 @@ void FrameEncoder::processRowEncoder(int intRow, ThreadLocalData& tld)
                                                                   : m_frameFilter.m_parallelFilter[row - 2].m_lastCol.get()), (int)col);
                     }
                     m_frameFilter.m_parallelFilter[row - 1].m_allowedCol.set(allowCol);
+                    // filtering next to a slice boundary keeps to the row-wise path, the slice above may still be encoding
+                    if (m_param->maxSlices == 1)
+                        m_frameFilter.m_parallelFilter[row - 1].tryProcessColumns();
                 }
 
                 // Last Row may start early
@@ -1575,6 +1655,8 @@ void FrameEncoder::processRowEncoder(int intRow, ThreadLocalData& tld)
                                                                   : m_frameFilter.m_parallelFilter[row - 1].m_lastCol.get()), (int)col);
                     }
                     m_frameFilter.m_parallelFilter[row].m_allowedCol.set(allowCol);
+                    if (m_param->maxSlices == 1)
+                        m_frameFilter.m_parallelFilter[row].tryProcessColumns();
                 }
             } // end of !bIsVbv
         }
@@ -1629,6 +1711,8 @@ void FrameEncoder::processRowEncoder(int intRow, ThreadLocalData& tld)
         }
 
         curEncData.m_cuStat[cuAddr].totalBits = best.totalBits;
+        if (curEncData.m_ctuCost)
+            curEncData.m_ctuCost[cuAddr].totalBits = best.totalBits;
         x265_emms();
 
         if (bIsVbv)
@@ -1858,8 +1942,14 @@ void FrameEncoder::processRowEncoder(int intRow, ThreadLocalData& tld)
     /* flush row bitstream (if WPP and no SAO) or flush frame if no WPP and no SAO */
     /* end_of_sub_stream_one_bit / end_of_slice_segment_flag */
        if (!slice->m_bUseSao && (m_param->bEnableWavefront || bLastRowInSlice))
+       {
                rowCoder.finishSlice();
 
+               /* escape the finished substream here so compressFrame() only gathers rows */
+               const uint32_t subStrm = m_param->bEnableWavefront ? row : 0;
+               m_escapedStreams[subStrm].escape(m_outStreams[subStrm]);
+       }
+
 
     /* Processing left Deblock block with current threading */
     if ((m_param->bEnableLoopFilter | slice->m_bUseSao) & (rowInSlice >= 2))
@@ -193,6 +193,7 @@ public:
     ThreadLocalData*         m_tld; /* for --no-wpp */
     Bitstream*               m_outStreams;
     Bitstream*               m_backupStreams;
+    EscapedSubstream*        m_escapedStreams;
     uint32_t*                m_substreamSizes;
 
     CUGeom*                  m_cuGeoms;
@@ -220,6 +221,41 @@ public:
         WeightAnalysis operator=(const WeightAnalysis&);
     };
 
+    /* MD5 picture hash of a finished CTU row, one task per plane */
+    class PlaneHash : public BondedTaskGroup
+    {
+    public:
+
+        FrameEncoder& master;
+        int           cuAddr;
+        int           height;
+
+        PlaneHash(FrameEncoder& fe, int addr, int h) : master(fe), cuAddr(addr), height(h) {}
+
+        void processTasks(int workerThreadId);
+
+    protected:
+
+        PlaneHash operator=(const PlaneHash&);
+    };
+
+    /* emulation prevention of the substreams coded by encodeSlice(), one task
+     * per substream */
+    class SubstreamEscape : public BondedTaskGroup
+    {
+    public:
+
+        FrameEncoder& master;
+
+        SubstreamEscape(FrameEncoder& fe) : master(fe) {}
+
+        void processTasks(int workerThreadId);
+
+    protected:
+
+        SubstreamEscape operator=(const SubstreamEscape&);
+    };
+
 protected:
 
     bool initializeGeoms();
@@ -241,6 +241,7 @@ void FrameFilter::start(Frame *frame, Entropy& initState)
             m_parallelFilter[row].m_lastCol.set(0);
             m_parallelFilter[row].m_allowedCol.set(0);
             m_parallelFilter[row].m_lastDeblocked.set(-1);
+            m_parallelFilter[row].m_lastPostCol.set(0);
             m_parallelFilter[row].m_encData = frame->m_encData;
         }
 
@@ -342,6 +343,30 @@ void FrameFilter::ParallelFilter::processSaoCTU(SAOParam *saoParam, int col)
     }
 }
 
+/* extend the left and/or right picture border of a CTU row */
+static void extendRowSides(pixel* pix, intptr_t stride, int width, int height, int marginX, bool bLeft, bool bRight)
+{
+    if (bLeft & bRight)
+    {
+        primitives.extendRowBorder(pix, stride, width, height, marginX);
+        return;
+    }
+
+    for (int y = 0; y < height; y++, pix += stride)
+    {
+        if (bLeft)
+        {
+            for (int x = 1; x <= marginX; x++)
+                pix[-x] = pix[0];
+        }
+        else
+        {
+            for (int x = 0; x < marginX; x++)
+                pix[width + x] = pix[width - 1];
+        }
+    }
+}
+
 // NOTE: MUST BE delay a row when Deblock enabled, the Deblock will modify above pixels in Horizon pass
 void FrameFilter::ParallelFilter::processPostCu(int col) const
 {
@@ -372,15 +397,18 @@ void FrameFilter::ParallelFilter::processPostCu(int col) const
     int copySizeY = realW;
     int copySizeC = (realW >> hChromaShift);
 
+    // Extend only the side of this CU, the other end of the row may still be under filtering
     if ((col == 0) | (col == m_frameFilter->m_numCols - 1))
     {
-        // TODO: improve by process on Left or Right only
-        primitives.extendRowBorder(reconPic->getLumaAddr(m_rowAddr), stride, reconPic->m_picWidth, realH, reconPic->m_lumaMarginX);
+        const bool bLeft = (col == 0);
+        const bool bRight = (col == m_frameFilter->m_numCols - 1);
+
+        extendRowSides(reconPic->getLumaAddr(m_rowAddr), stride, reconPic->m_picWidth, realH, lumaMarginX, bLeft, bRight);
 
         if (m_frameFilter->m_param->internalCsp != X265_CSP_I400)
         {
-            primitives.extendRowBorder(reconPic->getCbAddr(m_rowAddr), strideC, reconPic->m_picWidth >> hChromaShift, realH >> vChromaShift, reconPic->m_chromaMarginX);
-            primitives.extendRowBorder(reconPic->getCrAddr(m_rowAddr), strideC, reconPic->m_picWidth >> hChromaShift, realH >> vChromaShift, reconPic->m_chromaMarginX);
+            extendRowSides(reconPic->getCbAddr(m_rowAddr), strideC, reconPic->m_picWidth >> hChromaShift, realH >> vChromaShift, chromaMarginX, bLeft, bRight);
+            extendRowSides(reconPic->getCrAddr(m_rowAddr), strideC, reconPic->m_picWidth >> hChromaShift, realH >> vChromaShift, chromaMarginX, bLeft, bRight);
         }
     }
 
@@ -435,6 +463,15 @@ void FrameFilter::ParallelFilter::processPostCu(int col) const
     }
 }
 
+// Filter a block of columns as soon as the encoder of the next row allows it, so deblock and SAO of a row overlap
+// with the encode of the rows below instead of running as a burst at the end of each row (or of the frame, for the
+// last row in slice). The caller must be the only thread running processTasks() of this row
+void FrameFilter::ParallelFilter::tryProcessColumns()
+{
+    if (m_allowedCol.get() - m_lastCol.get() >= MAX_PFILTER_CUS)
+        processTasks(-1);
+}
+
 // NOTE: Single Threading only
 void FrameFilter::ParallelFilter::processTasks(int /*workerThreadId*/)
 {
@@ -497,6 +534,20 @@ void FrameFilter::ParallelFilter::processTasks(int /*workerThreadId*/)
                     m_prevRow->processSaoCTU(saoParam, col - 3);
                     m_prevRow->processPostCu(col - 3);
                 }
+
+                // Last row in slice has no next row to apply its SAO, do it here one column behind the previous row,
+                // whose SAO reads the not yet SAO'd below-left pixels
+                if (ctu->m_bLastRowInSlice && col >= 4)
+                {
+                    processSaoCTU(saoParam, col - 4);
+                    processPostCu(col - 4);
+                    m_lastPostCol.set(col - 3);
+                }
+            }
+            else if (ctu->m_bLastRowInSlice && m_frameFilter->m_param->bEnableLoopFilter)
+            {
+                processPostCu(col - 1);
+                m_lastPostCol.set(col);
             }
 
             m_lastDeblocked.set(col);
@@ -595,10 +646,12 @@ void FrameFilter::processRow(int row)
             if ((!ctu->m_bFirstRowInSlice) && (m_parallelFilter[row - 1].m_lastDeblocked.get() != m_numCols))
                 x265_log(m_param, X265_LOG_WARNING, "detected ParallelFilter race condition on last row\n");
 
-            /* Apply SAO on last row of CUs, because we always apply SAO on row[X-1] */
+            /* Apply SAO on last row of CUs, because we always apply SAO on row[X-1]. The leading
+             * columns may already be finished while the row was encoding */
+            const int colStart = m_parallelFilter[row].m_lastPostCol.get();
             if (m_useSao)
             {
-                for(int col = 0; col < m_numCols; col++)
+                for(int col = colStart; col < m_numCols; col++)
                 {
                     // NOTE: must use processSaoUnitCu(), it include TQBypass logic
                     m_parallelFilter[row].processSaoCTU(saoParam, col);
@@ -606,7 +659,7 @@ void FrameFilter::processRow(int row)
             }
 
             // Process border extension on last row
-            for(int col = 0; col < m_numCols; col++)
+            for(int col = colStart; col < m_numCols; col++)
             {
                 // m_reconColCount will be set in processPostCu()
                 m_parallelFilter[row].processPostCu(col);
@@ -76,6 +76,7 @@ public:
         ThreadSafeInteger   m_lastCol;          /* The column that next to process */
         ThreadSafeInteger   m_allowedCol;       /* The column that processed from Encode pipeline */
         ThreadSafeInteger   m_lastDeblocked;   /* The column that finished all of Deblock stages  */
+        ThreadSafeInteger   m_lastPostCol;     /* The column that next to SAO and border extend, last row in slice only */
 
         ParallelFilter()
             : m_rowHeight(0)
@@ -92,6 +93,9 @@ public:
 
         void processTasks(int workerThreadId);
 
+        // Run the filter tasks of a column block once it is allowed, called by the encoder of the next row
+        void tryProcessColumns();
+
         // Apply SAO on a CU in current row
         void processSaoCTU(SAOParam *saoParam, int col);
 
@@ -23,6 +23,7 @@
 *****************************************************************************/
 
 #include "common.h"
+#include "primitives.h"
 #include "bitstream.h"
 #include "nal.h"
 
@@ -33,9 +34,9 @@ NALList::NALList()
     , m_buffer(NULL)
     , m_occupancy(0)
     , m_allocSize(0)
-    , m_extraBuffer(NULL)
+    , m_extraStreams(NULL)
+    , m_numExtraStreams(0)
     , m_extraOccupancy(0)
-    , m_extraAllocSize(0)
     , m_annexB(true)
 {}
 
@@ -116,32 +117,30 @@ void NALList::serialize(NalUnitType nalUnitType, const Bitstream& bs)
     out[bytes++] = (uint8_t)nalUnitType << 1;
     out[bytes++] = 1 + (nalUnitType == NAL_UNIT_CODED_SLICE_TSA_N);
 
-    /* 7.4.1 ...
-     * Within the NAL unit, the following three-byte sequences shall not occur at
-     * any byte-aligned position:
-     *  - 0x000000
-     *  - 0x000001
-     *  - 0x000002 */
-    for (uint32_t i = 0; i < payloadSize; i++)
+    /* the NAL header never ends in a zero byte, so the payload is escaped as
+     * if it started the NAL */
+    if (nalUnitType != NAL_UNIT_UNSPECIFIED)
+        bytes += primitives.nalEscape(out + bytes, bpayload, payloadSize);
+    else
     {
-        if (i > 2 && !out[bytes - 2] && !out[bytes - 3] && out[bytes - 1] <= 0x03 && nalUnitType != NAL_UNIT_UNSPECIFIED)
-        {
-            /* inject 0x03 to prevent emulating a start code */
-            out[bytes] = out[bytes - 1];
-            out[bytes - 1] = 0x03;
-            bytes++;
-        }
-
-        out[bytes++] = bpayload[i];
+        memcpy(out + bytes, bpayload, payloadSize);
+        bytes += payloadSize;
     }
 
     X265_CHECK(bytes <= 4 + 2 + payloadSize + (payloadSize >> 1), "NAL buffer overflow\n");
 
-    if (m_extraOccupancy)
+    if (m_numExtraStreams)
     {
-        /* these bytes were escaped by serializeSubstreams */
-        memcpy(out + bytes, m_extraBuffer, m_extraOccupancy);
-        bytes += m_extraOccupancy;
+        /* these rows were escaped by the workers which coded them, the
+         * x265_nal payload must be contiguous so they are gathered here */
+        for (uint32_t s = 0; s < m_numExtraStreams; s++)
+        {
+            memcpy(out + bytes, m_extraStreams[s].buf, m_extraStreams[s].size);
+            bytes += m_extraStreams[s].size;
+        }
+
+        m_extraStreams = NULL;
+        m_numExtraStreams = 0;
         m_extraOccupancy = 0;
     }
 
@@ -171,63 +170,60 @@ void NALList::serialize(NalUnitType nalUnitType, const Bitstream& bs)
     nal.payload = out;
 }
 
-/* concatenate and escape WPP sub-streams, return escaped row lengths.
- * These streams will be appended to the next serialized NAL */
-uint32_t NALList::serializeSubstreams(uint32_t* streamSizeBytes, uint32_t streamCount, const Bitstream* streams)
+/* apply emulation prevention to one coded substream. A substream always ends
+ * with the byte aligned end_of_sub_stream_one_bit or rbsp_slice_segment_trailing_bits,
+ * so no start code can span two of them and each is escaped independently */
+void EscapedSubstream::escape(const Bitstream& stream)
 {
-    uint32_t maxStreamSize = 0;
-    uint32_t estSize = 0;
-    for (uint32_t s = 0; s < streamCount; s++)
-        estSize += streams[s].getNumberOfWrittenBytes();
-    estSize += estSize >> 1;
+    uint32_t inSize = stream.getNumberOfWrittenBytes();
+    const uint8_t *inBytes = stream.getFIFO();
+
+    size = 0;
+    if (!inBytes || !inSize)
+        return;
+
+    X265_CHECK(inBytes[inSize - 1], "substream must end byte aligned\n");
 
-    if (estSize > m_extraAllocSize)
+    uint32_t estSize = inSize + (inSize >> 1);
+    if (estSize > allocSize)
     {
         uint8_t *temp = X265_MALLOC(uint8_t, estSize);
-        if (temp)
+        if (!temp)
         {
-            X265_FREE(m_extraBuffer);
-            m_extraBuffer = temp;
-            m_extraAllocSize = estSize;
-        }
-        else
-        {
-            x265_log(NULL, X265_LOG_ERROR, "Unable to realloc WPP substream concatenation buffer\n");
-            return 0;
+            x265_log(NULL, X265_LOG_ERROR, "Unable to realloc WPP substream escape buffer\n");
+            return;
         }
+
+        X265_FREE(buf);
+        buf = temp;
+        allocSize = estSize;
     }
 
+    size = primitives.nalEscape(buf, inBytes, inSize);
+}
+
+/* record the escaped row lengths and return the largest entry point offset.
+ * The streams are gathered into the next serialized NAL, so they must not be
+ * modified until then */
+uint32_t NALList::serializeSubstreams(uint32_t* streamSizeBytes, uint32_t streamCount, const EscapedSubstream* streams)
+{
+    uint32_t maxStreamSize = 0;
     uint32_t bytes = 0;
-    uint8_t *out = m_extraBuffer;
+
     for (uint32_t s = 0; s < streamCount; s++)
     {
-        const Bitstream& stream = streams[s];
-        uint32_t inSize = stream.getNumberOfWrittenBytes();
-        const uint8_t *inBytes = stream.getFIFO();
-        uint32_t prevBufSize = bytes;
-
-        if (inBytes)
-        {
-            for (uint32_t i = 0; i < inSize; i++)
-            {
-                if (bytes >= 2 && !out[bytes - 2] && !out[bytes - 1] && inBytes[i] <= 0x03)
-                {
-                    /* inject 0x03 to prevent emulating a start code */
-                    out[bytes++] = 3;
-                }
-
-                out[bytes++] = inBytes[i];
-            }
-        }
+        bytes += streams[s].size;
 
         if (s < streamCount - 1)
         {
-            streamSizeBytes[s] = bytes - prevBufSize;
+            streamSizeBytes[s] = streams[s].size;
             if (streamSizeBytes[s] > maxStreamSize)
                 maxStreamSize = streamSizeBytes[s];
         }
     }
 
+    m_extraStreams = streams;
+    m_numExtraStreams = streamCount;
     m_extraOccupancy = bytes;
     return maxStreamSize;
 }
@@ -32,6 +32,21 @@ namespace X265_NS {
 
 class Bitstream;
 
+/* A WPP substream (or the slice data without WPP) with emulation prevention
+ * already applied. Each is escaped by the worker which finished coding it, so
+ * the frame encoder only gathers the escaped rows into the slice NAL */
+struct EscapedSubstream
+{
+    uint8_t*    buf;
+    uint32_t    size;
+    uint32_t    allocSize;
+
+    EscapedSubstream() : buf(NULL), size(0), allocSize(0) {}
+    ~EscapedSubstream() { X265_FREE(buf); }
+
+    void escape(const Bitstream& stream);
+};
+
 class NALList
 {
 public:
@@ -46,19 +61,19 @@ public:
     uint32_t    m_occupancy;
     uint32_t    m_allocSize;
 
-    uint8_t*    m_extraBuffer;
+    const EscapedSubstream* m_extraStreams;
+    uint32_t    m_numExtraStreams;
     uint32_t    m_extraOccupancy;
-    uint32_t    m_extraAllocSize;
     bool        m_annexB;
 
     NALList();
-    ~NALList() { X265_FREE(m_buffer); X265_FREE(m_extraBuffer); }
+    ~NALList() { X265_FREE(m_buffer); }
 
     void takeContents(NALList& other);
 
     void serialize(NalUnitType nalUnitType, const Bitstream& bs);
 
-    uint32_t serializeSubstreams(uint32_t* streamSizeBytes, uint32_t streamCount, const Bitstream* streams);
+    uint32_t serializeSubstreams(uint32_t* streamSizeBytes, uint32_t streamCount, const EscapedSubstream* streams);
 };
 
 }
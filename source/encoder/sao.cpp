@@ -1446,36 +1446,6 @@ inline int64_t SAO::calcSaoRdoCost(int64_t distortion, uint32_t bits, int64_t la
         return distortion + ((bits * lambda + 128) >> 8);
 }
 
-void SAO::estIterOffset(int typeIdx, int64_t lambda, int32_t count, int32_t offsetOrg, int32_t& offset, int32_t& distClasses, int64_t& costClasses)
-{
-    int bestOffset = 0;
-    distClasses    = 0;
-
-    // Assuming sending quantized value 0 results in zero offset and sending the value zero needs 1 bit.
-    // entropy coder can be used to measure the exact rate here.
-    int64_t bestCost = calcSaoRdoCost(0, 1, lambda);
-    while (offset != 0)
-    {
-        // Calculate the bits required for signalling the offset
-        uint32_t rate = (typeIdx == SAO_BO) ? (abs(offset) + 2) : (abs(offset) + 1);
-        if (abs(offset) == OFFSET_THRESH - 1)
-            rate--;
-
-        // Do the dequntization before distorion calculation
-        int64_t dist = estSaoDist(count, offset << SAO_BIT_INC, offsetOrg);
-        int64_t cost  = calcSaoRdoCost(dist, rate, lambda);
-        if (cost < bestCost)
-        {
-            bestCost = cost;
-            bestOffset = offset;
-            distClasses = (int)dist;
-        }
-        offset = (offset > 0) ? (offset - 1) : (offset + 1);
-    }
-
-    costClasses = bestCost;
-    offset = bestOffset;
-}
 void SAO::saoLumaComponentParamDist(SAOParam* saoParam, int32_t addr, int64_t& rateDist, int64_t* lambda, int64_t &bestCost)
 {
     Slice* slice = m_frame->m_encData->m_slice;
@@ -1506,17 +1476,13 @@ void SAO::saoLumaComponentParamDist(SAOParam* saoParam, int32_t addr, int64_t& r
     //EO distortion calculation
     for (int typeIdx = 0; typeIdx < maxSaoType; typeIdx++)
     {
+        primitives.saoEstOffsets(m_count[0][typeIdx] + 1, m_offsetOrg[0][typeIdx] + 1, m_offset[0][typeIdx] + 1,
+                                 distClasses + 1, costClasses + 1, SAO_NUM_OFFSET, 0, lambda[0]);
+
+        //Calculate distortion
         int64_t estDist = 0;
         for (int classIdx = 1; classIdx < SAO_NUM_OFFSET + 1; classIdx++)
-        {
-            int32_t&  count    = m_count[0][typeIdx][classIdx];
-            int32_t& offsetOrg = m_offsetOrg[0][typeIdx][classIdx];
-            int32_t& offsetOut = m_offset[0][typeIdx][classIdx];
-            estIterOffset(typeIdx, lambda[0], count, offsetOrg, offsetOut, distClasses[classIdx], costClasses[classIdx]);
-
-            //Calculate distortion
             estDist += distClasses[classIdx];
-        }
 
         m_entropyCoder.load(m_rdContexts.temp);
         m_entropyCoder.resetBits();
@@ -1542,15 +1508,8 @@ void SAO::saoLumaComponentParamDist(SAOParam* saoParam, int32_t addr, int64_t& r
     }
 
     //BO RDO
-    int64_t estDist = 0;
-    for (int classIdx = 0; classIdx < MAX_NUM_SAO_CLASS; classIdx++)
-    {
-        int32_t&  count    = m_count[0][SAO_BO][classIdx];
-        int32_t& offsetOrg = m_offsetOrg[0][SAO_BO][classIdx];
-        int32_t& offsetOut = m_offset[0][SAO_BO][classIdx];
-
-        estIterOffset(SAO_BO, lambda[0], count, offsetOrg, offsetOut, distClasses[classIdx], costClasses[classIdx]);
-    }
+    primitives.saoEstOffsets(m_count[0][SAO_BO], m_offsetOrg[0][SAO_BO], m_offset[0][SAO_BO],
+                             distClasses, costClasses, MAX_NUM_SAO_CLASS, 1, lambda[0]);
 
     // Estimate Best Position
     int32_t bestClassBO  = 0;
@@ -1572,7 +1531,7 @@ void SAO::saoLumaComponentParamDist(SAOParam* saoParam, int32_t addr, int64_t& r
         }
     }
 
-    estDist = 0;
+    int64_t estDist = 0;
     for (int classIdx = bestClassBO; classIdx < bestClassBO + SAO_NUM_OFFSET; classIdx++)
         estDist += distClasses[classIdx];
 
@@ -1639,16 +1598,11 @@ void SAO::saoChromaComponentParamDist(SAOParam* saoParam, int32_t addr, int64_t&
         int64_t estDist[2] = {0, 0};
         for (int compIdx = 1; compIdx < 3; compIdx++)
         {
-            for (int classIdx = 1; classIdx < SAO_NUM_OFFSET + 1; classIdx++)
-            {
-                int32_t& count = m_count[compIdx][typeIdx][classIdx];
-                int32_t& offsetOrg = m_offsetOrg[compIdx][typeIdx][classIdx];
-                int32_t& offsetOut = m_offset[compIdx][typeIdx][classIdx];
-
-                estIterOffset(typeIdx, lambda[1], count, offsetOrg, offsetOut, distClasses[classIdx], costClasses[classIdx]);
+            primitives.saoEstOffsets(m_count[compIdx][typeIdx] + 1, m_offsetOrg[compIdx][typeIdx] + 1, m_offset[compIdx][typeIdx] + 1,
+                                     distClasses + 1, costClasses + 1, SAO_NUM_OFFSET, 0, lambda[1]);
 
+            for (int classIdx = 1; classIdx < SAO_NUM_OFFSET + 1; classIdx++)
                 estDist[compIdx - 1] += distClasses[classIdx];
-            }
         }
 
         m_entropyCoder.load(m_rdContexts.temp);
@@ -1688,14 +1642,8 @@ void SAO::saoChromaComponentParamDist(SAOParam* saoParam, int32_t addr, int64_t&
     {
         int64_t bestRDCostBO = MAX_INT64;
 
-        for (int classIdx = 0; classIdx < MAX_NUM_SAO_CLASS; classIdx++)
-        {
-            int32_t&  count = m_count[compIdx][SAO_BO][classIdx];
-            int32_t& offsetOrg = m_offsetOrg[compIdx][SAO_BO][classIdx];
-            int32_t& offsetOut = m_offset[compIdx][SAO_BO][classIdx];
-
-            estIterOffset(SAO_BO, lambda[1], count, offsetOrg, offsetOut, distClasses[classIdx], costClasses[classIdx]);
-        }
+        primitives.saoEstOffsets(m_count[compIdx][SAO_BO], m_offsetOrg[compIdx][SAO_BO], m_offset[compIdx][SAO_BO],
+                                 distClasses, costClasses, MAX_NUM_SAO_CLASS, 1, lambda[1]);
 
         for (int i = 0; i < MAX_NUM_SAO_CLASS - SAO_NUM_OFFSET + 1; i++)
         {
@@ -1924,6 +1872,44 @@ void saoCuStatsE3_c(const int16_t *diff, const pixel *rec, intptr_t stride, int8
     }
 }
 
+/* RD search of the offset of each class, walking from the initial offset towards zero */
+void saoEstOffsets_c(const int32_t *count, const int32_t *offsetOrg, int32_t *offset, int32_t *distClasses, int64_t *costClasses, int numClasses, int bBandOffset, int64_t lambda)
+{
+    // Assuming sending quantized value 0 results in zero offset and sending the value zero needs 1 bit.
+    // entropy coder can be used to measure the exact rate here.
+    const int64_t zeroCost = (lambda + 128) >> 8;
+
+    for (int classIdx = 0; classIdx < numClasses; classIdx++)
+    {
+        int32_t curOffset = offset[classIdx];
+        int32_t bestOffset = 0;
+        int64_t bestCost = zeroCost;
+        distClasses[classIdx] = 0;
+
+        while (curOffset != 0)
+        {
+            // Calculate the bits required for signalling the offset
+            uint32_t rate = bBandOffset ? (abs(curOffset) + 2) : (abs(curOffset) + 1);
+            if (abs(curOffset) == SAO::OFFSET_THRESH - 1)
+                rate--;
+
+            // Do the dequntization before distorion calculation
+            int64_t dist = estSaoDist(count[classIdx], curOffset << SAO::SAO_BIT_INC, offsetOrg[classIdx]);
+            int64_t cost = dist + ((rate * lambda + 128) >> 8);
+            if (cost < bestCost)
+            {
+                bestCost = cost;
+                bestOffset = curOffset;
+                distClasses[classIdx] = (int)dist;
+            }
+            curOffset = (curOffset > 0) ? (curOffset - 1) : (curOffset + 1);
+        }
+
+        costClasses[classIdx] = bestCost;
+        offset[classIdx] = bestOffset;
+    }
+}
+
 void setupSaoPrimitives_c(EncoderPrimitives &p)
 {
     // TODO: move other sao functions to here
@@ -1932,6 +1918,7 @@ void setupSaoPrimitives_c(EncoderPrimitives &p)
     p.saoCuStatsE1 = saoCuStatsE1_c;
     p.saoCuStatsE2 = saoCuStatsE2_c;
     p.saoCuStatsE3 = saoCuStatsE3_c;
+    p.saoEstOffsets = saoEstOffsets_c;
 }
 }
 
@@ -1236,6 +1236,7 @@ void Search::residualQTIntraChroma(Mode& mode, const CUGeom& cuGeom, uint32_t ab
 void Search::checkIntra(Mode& intraMode, const CUGeom& cuGeom, PartSize partSize)
 {
     CUData& cu = intraMode.cu;
+    CTUCostCounter(cu, rdEvals);
 
     cu.setPartSizeSubParts(partSize);
     cu.setPredModeSubParts(MODE_INTRA);
@@ -1454,6 +1455,7 @@ void Search::checkIntraInInter(Mode& intraMode, const CUGeom& cuGeom)
 void Search::encodeIntraInInter(Mode& intraMode, const CUGeom& cuGeom)
 {
     ProfileCUScope(intraMode.cu, intraRDOElapsedTime[cuGeom.depth], countIntraRDO[cuGeom.depth]);
+    CTUCostCounter(intraMode.cu, rdEvals);
 
     CUData& cu = intraMode.cu;
     Yuv* reconYuv = &intraMode.reconYuv;
@@ -1586,7 +1588,27 @@ sse_t Search::estIntraPredQT(Mode &intraMode, const CUGeom& cuGeom, const uint32
                 COPY1_IF_LT(bcost, modeCosts[PLANAR_IDX]);
 
                 // angular predictions
-                if (primitives.cu[sizeIdx].intra_pred_allangs)
+                if (m_param->intraGradModes && primitives.cu[sizeIdx].intra_grad_hist)
+                {
+                    /* measure only the angles favoured by the edge-orientation
+                     * histogram of the source block, plus the MPMs */
+                    uint64_t gradModes = getIntraGradModes(fenc, scaleStride, sizeIdx) | mpms;
+                    for (int mode = 2; mode < 35; mode++)
+                    {
+                        if (!(gradModes & ((uint64_t)1 << mode)))
+                        {
+                            modeCosts[mode] = MAX_INT64;
+                            continue;
+                        }
+                        bits = (mpms & ((uint64_t)1 << mode)) ? m_entropyCoder.bitsIntraModeMPM(mpmModes, mode) : rbits;
+                        int filter = !!(g_intraFilterFlags[mode] & scaleTuSize);
+                        primitives.cu[sizeIdx].intra_pred[mode](m_intraPred, scaleTuSize, intraNeighbourBuf[filter], mode, scaleTuSize <= 16);
+                        sad = sa8d(fenc, scaleStride, m_intraPred, scaleTuSize) << costShift;
+                        modeCosts[mode] = m_rdCost.calcRdSADCost(sad, bits);
+                        COPY1_IF_LT(bcost, modeCosts[mode]);
+                    }
+                }
+                else if (primitives.cu[sizeIdx].intra_pred_allangs)
                 {
                     primitives.cu[sizeIdx].transpose(m_fencTransposed, fenc, scaleStride);
                     primitives.cu[sizeIdx].intra_pred_allangs(m_intraPredAngs, intraNeighbourBuf[0], intraNeighbourBuf[1], (scaleTuSize <= 16));
@@ -1636,6 +1658,7 @@ sse_t Search::estIntraPredQT(Mode &intraMode, const CUGeom& cuGeom, const uint32
                     break;
 
                 ProfileCUScope(intraMode.cu, intraRDOElapsedTime[cuGeom.depth], countIntraRDO[cuGeom.depth]);
+                CTUCostCounter(cu, rdEvals);
 
                 m_entropyCoder.load(m_rqt[depth].cur);
                 cu.setLumaIntraDirSubParts(rdModeList[i], absPartIdx, depth + initTuDepth);
@@ -1650,6 +1673,7 @@ sse_t Search::estIntraPredQT(Mode &intraMode, const CUGeom& cuGeom, const uint32
         }
 
         ProfileCUScope(intraMode.cu, intraRDOElapsedTime[cuGeom.depth], countIntraRDO[cuGeom.depth]);
+        CTUCostCounter(cu, rdEvals);
 
         /* remeasure best mode, allowing TU splits */
         cu.setLumaIntraDirSubParts(bmode, absPartIdx, depth + initTuDepth);
@@ -2110,6 +2134,7 @@ void Search::singleMotionEstimation(Search& master, Mode& interMode, const Predi
 
     setSearchRange(interMode.cu, mvp, m_param->searchRange, mvmin, mvmax);
 
+    CTUCostCounter(interMode.cu, meSearches);
     int satdCost = m_me.motionEstimate(&m_slice->m_mref[list][ref], mvmin, mvmax, mvp, numMvc, mvc, m_param->searchRange, outmv, m_param->maxSlices, 
       m_param->bSourceReferenceEstimation ? m_slice->m_refFrameList[list][ref]->m_fencPic->getLumaAddr(0) : 0);
 
@@ -2117,6 +2142,7 @@ void Search::singleMotionEstimation(Search& master, Mode& interMode, const Predi
     {
         MV outmv_lowres;
         setSearchRange(interMode.cu, mvp_lowres, m_param->searchRange, mvmin, mvmax);
+        CTUCostCounter(interMode.cu, meSearches);
         int lowresMvCost = m_me.motionEstimate(&m_slice->m_mref[list][ref], mvmin, mvmax, mvp_lowres, numMvc, mvc, m_param->searchRange, outmv_lowres, m_param->maxSlices,
             m_param->bSourceReferenceEstimation ? m_slice->m_refFrameList[list][ref]->m_fencPic->getLumaAddr(0) : 0);
         if (lowresMvCost < satdCost)
@@ -2168,6 +2194,7 @@ void Search::searchMV(Mode& interMode, int list, int ref, MV& outmv, MV mvp[3],
         mv = mvp[cand++];
         cu.clipMv(mv);
         setSearchRange(cu, mv, m_param->searchRange, mvmin, mvmax);
+        CTUCostCounter(cu, meSearches);
         int cost = m_me.motionEstimate(&m_slice->m_mref[list][ref], mvmin, mvmax, mv, numMvc, mvc, m_param->searchRange, bestMV, m_param->maxSlices,
         m_param->bSourceReferenceEstimation ? m_slice->m_refFrameList[list][ref]->m_fencPic->getLumaAddr(0) : 0);
         if (bestcost > cost)
@@ -2288,6 +2315,7 @@ void Search::predInterSearch(Mode& interMode, const CUGeom& cuGeom, bool bChroma
                         if (cand && (mvpSel[cand] == mvpSel[cand - 1] || (cand == 2 && mvpSel[cand] == mvpSel[cand - 2])))
                             continue;
                         setSearchRange(cu, mvpSel[cand], m_param->searchRange, mvmin, mvmax);
+                        CTUCostCounter(cu, meSearches);
                         int bcost = m_me.motionEstimate(&m_slice->m_mref[list][ref], mvmin, mvmax, mvpSel[cand], numMvc, mvc, m_param->searchRange, bestmv, m_param->maxSlices,
                             m_param->bSourceReferenceEstimation ? m_slice->m_refFrameList[list][ref]->m_fencPic->getLumaAddr(0) : 0);
                         if (satdCost > bcost)
@@ -2302,6 +2330,7 @@ void Search::predInterSearch(Mode& interMode, const CUGeom& cuGeom, bool bChroma
                 }
                 else
                 {
+                    CTUCostCounter(cu, meSearches);
                     satdCost = m_me.motionEstimate(&slice->m_mref[list][ref], mvmin, mvmax, mvpIn, numMvc, mvc, m_param->searchRange, outmv, m_param->maxSlices,
                         m_param->bSourceReferenceEstimation ? m_slice->m_refFrameList[list][ref]->m_fencPic->getLumaAddr(0) : 0);
                 }
@@ -2426,6 +2455,7 @@ void Search::predInterSearch(Mode& interMode, const CUGeom& cuGeom, bool bChroma
                             m_me.integral[planes] = interMode.fencYuv->m_integral[list][ref][planes] + puX * pu.width + puY * pu.height * m_slice->m_refFrameList[list][ref]->m_reconPic->m_stride;
                     }
                     setSearchRange(cu, mvp, m_param->searchRange, mvmin, mvmax);
+                    CTUCostCounter(cu, meSearches);
                     int satdCost = m_me.motionEstimate(&slice->m_mref[list][ref], mvmin, mvmax, mvp, numMvc, mvc, m_param->searchRange, outmv, m_param->maxSlices, 
                       m_param->bSourceReferenceEstimation ? m_slice->m_refFrameList[list][ref]->m_fencPic->getLumaAddr(0) : 0);
 
@@ -2433,6 +2463,7 @@ void Search::predInterSearch(Mode& interMode, const CUGeom& cuGeom, bool bChroma
                     {
                         MV outmv_lowres;
                         setSearchRange(cu, mvp_lowres, m_param->searchRange, mvmin, mvmax);
+                        CTUCostCounter(cu, meSearches);
                         int lowresMvCost = m_me.motionEstimate(&slice->m_mref[list][ref], mvmin, mvmax, mvp_lowres, numMvc, mvc, m_param->searchRange, outmv_lowres, m_param->maxSlices,
                             m_param->bSourceReferenceEstimation ? m_slice->m_refFrameList[list][ref]->m_fencPic->getLumaAddr(0) : 0);
                         if (lowresMvCost < satdCost)
@@ -2771,6 +2802,7 @@ void Search::setSearchRange(const CUData& cu, const MV& mvp, int merange, MV& mv
 void Search::encodeResAndCalcRdSkipCU(Mode& interMode)
 {
     CUData& cu = interMode.cu;
+    CTUCostCounter(cu, rdEvals);
     Yuv* reconYuv = &interMode.reconYuv;
     const Yuv* fencYuv = interMode.fencYuv;
     Yuv* predYuv = &interMode.predYuv;
@@ -2822,6 +2854,7 @@ void Search::encodeResAndCalcRdSkipCU(Mode& interMode)
 void Search::encodeResAndCalcRdInterCU(Mode& interMode, const CUGeom& cuGeom)
 {
     ProfileCUScope(interMode.cu, interRDOElapsedTime[cuGeom.depth], countInterRDO[cuGeom.depth]);
+    CTUCostCounter(interMode.cu, rdEvals);
 
     CUData& cu = interMode.cu;
     Yuv* reconYuv = &interMode.reconYuv;
@@ -2974,6 +3007,26 @@ void Search::encodeResAndCalcRdInterCU(Mode& interMode, const CUGeom& cuGeom)
     checkDQP(interMode, cuGeom);
 }
 
+uint32_t Search::transformQuantInter(const CUData& cu, const pixel* fenc, uint32_t fencStride, const int16_t* resi, uint32_t resiStride,
+                                     coeff_t* coeff, uint32_t log2TrSize, TextType ttype, uint32_t absPartIdx)
+{
+    if (m_param->bEnableZeroBlockSkip)
+    {
+        ProfileCounter(cu, countZeroBlockChecks);
+        uint32_t sad = primitives.cu[log2TrSize - 2].sad_s(resi, resiStride);
+        if (m_quant.isZeroBlock(cu, sad, log2TrSize, ttype, absPartIdx))
+        {
+            X265_CHECK(!m_quant.transformNxN(cu, fenc, fencStride, resi, resiStride, coeff, log2TrSize, ttype, absPartIdx, false),
+                       "zero block predicted for a block with coded coefficients\n");
+            ProfileCounter(cu, countZeroBlockSkips);
+            memset(coeff, 0, sizeof(coeff_t) << (log2TrSize * 2));
+            return 0;
+        }
+    }
+
+    return m_quant.transformNxN(cu, fenc, fencStride, resi, resiStride, coeff, log2TrSize, ttype, absPartIdx, false);
+}
+
 void Search::residualTransformQuantInter(Mode& mode, const CUGeom& cuGeom, uint32_t absPartIdx, uint32_t tuDepth, const uint32_t depthRange[2])
 {
     uint32_t depth = cuGeom.depth + tuDepth;
@@ -3017,7 +3070,7 @@ void Search::residualTransformQuantInter(Mode& mode, const CUGeom& cuGeom, uint3
         uint32_t strideResiY = resiYuv.m_size;
 
         const pixel* fenc = fencYuv->getLumaAddr(absPartIdx);
-        uint32_t numSigY = m_quant.transformNxN(cu, fenc, fencYuv->m_size, curResiY, strideResiY, coeffCurY, log2TrSize, TEXT_LUMA, absPartIdx, false);
+        uint32_t numSigY = transformQuantInter(cu, fenc, fencYuv->m_size, curResiY, strideResiY, coeffCurY, log2TrSize, TEXT_LUMA, absPartIdx);
 
         if (numSigY)
         {
@@ -3051,7 +3104,7 @@ void Search::residualTransformQuantInter(Mode& mode, const CUGeom& cuGeom, uint3
 
                 int16_t* curResiU = resiYuv.getCbAddr(absPartIdxC);
                 const pixel* fencCb = fencYuv->getCbAddr(absPartIdxC);
-                uint32_t numSigU = m_quant.transformNxN(cu, fencCb, fencYuv->m_csize, curResiU, strideResiC, coeffCurU + subTUOffset, log2TrSizeC, TEXT_CHROMA_U, absPartIdxC, false);
+                uint32_t numSigU = transformQuantInter(cu, fencCb, fencYuv->m_csize, curResiU, strideResiC, coeffCurU + subTUOffset, log2TrSizeC, TEXT_CHROMA_U, absPartIdxC);
                 if (numSigU)
                 {
                     m_quant.invtransformNxN(cu, curResiU, strideResiC, coeffCurU + subTUOffset, log2TrSizeC, TEXT_CHROMA_U, false, false, numSigU);
@@ -3065,7 +3118,7 @@ void Search::residualTransformQuantInter(Mode& mode, const CUGeom& cuGeom, uint3
 
                 int16_t* curResiV = resiYuv.getCrAddr(absPartIdxC);
                 const pixel* fencCr = fencYuv->getCrAddr(absPartIdxC);
-                uint32_t numSigV = m_quant.transformNxN(cu, fencCr, fencYuv->m_csize, curResiV, strideResiC, coeffCurV + subTUOffset, log2TrSizeC, TEXT_CHROMA_V, absPartIdxC, false);
+                uint32_t numSigV = transformQuantInter(cu, fencCr, fencYuv->m_csize, curResiV, strideResiC, coeffCurV + subTUOffset, log2TrSizeC, TEXT_CHROMA_V, absPartIdxC);
                 if (numSigV)
                 {
                     m_quant.invtransformNxN(cu, curResiV, strideResiC, coeffCurV + subTUOffset, log2TrSizeC, TEXT_CHROMA_V, false, false, numSigV);
@@ -3274,7 +3327,7 @@ void Search::estimateResidualQT(Mode& mode, const CUGeom& cuGeom, uint32_t absPa
 
         const pixel* fenc = fencYuv->getLumaAddr(absPartIdx);
         int16_t* resi = resiYuv.getLumaAddr(absPartIdx);
-        numSig[TEXT_LUMA][0] = m_quant.transformNxN(cu, fenc, fencYuv->m_size, resi, resiYuv.m_size, coeffCurY, log2TrSize, TEXT_LUMA, absPartIdx, false);
+        numSig[TEXT_LUMA][0] = transformQuantInter(cu, fenc, fencYuv->m_size, resi, resiYuv.m_size, coeffCurY, log2TrSize, TEXT_LUMA, absPartIdx);
         cbfFlag[TEXT_LUMA][0] = !!numSig[TEXT_LUMA][0];
 
         m_entropyCoder.resetBits();
@@ -3399,7 +3452,7 @@ void Search::estimateResidualQT(Mode& mode, const CUGeom& cuGeom, uint32_t absPa
 
                     fenc = fencYuv->getChromaAddr(chromaId, absPartIdxC);
                     resi = resiYuv.getChromaAddr(chromaId, absPartIdxC);
-                    numSig[chromaId][tuIterator.section] = m_quant.transformNxN(cu, fenc, fencYuv->m_csize, resi, resiYuv.m_csize, coeffCurC + subTUOffset, log2TrSizeC, (TextType)chromaId, absPartIdxC, false);
+                    numSig[chromaId][tuIterator.section] = transformQuantInter(cu, fenc, fencYuv->m_csize, resi, resiYuv.m_csize, coeffCurC + subTUOffset, log2TrSizeC, (TextType)chromaId, absPartIdxC);
                     cbfFlag[chromaId][tuIterator.section] = !!numSig[chromaId][tuIterator.section];
 
                     uint32_t latestBitCount = m_entropyCoder.getNumberOfWrittenBits();
@@ -3948,6 +4001,34 @@ uint32_t Search::getIntraRemModeBits(CUData& cu, uint32_t absPartIdx, uint32_t m
     return m_entropyCoder.bitsIntraModeNonMPM();
 }
 
+/* returns a bitmap of the m_param->intraGradModes angular modes which carry
+ * the most edge energy in the source block, as ranked by the block's Sobel
+ * edge-orientation histogram. Flat blocks return an empty map */
+uint64_t Search::getIntraGradModes(const pixel* fenc, intptr_t stride, uint32_t sizeIdx) const
+{
+    uint32_t hist[NUM_INTRA_MODE];
+    primitives.cu[sizeIdx].intra_grad_hist(fenc, stride, hist);
+
+    uint64_t modes = 0;
+    for (int i = 0; i < m_param->intraGradModes; i++)
+    {
+        uint32_t bestMode = 0, bestEnergy = 0;
+        for (uint32_t mode = 2; mode < NUM_INTRA_MODE; mode++)
+        {
+            if (hist[mode] > bestEnergy && !(modes & ((uint64_t)1 << mode)))
+            {
+                bestEnergy = hist[mode];
+                bestMode = mode;
+            }
+        }
+        if (!bestEnergy)
+            break;
+        modes |= (uint64_t)1 << bestMode;
+    }
+
+    return modes;
+}
+
 /* swap the current mode/cost with the mode with the highest cost in the
  * current candidate list, if its cost is better (maintain a top N list) */
 void Search::updateCandList(uint32_t mode, uint64_t cost, int maxCandCount, uint32_t* candModeList, uint64_t* candCostList)
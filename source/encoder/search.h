@@ -49,6 +49,11 @@
 #define ProfileCounter(cu, count)
 #endif
 
+/* credits work to the CTU of cu in the --ctu-cost-map of its frame, from
+ * whichever thread does it (pmode and pme slaves included) */
+#define CTUCostCounter(cu, count) \
+    do { if ((cu).m_encData->m_ctuCost) ATOMIC_INC(&(cu).m_encData->m_ctuCost[(cu).m_cuAddr].count); } while (0)
+
 #define NUM_SUBPART MAX_TS_SIZE * 4 // 4 sub partitions * 4 depth
 
 namespace X265_NS {
@@ -179,6 +184,8 @@ struct CUStats
     int64_t  pmodeBlockTime;                    // elapsed worker time blocked for pmode batch completion
     int64_t  weightAnalyzeTime;                 // elapsed worker time analyzing reference weights
     int64_t  totalCTUTime;                      // elapsed worker time in compressCTU (includes pmode master)
+    int64_t  entropyElapsedTime;                // elapsed frame thread time coding and serializing slices
+    int64_t  rateControlElapsedTime;            // elapsed frame thread time in rate control start and end, including waits for frame order
 
     uint32_t skippedMotionReferences[NUM_CU_DEPTH];
     uint32_t totalMotionReferences[NUM_CU_DEPTH];
@@ -194,8 +201,12 @@ struct CUStats
     uint64_t countPMEMasters;
     uint64_t countPModeTasks;
     uint64_t countPModeMasters;
+    uint64_t countPModeEarlyMasters;
     uint64_t countWeightAnalyze;
+    uint64_t countZeroBlockChecks;
+    uint64_t countZeroBlockSkips;
     uint64_t totalCTUs;
+    uint64_t countFrames;
 
     CUStats() { clear(); }
 
@@ -227,6 +238,8 @@ struct CUStats
         pmodeBlockTime += other.pmodeBlockTime;
         weightAnalyzeTime += other.weightAnalyzeTime;
         totalCTUTime += other.totalCTUTime;
+        entropyElapsedTime += other.entropyElapsedTime;
+        rateControlElapsedTime += other.rateControlElapsedTime;
 
         countIntraAnalysis += other.countIntraAnalysis;
         countMotionEstimate += other.countMotionEstimate;
@@ -235,8 +248,12 @@ struct CUStats
         countPMEMasters += other.countPMEMasters;
         countPModeTasks += other.countPModeTasks;
         countPModeMasters += other.countPModeMasters;
+        countPModeEarlyMasters += other.countPModeEarlyMasters;
         countWeightAnalyze += other.countWeightAnalyze;
+        countZeroBlockChecks += other.countZeroBlockChecks;
+        countZeroBlockSkips += other.countZeroBlockSkips;
         totalCTUs += other.totalCTUs;
+        countFrames += other.countFrames;
 
         other.clear();
     }
@@ -393,6 +410,10 @@ protected:
         Entropy rqtStore[NUM_SUBPART];
     } m_cacheTU;
 
+    // transform and quantize an inter TU, skipping both when it is certain to quantize to zero
+    uint32_t transformQuantInter(const CUData& cu, const pixel* fenc, uint32_t fencStride, const int16_t* resi, uint32_t resiStride,
+                                 coeff_t* coeff, uint32_t log2TrSize, TextType ttype, uint32_t absPartIdx);
+
     uint64_t estimateNullCbfCost(sse_t dist, uint32_t energy, uint32_t tuDepth, TextType compId);
     bool     splitTU(Mode& mode, const CUGeom& cuGeom, uint32_t absPartIdx, uint32_t tuDepth, ShortYuv& resiYuv, Cost& splitCost, const uint32_t depthRange[2], int32_t splitMore);
     void     estimateResidualQT(Mode& mode, const CUGeom& cuGeom, uint32_t absPartIdx, uint32_t depth, ShortYuv& resiYuv, Cost& costs, const uint32_t depthRange[2], int32_t splitMore = -1);
@@ -433,6 +454,7 @@ protected:
 
     // get most probable luma modes for CU part, and bit cost of all non mpm modes
     uint32_t getIntraRemModeBits(CUData & cu, uint32_t absPartIdx, uint32_t mpmModes[3], uint64_t& mpms) const;
+    uint64_t getIntraGradModes(const pixel* fenc, intptr_t stride, uint32_t sizeIdx) const;
 
     void updateModeCost(Mode& m) const { m.rdCost = m_rdCost.m_psyRd ? m_rdCost.calcPsyRdCost(m.distortion, m.totalBits, m.psyEnergy)
                                                 : (m_rdCost.m_ssimRd ? m_rdCost.calcSsimRdCost(m.distortion, m.totalBits, m.ssimEnergy) 
@@ -45,19 +45,25 @@ using namespace X265_NS;
 
 namespace {
 
-/* Compute variance to derive AC energy of each block */
-inline uint32_t acEnergyVar(Frame *curFrame, uint64_t sum_ssd, int shift, int plane)
+/* AC energy of a block from its sum and sum of squares */
+inline uint32_t varEnergy(uint64_t sum_ssd, int shift)
 {
     uint32_t sum = (uint32_t)sum_ssd;
     uint32_t ssd = (uint32_t)(sum_ssd >> 32);
 
-    curFrame->m_lowres.wp_sum[plane] += sum;
-    curFrame->m_lowres.wp_ssd[plane] += ssd;
     return ssd - ((uint64_t)sum * sum >> shift);
 }
 
-/* Find the energy of each block in Y/Cb/Cr plane */
-inline uint32_t acEnergyPlane(Frame *curFrame, pixel* src, intptr_t srcStride, int plane, int colorFormat, uint32_t qgSize)
+/* Compute variance to derive AC energy of each block */
+inline uint32_t acEnergyVar(Frame *curFrame, uint64_t sum_ssd, int shift, int plane)
+{
+    curFrame->m_lowres.wp_sum[plane] += (uint32_t)sum_ssd;
+    curFrame->m_lowres.wp_ssd[plane] += (uint32_t)(sum_ssd >> 32);
+    return varEnergy(sum_ssd, shift);
+}
+
+/* Find the variance of each block in Y/Cb/Cr plane */
+inline uint64_t blockVar(pixel* src, intptr_t srcStride, int plane, int colorFormat, uint32_t qgSize)
 {
     if ((colorFormat != X265_CSP_I444) && plane)
     {
@@ -65,24 +71,48 @@ inline uint32_t acEnergyPlane(Frame *curFrame, pixel* src, intptr_t srcStride, i
         {
             ALIGN_VAR_4(pixel, pix[4 * 4]);
             primitives.cu[BLOCK_4x4].copy_pp(pix, 4, src, srcStride);
-            return acEnergyVar(curFrame, primitives.cu[BLOCK_4x4].var(pix, 4), 4, plane);
+            return primitives.cu[BLOCK_4x4].var(pix, 4);
         }
         else
         {
             ALIGN_VAR_8(pixel, pix[8 * 8]);
             primitives.cu[BLOCK_8x8].copy_pp(pix, 8, src, srcStride);
-            return acEnergyVar(curFrame, primitives.cu[BLOCK_8x8].var(pix, 8), 6, plane);
+            return primitives.cu[BLOCK_8x8].var(pix, 8);
         }
     }
     else
     {
         if (qgSize == 8)
-            return acEnergyVar(curFrame, primitives.cu[BLOCK_8x8].var(src, srcStride), 6, plane);
+            return primitives.cu[BLOCK_8x8].var(src, srcStride);
         else
-            return acEnergyVar(curFrame, primitives.cu[BLOCK_16x16].var(src, srcStride), 8, plane);
+            return primitives.cu[BLOCK_16x16].var(src, srcStride);
     }
 }
 
+/* log2 of the number of pixels of a block in blockVar() */
+inline int blockVarShift(int plane, int colorFormat, uint32_t qgSize)
+{
+    return ((colorFormat != X265_CSP_I444) && plane ? 4 : 6) + (qgSize == 8 ? 0 : 2);
+}
+
+/* Find the energy of each block in Y/Cb/Cr plane */
+inline uint32_t acEnergyPlane(Frame *curFrame, pixel* src, intptr_t srcStride, int plane, int colorFormat, uint32_t qgSize)
+{
+    return acEnergyVar(curFrame, blockVar(src, srcStride, plane, colorFormat, qgSize), blockVarShift(plane, colorFormat, qgSize), plane);
+}
+
+/* Angle of the Sobel gradient at p, in degrees from 0 to 180 */
+inline pixel edgeAngle(const pixel* p, intptr_t stride)
+{
+    float gradientH = (float)(-3 * p[-stride - 1] + 3 * p[-stride + 1] - 10 * p[-1] + 10 * p[1] - 3 * p[stride - 1] + 3 * p[stride + 1]);
+    float gradientV = (float)(-3 * p[-stride - 1] - 10 * p[-stride] - 3 * p[-stride + 1] + 3 * p[stride - 1] + 10 * p[stride] + 3 * p[stride + 1]);
+    float radians = atan2(gradientV, gradientH);
+    float theta = (float)((radians * 180) / PI);
+    if (theta < 0)
+        theta = 180 + theta;
+    return (pixel)theta;
+}
+
 } // end anonymous namespace
 
 namespace X265_NS {
@@ -100,7 +130,7 @@ bool computeEdge(pixel* edgePic, pixel* refPic, pixel* edgeTheta, intptr_t strid
     }
     else
     {
-        float gradientH = 0, gradientV = 0, radians = 0, theta = 0;
+        float gradientH = 0, gradientV = 0;
         float gradientMagnitude = 0;
         pixel blackPixel = 0;
 
@@ -133,14 +163,7 @@ bool computeEdge(pixel* edgePic, pixel* refPic, pixel* edgeTheta, intptr_t strid
                 gradientV = (float)(-3 * refPic[topLeft] - 10 * refPic[rowOne + colTwo] - 3 * refPic[topRight] + 3 * refPic[bottomLeft] + 10 * refPic[rowThree + colTwo] + 3 * refPic[bottomRight]);
                 gradientMagnitude = sqrtf(gradientH * gradientH + gradientV * gradientV);
                 if(bcalcTheta) 
-                {
-                    edgeTheta[middle] = 0;
-                    radians = atan2(gradientV, gradientH);
-                    theta = (float)((radians * 180) / PI);
-                    if (theta < 0)
-                       theta = 180 + theta;
-                    edgeTheta[middle] = (pixel)theta;
-                }
+                    edgeTheta[middle] = edgeAngle(refPic + middle, stride);
                 edgePic[middle] = (pixel)(gradientMagnitude >= EDGE_THRESHOLD ? whitePixel : blackPixel);
             }
         }
@@ -148,110 +171,216 @@ bool computeEdge(pixel* edgePic, pixel* refPic, pixel* edgeTheta, intptr_t strid
     }
 }
 
-void edgeFilter(Frame *curFrame, x265_param* param)
+void computeSceneCutHistograms(const pixel* const planes[3], const intptr_t stride[3], int width, int height, int csp,
+                               int32_t* edgeHist, int32_t* const yuvHist[3])
 {
-    int height = curFrame->m_fencPic->m_picHeight;
-    int width = curFrame->m_fencPic->m_picWidth;
-    intptr_t stride = curFrame->m_fencPic->m_stride;
-    uint32_t numCuInHeight = (height + param->maxCUSize - 1) / param->maxCUSize;
-    int maxHeight = numCuInHeight * param->maxCUSize;
-
-    memset(curFrame->m_edgePic, 0, stride * (maxHeight + (curFrame->m_fencPic->m_lumaMarginY * 2)) * sizeof(pixel));
-    memset(curFrame->m_gaussianPic, 0, stride * (maxHeight + (curFrame->m_fencPic->m_lumaMarginY * 2)) * sizeof(pixel));
-    memset(curFrame->m_thetaPic, 0, stride * (maxHeight + (curFrame->m_fencPic->m_lumaMarginY * 2)) * sizeof(pixel));
-
-    pixel *src = (pixel*)curFrame->m_fencPic->m_picOrg[0];
-    pixel *edgePic = curFrame->m_edgePic + curFrame->m_fencPic->m_lumaMarginY * stride + curFrame->m_fencPic->m_lumaMarginX;
-    pixel *refPic = curFrame->m_gaussianPic + curFrame->m_fencPic->m_lumaMarginY * stride + curFrame->m_fencPic->m_lumaMarginX;
-    pixel *edgeTheta = curFrame->m_thetaPic + curFrame->m_fencPic->m_lumaMarginY * stride + curFrame->m_fencPic->m_lumaMarginX;
+    /* border pixels are never edges */
+    edgeHist[1] = primitives.edgeCount(planes[0], stride[0], width, height, (int)EDGE_THRESHOLD);
+    edgeHist[0] = width * height - edgeHist[1];
 
-    for (int i = 0; i < height; i++)
+    /* counting into interleaved partial histograms avoids stalls on repeated
+     * values, common in flat areas */
+    int32_t part[4][HISTOGRAM_BINS];
+    for (int i = 0; i < 3; i++)
     {
-        memcpy(edgePic, src, width * sizeof(pixel));
-        memcpy(refPic, src, width * sizeof(pixel));
-        src += stride;
-        edgePic += stride;
-        refPic += stride;
-    }
+        memset(yuvHist[i], 0, HISTOGRAM_BINS * sizeof(int32_t));
+        if (i >= x265_cli_csps[csp].planes)
+            continue;
 
-    //Applying Gaussian filter on the picture
-    src = (pixel*)curFrame->m_fencPic->m_picOrg[0];
-    refPic = curFrame->m_gaussianPic + curFrame->m_fencPic->m_lumaMarginY * stride + curFrame->m_fencPic->m_lumaMarginX;
-    edgePic = curFrame->m_edgePic + curFrame->m_fencPic->m_lumaMarginY * stride + curFrame->m_fencPic->m_lumaMarginX;
-    pixel pixelValue = 0;
+        int planeWidth = width >> x265_cli_csps[csp].width[i];
+        int planeHeight = height >> x265_cli_csps[csp].height[i];
+        const pixel* src = planes[i];
 
-    for (int rowNum = 0; rowNum < height; rowNum++)
-    {
-        for (int colNum = 0; colNum < width; colNum++)
+        memset(part, 0, sizeof(part));
+        for (int y = 0; y < planeHeight; y++, src += stride[i])
         {
-            if ((rowNum >= 2) && (colNum >= 2) && (rowNum != height - 2) && (colNum != width - 2)) //Ignoring the border pixels of the picture
+            int x = 0;
+            for (; x + 4 <= planeWidth; x += 4)
             {
-                /*  5x5 Gaussian filter
-                    [2   4   5   4   2]
-                 1  [4   9   12  9   4]
-                --- [5   12  15  12  5]
-                159 [4   9   12  9   4]
-                    [2   4   5   4   2]*/
+                part[0][src[x]]++;
+                part[1][src[x + 1]]++;
+                part[2][src[x + 2]]++;
+                part[3][src[x + 3]]++;
+            }
+            for (; x < planeWidth; x++)
+                part[0][src[x]]++;
+        }
 
-                const intptr_t rowOne = (rowNum - 2)*stride, colOne = colNum - 2;
-                const intptr_t rowTwo = (rowNum - 1)*stride, colTwo = colNum - 1;
-                const intptr_t rowThree = rowNum * stride, colThree = colNum;
-                const intptr_t rowFour = (rowNum + 1)*stride, colFour = colNum + 1;
-                const intptr_t rowFive = (rowNum + 2)*stride, colFive = colNum + 2;
-                const intptr_t index = (rowNum*stride) + colNum;
+        for (int j = 0; j < HISTOGRAM_BINS; j++)
+            yuvHist[i][j] = part[0][j] + part[1][j] + part[2][j] + part[3][j];
+    }
+}
+
+bool LookaheadTLD::allocBlockStats(x265_param* param)
+{
+    const int blockSize = param->rc.qgSize == 8 ? 8 : 16;
+    const int blocksInRow = (param->sourceWidth + blockSize - 1) / blockSize;
+    const int blocksInCol = (param->sourceHeight + blockSize - 1) / blockSize;
+
+    /* the Gaussian filtered rows of a row of blocks and the rows above and
+     * below it, followed by the edge map rows of the blocks */
+    edgeRowStride = (blocksInRow * blockSize + 31) & ~31;
+    blockStats = X265_MALLOC(BlockStats, blocksInRow * blocksInCol);
+    edgeRows = X265_MALLOC(pixel, edgeRowStride * (2 * blockSize + 2));
+
+    return blockStats && edgeRows;
+}
+
+/* Gather the variances of every quantization group block of the picture in a
+ * single pass over its rows of blocks, for the AQ, weighted prediction and
+ * frame variance analyses of calcAdaptiveQuantFrame(). With bEdge the edge
+ * statistics of aq-mode 4 are gathered in the same pass */
+void LookaheadTLD::collectBlockStats(Frame* curFrame, x265_param* param, bool bEdge)
+{
+    if (bBlockStats && (bBlockStatsEdge || !bEdge))
+        return;
 
-                pixelValue = ((2 * src[rowOne + colOne] + 4 * src[rowOne + colTwo] + 5 * src[rowOne + colThree] + 4 * src[rowOne + colFour] + 2 * src[rowOne + colFive] +
-                    4 * src[rowTwo + colOne] + 9 * src[rowTwo + colTwo] + 12 * src[rowTwo + colThree] + 9 * src[rowTwo + colFour] + 4 * src[rowTwo + colFive] +
-                    5 * src[rowThree + colOne] + 12 * src[rowThree + colTwo] + 15 * src[rowThree + colThree] + 12 * src[rowThree + colFour] + 5 * src[rowThree + colFive] +
-                    4 * src[rowFour + colOne] + 9 * src[rowFour + colTwo] + 12 * src[rowFour + colThree] + 9 * src[rowFour + colFour] + 4 * src[rowFour + colFive] +
-                    2 * src[rowFive + colOne] + 4 * src[rowFive + colTwo] + 5 * src[rowFive + colThree] + 4 * src[rowFive + colFour] + 2 * src[rowFive + colFive]) / 159);
-                refPic[index] = pixelValue;
+    PicYuv* fenc = curFrame->m_fencPic;
+    const int csp = param->internalCsp;
+    const uint32_t qgSize = param->rc.qgSize;
+    const int blockSize = qgSize == 8 ? 8 : 16;
+    const int maxCol = fenc->m_picWidth;
+    const int maxRow = fenc->m_picHeight;
+    const intptr_t stride = fenc->m_stride;
+    const intptr_t cStride = fenc->m_strideC;
+    const int hShift = CHROMA_H_SHIFT(csp);
+    const int vShift = CHROMA_V_SHIFT(csp);
+    const bool bChroma = csp != X265_CSP_I400 && fenc->m_picCsp != X265_CSP_I400;
+
+    BlockStats* stats = blockStats;
+    for (int blockY = 0; blockY < maxRow; blockY += blockSize)
+    {
+        for (int blockX = 0; blockX < maxCol; blockX += blockSize, stats++)
+        {
+            intptr_t blockOffsetLuma = blockX + (blockY * stride);
+            stats->var[0] = blockVar(fenc->m_picOrg[0] + blockOffsetLuma, stride, 0, csp, qgSize);
+            if (bChroma)
+            {
+                intptr_t blockOffsetChroma = (blockX >> hShift) + ((blockY >> vShift) * cStride);
+                stats->var[1] = blockVar(fenc->m_picOrg[1] + blockOffsetChroma, cStride, 1, csp, qgSize);
+                stats->var[2] = blockVar(fenc->m_picOrg[2] + blockOffsetChroma, cStride, 2, csp, qgSize);
             }
         }
+
+        if (bEdge)
+            collectEdgeStats(curFrame, param, blockY);
     }
+    x265_emms();
 
-    if(!computeEdge(edgePic, refPic, edgeTheta, stride, height, width, true))
-        x265_log(NULL, X265_LOG_ERROR, "Failed edge computation!");
+    bBlockStats = true;
+    bBlockStatsEdge = bEdge;
 }
 
-//Find the angle of a block by averaging the pixel angles 
-inline void findAvgAngle(const pixel* block, intptr_t stride, uint32_t size, uint32_t &angle)
+/* Build the edge map rows of the row of blocks at blockY and gather the edge
+ * density and angle of its blocks. As for the whole picture before, the edge
+ * map is the Sobel thresholded 5x5 Gaussian of the luma with the border pixels
+ * of the picture copied from the source and zero beyond it. The Gaussian rows
+ * from blockY - 1 to blockY + blockSize are kept, the last two of them are
+ * reused by the next row of blocks */
+void LookaheadTLD::collectEdgeStats(Frame* curFrame, x265_param* param, int blockY)
 {
-    int sum = 0;
-    for (uint32_t y = 0; y < size; y++)
+    PicYuv* fenc = curFrame->m_fencPic;
+    const int blockSize = param->rc.qgSize == 8 ? 8 : 16;
+    const int width = fenc->m_picWidth;
+    const int height = fenc->m_picHeight;
+    const int blocksInRow = (width + blockSize - 1) / blockSize;
+    const int lastRow = X265_MIN(blockY + blockSize, height);
+    const intptr_t srcStride = fenc->m_stride;
+    const intptr_t stride = edgeRowStride;
+    pixel* gaussian = edgeRows;
+    pixel* edges = edgeRows + (blockSize + 2) * stride;
+
+    /* gaussian row i holds picture row blockY - 1 + i */
+    int row = 0;
+    if (blockY)
+    {
+        memcpy(gaussian, gaussian + blockSize * stride, 2 * stride * sizeof(pixel));
+        row = blockY + 1;
+    }
+    for (; row <= X265_MIN(blockY + blockSize, height - 1); row++)
+    {
+        const pixel* src = fenc->m_picOrg[0] + row * srcStride;
+        pixel* dst = gaussian + (row - blockY + 1) * stride;
+        if (row < 2 || row == height - 2 || width < 3)
+            memcpy(dst, src, width * sizeof(pixel));
+        else
+        {
+            dst[0] = src[0];
+            dst[1] = src[1];
+            primitives.gaussianRow(dst + 2, src + 2, srcStride, width - 2);
+            dst[width - 2] = src[width - 2];
+        }
+    }
+
+    for (row = blockY; row < blockY + blockSize; row++)
+    {
+        pixel* dst = edges + (row - blockY) * stride;
+        if (row >= height)
+        {
+            memset(dst, 0, blocksInRow * blockSize * sizeof(pixel));
+            continue;
+        }
+
+        const pixel* src = fenc->m_picOrg[0] + row * srcStride;
+        if (!row || row == height - 1 || width < 3)
+            memcpy(dst, src, width * sizeof(pixel));
+        else
+        {
+            dst[0] = src[0];
+            primitives.edgeRow(dst + 1, gaussian + (row - blockY + 1) * stride + 1, stride, width - 2, (int)EDGE_THRESHOLD, (pixel)EDGE_THRESHOLD);
+            dst[width - 1] = src[width - 1];
+        }
+        memset(dst + width, 0, (blocksInRow * blockSize - width) * sizeof(pixel));
+    }
+
+    if (!param->bHistBasedSceneCut && param->recursionSkipMode == EDGE_BASED_RSKIP)
+        primitives.planecopy_pp_shr(edges, stride, curFrame->m_edgeBitPic + blockY * srcStride, srcStride, width, lastRow - blockY, SHIFT_TO_BITPLANE);
+
+    /* the angle of a block is the average over its pixels of the gradient
+     * angle, zero on the border of the picture. It is only used by blocks
+     * with edges */
+    const int shift = blockVarShift(0, param->internalCsp, param->rc.qgSize);
+    BlockStats* stats = blockStats + (blockY / blockSize) * blocksInRow;
+    for (int blockX = 0; blockX < width; blockX += blockSize, stats++)
     {
-        for (uint32_t x = 0; x < size; x++)
+        stats->edgeVar = blockVar(edges + blockX, stride, 0, param->internalCsp, param->rc.qgSize);
+        stats->avgAngle = 0;
+        if (!varEnergy(stats->edgeVar, shift))
+            continue;
+
+        int sum = 0;
+        const int lastCol = X265_MIN(blockX + blockSize, width - 1);
+        for (row = X265_MAX(blockY, 1); row < X265_MIN(lastRow, height - 1); row++)
         {
-            sum += block[x];
+            const pixel* g = gaussian + (row - blockY + 1) * stride;
+            for (int col = X265_MAX(blockX, 1); col < lastCol; col++)
+                sum += edgeAngle(g + col, stride);
         }
-        block += stride;
+        stats->avgAngle = sum / (blockSize * blockSize);
     }
-    angle = sum / (size*size);
 }
 
-uint32_t LookaheadTLD::edgeDensityCu(Frame* curFrame, uint32_t &avgAngle, uint32_t blockX, uint32_t blockY, uint32_t qgSize)
+/* Find the total AC energy of a block in all planes from its statistics */
+uint32_t LookaheadTLD::blockEnergy(Frame* curFrame, int blockXY, int csp, uint32_t qgSize)
 {
-    pixel *edgeImage = curFrame->m_edgePic + curFrame->m_fencPic->m_lumaMarginY * curFrame->m_fencPic->m_stride + curFrame->m_fencPic->m_lumaMarginX;
-    pixel *edgeTheta = curFrame->m_thetaPic + curFrame->m_fencPic->m_lumaMarginY * curFrame->m_fencPic->m_stride + curFrame->m_fencPic->m_lumaMarginX;
-    intptr_t srcStride = curFrame->m_fencPic->m_stride;
-    intptr_t blockOffsetLuma = blockX + (blockY * srcStride);
-    int plane = 0; // Sobel filter is applied only on Y component
+    const BlockStats& stats = blockStats[blockXY];
     uint32_t var;
 
-    if (qgSize == 8)
-    {
-        findAvgAngle(edgeTheta + blockOffsetLuma, srcStride, qgSize, avgAngle);
-        var = acEnergyVar(curFrame, primitives.cu[BLOCK_8x8].var(edgeImage + blockOffsetLuma, srcStride), 6, plane);
-    }
-    else
+    var  = acEnergyVar(curFrame, stats.var[0], blockVarShift(0, csp, qgSize), 0);
+    if (csp != X265_CSP_I400 && curFrame->m_fencPic->m_picCsp != X265_CSP_I400)
     {
-        findAvgAngle(edgeTheta + blockOffsetLuma, srcStride, 16, avgAngle);
-        var = acEnergyVar(curFrame, primitives.cu[BLOCK_16x16].var(edgeImage + blockOffsetLuma, srcStride), 8, plane);
+        var += acEnergyVar(curFrame, stats.var[1], blockVarShift(1, csp, qgSize), 1);
+        var += acEnergyVar(curFrame, stats.var[2], blockVarShift(2, csp, qgSize), 2);
     }
-    x265_emms();
     return var;
 }
 
+/* Find the AC energy of a block of the edge map */
+uint32_t LookaheadTLD::blockEdgeDensity(Frame* curFrame, int blockXY, int csp, uint32_t qgSize)
+{
+    return acEnergyVar(curFrame, blockStats[blockXY].edgeVar, blockVarShift(0, csp, qgSize), 0);
+}
+
 /* Find the total AC energy of each block in all planes */
 uint32_t LookaheadTLD::acEnergyCu(Frame* curFrame, uint32_t blockX, uint32_t blockY, int csp, uint32_t qgSize)
 {
@@ -274,22 +403,6 @@ uint32_t LookaheadTLD::acEnergyCu(Frame* curFrame, uint32_t blockX, uint32_t blo
     return var;
 }
 
-/* Find the sum of pixels of each block for luma plane */
-uint32_t LookaheadTLD::lumaSumCu(Frame* curFrame, uint32_t blockX, uint32_t blockY, uint32_t qgSize)
-{
-    intptr_t stride = curFrame->m_fencPic->m_stride;
-    intptr_t blockOffsetLuma = blockX + (blockY * stride);
-    uint64_t sum_ssd;
-
-    if (qgSize == 8)
-        sum_ssd = primitives.cu[BLOCK_8x8].var(curFrame->m_fencPic->m_picOrg[0] + blockOffsetLuma, stride);
-    else
-        sum_ssd = primitives.cu[BLOCK_16x16].var(curFrame->m_fencPic->m_picOrg[0] + blockOffsetLuma, stride);
-
-    x265_emms();
-    return (uint32_t)sum_ssd;
-}
-
 void LookaheadTLD::xPreanalyzeQp(Frame* curFrame)
 {
     const uint32_t width = curFrame->m_fencPic->m_picWidth;
@@ -462,6 +575,8 @@ void LookaheadTLD::calcAdaptiveQuantFrame(Frame *curFrame, x265_param* param)
         modeTwoConst = 11.f;
         loopIncr = 16;
     }
+    const int statsCount = ((maxCol + loopIncr - 1) / loopIncr) * ((maxRow + loopIncr - 1) / loopIncr);
+    bBlockStats = false;
 
     float* quantOffsets = curFrame->m_quantOffsets;
     for (int y = 0; y < 3; y++)
@@ -497,9 +612,9 @@ void LookaheadTLD::calcAdaptiveQuantFrame(Frame *curFrame, x265_param* param)
             /* Need variance data for weighted prediction and dynamic refinement*/
             if (param->bEnableWeightedPred || param->bEnableWeightedBiPred)
             {
-                for (int blockY = 0; blockY < maxRow; blockY += loopIncr)
-                    for (int blockX = 0; blockX < maxCol; blockX += loopIncr)
-                        acEnergyCu(curFrame, blockX, blockY, param->internalCsp, param->rc.qgSize);
+                collectBlockStats(curFrame, param, false);
+                for (int blockXY = 0; blockXY < statsCount; blockXY++)
+                    blockEnergy(curFrame, blockXY, param->internalCsp, param->rc.qgSize);
             }
         }
         else
@@ -516,15 +631,8 @@ void LookaheadTLD::calcAdaptiveQuantFrame(Frame *curFrame, x265_param* param)
                 double bias_strength = 0.f;
                 double strength = 0.f;
 
-                if (param->rc.aqMode == X265_AQ_EDGE)
-                    edgeFilter(curFrame, param);
-
-                if (param->rc.aqMode == X265_AQ_EDGE && !param->bHistBasedSceneCut && param->recursionSkipMode == EDGE_BASED_RSKIP)
-                {
-                    pixel* src = curFrame->m_edgePic + curFrame->m_fencPic->m_lumaMarginY * curFrame->m_fencPic->m_stride + curFrame->m_fencPic->m_lumaMarginX;
-                    primitives.planecopy_pp_shr(src, curFrame->m_fencPic->m_stride, curFrame->m_edgeBitPic,
-                        curFrame->m_fencPic->m_stride, curFrame->m_fencPic->m_picWidth, curFrame->m_fencPic->m_picHeight, SHIFT_TO_BITPLANE);
-                }
+                /* also writes the edge bit plane of EDGE_BASED_RSKIP */
+                collectBlockStats(curFrame, param, param->rc.aqMode == X265_AQ_EDGE);
 
                 if (param->rc.aqMode == X265_AQ_AUTO_VARIANCE || param->rc.aqMode == X265_AQ_AUTO_VARIANCE_BIASED || param->rc.aqMode == X265_AQ_EDGE)
                 {
@@ -534,10 +642,11 @@ void LookaheadTLD::calcAdaptiveQuantFrame(Frame *curFrame, x265_param* param)
                         for (int blockX = 0; blockX < maxCol; blockX += loopIncr)
                         {
                             uint32_t energy, edgeDensity, avgAngle;
-                            energy = acEnergyCu(curFrame, blockX, blockY, param->internalCsp, param->rc.qgSize);
+                            energy = blockEnergy(curFrame, blockXY, param->internalCsp, param->rc.qgSize);
                             if (param->rc.aqMode == X265_AQ_EDGE)
                             {
-                                edgeDensity = edgeDensityCu(curFrame, avgAngle, blockX, blockY, param->rc.qgSize);
+                                edgeDensity = blockEdgeDensity(curFrame, blockXY, param->internalCsp, param->rc.qgSize);
+                                avgAngle = blockStats[blockXY].avgAngle;
                                 if (edgeDensity)
                                 {
                                     qp_adj = pow(edgeDensity * bit_depth_correction + 1, 0.1);
@@ -596,13 +705,13 @@ void LookaheadTLD::calcAdaptiveQuantFrame(Frame *curFrame, x265_param* param)
                         }
                         else
                         {
-                            uint32_t energy = acEnergyCu(curFrame, blockX, blockY, param->internalCsp, param->rc.qgSize);
+                            uint32_t energy = blockEnergy(curFrame, blockXY, param->internalCsp, param->rc.qgSize);
                             qp_adj = strength * (X265_LOG2(X265_MAX(energy, 1)) - (modeOneConst + 2 * (X265_DEPTH - 8)));
                         }
 
                         if (param->bHDR10Opt)
                         {
-                            uint32_t sum = lumaSumCu(curFrame, blockX, blockY, param->rc.qgSize);
+                            uint32_t sum = (uint32_t)blockStats[blockXY].var[0];
                             uint32_t lumaAvg = sum / (loopIncr * loopIncr);
                             if (lumaAvg < 301)
                                 qp_adj += 3;
@@ -654,9 +763,9 @@ void LookaheadTLD::calcAdaptiveQuantFrame(Frame *curFrame, x265_param* param)
     {
         if (param->rc.bStatRead && param->rc.cuTree && IS_REFERENCED(curFrame))
         {
-            for (int blockY = 0; blockY < maxRow; blockY += loopIncr)
-                for (int blockX = 0; blockX < maxCol; blockX += loopIncr)
-                    acEnergyCu(curFrame, blockX, blockY, param->internalCsp, param->rc.qgSize);
+            collectBlockStats(curFrame, param, false);
+            for (int blockXY = 0; blockXY < statsCount; blockXY++)
+                blockEnergy(curFrame, blockXY, param->internalCsp, param->rc.qgSize);
         }
 
         int hShift = CHROMA_H_SHIFT(param->internalCsp);
@@ -679,12 +788,15 @@ void LookaheadTLD::calcAdaptiveQuantFrame(Frame *curFrame, x265_param* param)
     {
         uint64_t blockXY = 0, rowVariance = 0;
         curFrame->m_lowres.frameVariance = 0;
+        collectBlockStats(curFrame, param, false);
         for (int blockY = 0; blockY < maxRow; blockY += loopIncr)
         {
             for (int blockX = 0; blockX < maxCol; blockX += loopIncr)
             {
-                curFrame->m_lowres.blockVariance[blockXY] = acEnergyCu(curFrame, blockX, blockY, param->internalCsp, param->rc.qgSize);
-                rowVariance += curFrame->m_lowres.blockVariance[blockXY];
+                uint32_t energy = blockEnergy(curFrame, (int)blockXY, param->internalCsp, param->rc.qgSize);
+                if (curFrame->m_lowres.blockVariance)
+                    curFrame->m_lowres.blockVariance[blockXY] = energy;
+                rowVariance += energy;
                 blockXY++;
             }
             curFrame->m_lowres.frameVariance += (rowVariance / maxCol);
@@ -804,41 +916,6 @@ void LookaheadTLD::lowresIntraEstimate(Lowres& fenc, uint32_t qgSize)
     fenc.costEstAq[0][0] = costEstAq;
 }
 
-uint32_t LookaheadTLD::weightCostLuma(Lowres& fenc, Lowres& ref, WeightParam& wp)
-{
-    pixel *src = ref.fpelPlane[0];
-    intptr_t stride = fenc.lumaStride;
-
-    if (wp.wtPresent)
-    {
-        int offset = wp.inputOffset << (X265_DEPTH - 8);
-        int scale = wp.inputWeight;
-        int denom = wp.log2WeightDenom;
-        int round = denom ? 1 << (denom - 1) : 0;
-        int correction = IF_INTERNAL_PREC - X265_DEPTH; // intermediate interpolation depth
-        int widthHeight = (int)stride;
-
-        primitives.weight_pp(ref.buffer[0], wbuffer[0], stride, widthHeight, paddedLines,
-            scale, round << correction, denom + correction, offset);
-        src = fenc.weightedRef[fenc.frameNum - ref.frameNum].fpelPlane[0];
-    }
-
-    uint32_t cost = 0;
-    intptr_t pixoff = 0;
-    int mb = 0;
-
-    for (int y = 0; y < fenc.lines; y += 8, pixoff = y * stride)
-    {
-        for (int x = 0; x < fenc.width; x += 8, mb++, pixoff += 8)
-        {
-            int satd = primitives.pu[LUMA_8x8].satd(src + pixoff, stride, fenc.fpelPlane[0] + pixoff, stride);
-            cost += X265_MIN(satd, fenc.intraCost[mb]);
-        }
-    }
-
-    return cost;
-}
-
 bool LookaheadTLD::allocWeightedRef(Lowres& fenc)
 {
     intptr_t planesize = fenc.buffer[1] - fenc.buffer[0];
@@ -904,12 +981,6 @@ void LookaheadTLD::weightsAnalyse(Lowres& fenc, Lowres& ref)
     mindenom = wp.log2WeightDenom;
     minscale = wp.inputWeight;
 
-    origscore = minscore = weightCostLuma(fenc, ref, wp);
-
-    if (!minscore)
-        return;
-
-    unsigned int s = 0;
     int curScale = minscale;
     int curOffset = (int)(fencMean - refMean * curScale / (1 << mindenom) + 0.5f);
     if (curOffset < -128 || curOffset > 127)
@@ -921,8 +992,21 @@ void LookaheadTLD::weightsAnalyse(Lowres& fenc, Lowres& ref)
         curScale = (int)((1 << mindenom) * (fencMean - curOffset) / refMean + 0.5f);
         curScale = x265_clip3(0, 127, curScale);
     }
-    SET_WEIGHT(wp, true, curScale, mindenom, curOffset);
-    s = weightCostLuma(fenc, ref, wp);
+
+    /* the unweighted and the weighted costs are measured in one pass, the
+     * weighted band of the reference goes to wbuffer[0] */
+    WeightParam cand[2];
+    uint32_t cost[2];
+    cand[0] = wp;
+    SET_WEIGHT(cand[1], true, curScale, mindenom, curOffset);
+    weightCostBatch(cost, cand, 2, fenc.fpelPlane[0], ref.fpelPlane[0], wbuffer[0], fenc.lumaStride,
+                    fenc.width, fenc.lines, fenc.intraCost, 8);
+
+    origscore = minscore = cost[0];
+    if (!minscore)
+        return;
+
+    unsigned int s = cost[1];
     COPY4_IF_LT(minscore, s, minscale, curScale, minoff, curOffset, found, 1);
 
     /* Use a smaller denominator if possible */
@@ -983,6 +1067,8 @@ Lookahead::Lookahead(x265_param *param, ThreadPool* pool)
     m_isFadeIn = false;
     m_fadeCount = 0;
     m_fadeStart = -1;
+    m_prevVariance = -1;
+    m_prevVariancePoc = -1;
 
     /* Allow the strength to be adjusted via qcompress, since the two concepts
      * are very similar. */
@@ -1051,6 +1137,17 @@ Lookahead::Lookahead(x265_param *param, ThreadPool* pool)
 #endif
 
     memset(m_histogram, 0, sizeof(m_histogram));
+
+    /* the encoder sets the visible picture size and where histograms are computed */
+    m_bHistPreAnalysis = false;
+    m_histWidth = m_param->sourceWidth;
+    m_histHeight = m_param->sourceHeight;
+    memset(m_prevEdgeHist, 0, sizeof(m_prevEdgeHist));
+    memset(m_prevYUVHist, 0, sizeof(m_prevYUVHist));
+    m_edgeHistThreshold = m_param->edgeTransitionThreshold;
+    m_chromaHistThreshold = x265_min(m_edgeHistThreshold * 10.0, MAX_SCENECUT_THRESHOLD);
+    m_scaledEdgeThreshold = x265_min(m_edgeHistThreshold * SCENECUT_STRENGTH_FACTOR, MAX_SCENECUT_THRESHOLD);
+    m_scaledChromaThreshold = x265_min(m_chromaHistThreshold * SCENECUT_STRENGTH_FACTOR, MAX_SCENECUT_THRESHOLD);
 }
 
 #if DETAILED_CU_STATS
@@ -1073,11 +1170,15 @@ bool Lookahead::create()
 {
     int numTLD = 1 + (m_pool ? m_pool->m_numWorkers : 0);
     m_tld = new LookaheadTLD[numTLD];
+    bool ok = true;
     for (int i = 0; i < numTLD; i++)
+    {
         m_tld[i].init(m_8x8Width, m_8x8Height, m_8x8Blocks);
+        ok &= m_tld[i].allocBlockStats(m_param);
+    }
     m_scratch = X265_MALLOC(int, m_tld[0].widthInCU);
 
-    return m_tld && m_scratch;
+    return ok && m_scratch;
 }
 
 void Lookahead::stopJobs()
@@ -1195,6 +1296,72 @@ void Lookahead::setLookaheadQueue()
     m_fullQueueSize = X265_MAX(1, m_param->lookaheadDepth);
 }
 
+void Lookahead::histBasedSceneCut(const int32_t* edgeHist, int32_t* const yuvHist[3], bool bFirst,
+                                  bool& bScenecut, bool& bDup, bool& isMaxThres, bool& isHardSC)
+{
+    double minEdgeT = m_edgeHistThreshold * MIN_EDGE_FACTOR;
+    double minChromaT = minEdgeT * SCENECUT_CHROMA_FACTOR;
+    double maxEdgeT = m_edgeHistThreshold * MAX_EDGE_FACTOR;
+    double maxChromaT = maxEdgeT * SCENECUT_CHROMA_FACTOR;
+    bScenecut = false;
+
+    if (bFirst)
+    {
+        /* first frame is scenecut by default no sad computation for the same. */
+        bDup = false;
+    }
+    else
+    {
+        /* sum of absolute differences of the luma edge and chroma histogram bins,
+         * normalized by the largest possible difference */
+        int32_t edgeHistSad = abs(edgeHist[0] - m_prevEdgeHist[0]) + abs(edgeHist[1] - m_prevEdgeHist[1]);
+        double edgeSad = (double)edgeHistSad / (2 * m_histWidth * m_histHeight);
+        double maxUVSad = 0.0;
+
+        if (m_param->internalCsp != X265_CSP_I400)
+        {
+            int32_t uHistSad = 0;
+            int32_t vHistSad = 0;
+            for (int j = 0; j < HISTOGRAM_BINS; j++)
+            {
+                uHistSad += abs(yuvHist[1][j] - m_prevYUVHist[1][j]);
+                vHistSad += abs(yuvHist[2][j] - m_prevYUVHist[2][j]);
+            }
+
+            int chromaSize = (m_histWidth >> CHROMA_H_SHIFT(m_param->internalCsp)) * (m_histHeight >> CHROMA_V_SHIFT(m_param->internalCsp));
+            maxUVSad = x265_max((double)uHistSad / (2 * chromaSize), (double)vHistSad / (2 * chromaSize));
+        }
+
+        if (edgeSad == 0.0 && maxUVSad == 0.0)
+        {
+            bDup = true;
+        }
+        else if (edgeSad < minEdgeT && maxUVSad < minChromaT)
+        {
+            bScenecut = false;
+        }
+        else if (edgeSad > maxEdgeT && maxUVSad > maxChromaT)
+        {
+            bScenecut = true;
+            isMaxThres = true;
+            isHardSC = true;
+        }
+        else if (edgeSad > m_scaledEdgeThreshold || maxUVSad >= m_scaledChromaThreshold
+                 || (edgeSad > m_edgeHistThreshold && maxUVSad >= m_chromaHistThreshold))
+        {
+            bScenecut = true;
+            bDup = false;
+            if (edgeSad > m_scaledEdgeThreshold || maxUVSad >= m_scaledChromaThreshold)
+                isHardSC = true;
+        }
+    }
+
+    /* store histograms of previous frame for reference */
+    memcpy(m_prevEdgeHist, edgeHist, sizeof(m_prevEdgeHist));
+    for (int i = 0; i < 3; i++)
+        memcpy(m_prevYUVHist[i], yuvHist[i], sizeof(m_prevYUVHist[i]));
+}
+
 void Lookahead::findJob(int /*workerThreadID*/)
 {
     bool doDecide;
@@ -1394,6 +1561,16 @@ void PreLookaheadGroup::processTasks(int workerThreadID)
         if (m_lookahead.m_bAdaptiveQuant)
             tld.calcAdaptiveQuantFrame(preFrame, m_lookahead.m_param);
         tld.lowresIntraEstimate(preFrame->m_lowres, m_lookahead.m_param->rc.qgSize);
+        if (m_lookahead.m_bHistPreAnalysis)
+        {
+            /* kept with the analysis data of the frame, which --analysis-save writes */
+            PicYuv* fenc = preFrame->m_fencPic;
+            x265_analysis_data& analysis = preFrame->m_analysisData;
+            const intptr_t stride[3] = { fenc->m_stride, fenc->m_strideC, fenc->m_strideC };
+            int32_t* yuvHist[3] = { analysis.yuvHist[0], analysis.yuvHist[1], analysis.yuvHist[2] };
+            computeSceneCutHistograms(fenc->m_picOrg, stride, m_lookahead.m_histWidth, m_lookahead.m_histHeight,
+                                      fenc->m_picCsp, analysis.edgeHist, yuvHist);
+        }
         preFrame->m_lowresInit = true;
 
         m_lock.acquire();
@@ -1447,31 +1624,60 @@ void Lookahead::slicetypeDecide()
             pre.tryBondPeers(*m_pool, pre.m_jobTotal);
         pre.processTasks(-1);
         pre.waitForExit();
+
+        /* histograms are compared in input order, so scene cuts are decided
+         * once pre-analysis of the new frames is complete */
+        if (m_bHistPreAnalysis)
+        {
+            bool isClosedGopRadl = m_param->radl && (m_param->keyframeMax != m_param->keyframeMin);
+            for (int i = 0; i < pre.m_jobTotal; i++)
+            {
+                Frame* preFrame = pre.m_preframes[i];
+                x265_analysis_data& analysis = preFrame->m_analysisData;
+                int32_t* yuvHist[3] = { analysis.yuvHist[0], analysis.yuvHist[1], analysis.yuvHist[2] };
+                bool bScenecut, bDup = false, isMaxThres = false, isHardSC = false;
+
+                histBasedSceneCut(analysis.edgeHist, yuvHist, !preFrame->m_poc, bScenecut, bDup, isMaxThres, isHardSC);
+                preFrame->m_lowres.bScenecut = bScenecut;
+                preFrame->m_lowres.m_bIsMaxThres = isMaxThres;
+                if (isClosedGopRadl)
+                    preFrame->m_lowres.m_bIsHardScenecut = isHardSC;
+            }
+        }
+
+        /* the variance trend is a property of consecutive input frames, so
+         * it is recorded once as each frame enters the lookahead */
+        if (m_param->bEnableFades)
+        {
+            for (int i = 0; i < pre.m_jobTotal; i++)
+            {
+                Frame* preFrame = pre.m_preframes[i];
+                Lowres& lowres = preFrame->m_lowres;
+                lowres.bVarianceRise = m_prevVariancePoc == preFrame->m_poc - 1 && lowres.frameVariance >= m_prevVariance;
+                m_prevVariance = lowres.frameVariance;
+                m_prevVariancePoc = preFrame->m_poc;
+            }
+        }
     }
 
     if(m_param->bEnableFades)
     {
         int j, endIndex = 0, length = X265_BFRAME_MAX + 4;
-        for (j = 0; j < length; j++)
-            m_frameVariance[j] = -1;
         for (j = 0; list[j] != NULL; j++)
-            m_frameVariance[list[j]->m_poc % length] = list[j]->m_lowres.frameVariance;
-        for (int k = list[0]->m_poc % length; k <= list[j - 1]->m_poc % length; k++)
-        {
-            if (m_frameVariance[k]  == -1)
+            ;
+        /* the first frame of the list always continues a fade. The scan stops
+         * at a gap in the pocs and, as when the variances were kept in a ring
+         * of length entries, skips lists which wrap around the ring */
+        int count = list[0]->m_poc % length <= list[j - 1]->m_poc % length ? j : 0;
+        for (int k = 0; k < count; k++)
+        {
+            if (k && list[k]->m_poc != list[k - 1]->m_poc + 1)
                 break;
-            if((k > 0 && m_frameVariance[k] >= m_frameVariance[k - 1]) || 
-                (k == 0 && m_frameVariance[k] >= m_frameVariance[length - 1]))
+            if (!k || list[k]->m_lowres.bVarianceRise)
             {
                 m_isFadeIn = true;
                 if (m_fadeCount == 0 && m_fadeStart == -1)
-                {
-                    for(int temp = list[0]->m_poc; temp <= list[j - 1]->m_poc; temp++)
-                        if (k == temp % length) {
-                            m_fadeStart = temp ? temp - 1 : 0;
-                            break;
-                        }
-                }
+                    m_fadeStart = list[k]->m_poc ? list[k]->m_poc - 1 : 0;
                 m_fadeCount = list[endIndex]->m_poc > m_fadeStart ? list[endIndex]->m_poc - m_fadeStart : 0;
                 endIndex++;
             }
@@ -1492,8 +1698,6 @@ void Lookahead::slicetypeDecide()
                 m_fadeCount = 0;
                 m_fadeStart = -1;
             }
-            if (k == length - 1)
-                k = -1;
         }
     }
 
@@ -51,6 +51,21 @@ class Lookahead;
 #endif
 #define PI 3.14159265
 
+#define MAX_SCENECUT_THRESHOLD 1.0
+#define SCENECUT_STRENGTH_FACTOR 2.0
+#define MIN_EDGE_FACTOR 0.5
+#define MAX_EDGE_FACTOR 1.5
+#define SCENECUT_CHROMA_FACTOR 10.0
+
+/* Statistics of a quantization group block of the full resolution picture,
+ * the variances as returned by the var primitive */
+struct BlockStats
+{
+    uint64_t var[3];     // Y, Cb, Cr
+    uint64_t edgeVar;    // edge map, aq-mode 4
+    uint32_t avgAngle;   // of the edge gradients, aq-mode 4 blocks with edges
+};
+
 /* Thread local data for lookahead tasks */
 struct LookaheadTLD
 {
@@ -61,6 +76,14 @@ struct LookaheadTLD
     int             ncu;
     int             paddedLines;
 
+    /* block statistics of the picture in calcAdaptiveQuantFrame(), gathered
+     * once by collectBlockStats() */
+    BlockStats*     blockStats;
+    bool            bBlockStats;
+    bool            bBlockStatsEdge;
+    pixel*          edgeRows;        // Gaussian and edge map rows, aq-mode 4
+    intptr_t        edgeRowStride;
+
 #if DETAILED_CU_STATS
     int64_t         batchElapsedTime;
     int64_t         coopSliceElapsedTime;
@@ -75,6 +98,10 @@ struct LookaheadTLD
         for (int i = 0; i < 4; i++)
             wbuffer[i] = NULL;
         widthInCU = heightInCU = ncu = paddedLines = 0;
+        blockStats = NULL;
+        bBlockStats = bBlockStatsEdge = false;
+        edgeRows = NULL;
+        edgeRowStride = 0;
 
 #if DETAILED_CU_STATS
         batchElapsedTime = 0;
@@ -91,7 +118,14 @@ struct LookaheadTLD
         ncu = n;
     }
 
-    ~LookaheadTLD() { X265_FREE(wbuffer[0]); }
+    ~LookaheadTLD()
+    {
+        X265_FREE(wbuffer[0]);
+        X265_FREE(blockStats);
+        X265_FREE(edgeRows);
+    }
+
+    bool allocBlockStats(x265_param* param);
 
     void calcAdaptiveQuantFrame(Frame *curFrame, x265_param* param);
     void lowresIntraEstimate(Lowres& fenc, uint32_t qgSize);
@@ -102,9 +136,10 @@ struct LookaheadTLD
 protected:
 
     uint32_t acEnergyCu(Frame* curFrame, uint32_t blockX, uint32_t blockY, int csp, uint32_t qgSize);
-    uint32_t edgeDensityCu(Frame* curFrame, uint32_t &avgAngle, uint32_t blockX, uint32_t blockY, uint32_t qgSize);
-    uint32_t lumaSumCu(Frame* curFrame, uint32_t blockX, uint32_t blockY, uint32_t qgSize);
-    uint32_t weightCostLuma(Lowres& fenc, Lowres& ref, WeightParam& wp);
+    void     collectBlockStats(Frame* curFrame, x265_param* param, bool bEdge);
+    void     collectEdgeStats(Frame* curFrame, x265_param* param, int blockY);
+    uint32_t blockEnergy(Frame* curFrame, int blockXY, int csp, uint32_t qgSize);
+    uint32_t blockEdgeDensity(Frame* curFrame, int blockXY, int csp, uint32_t qgSize);
     bool     allocWeightedRef(Lowres& fenc);
 };
 
@@ -149,10 +184,23 @@ public:
     bool          m_isSceneTransition;
     int           m_numPools;
     bool          m_extendGopBoundary;
-    double        m_frameVariance[X265_BFRAME_MAX + 4];
+    double        m_prevVariance;        // frameVariance of the last pre-analysed frame, for --fades
+    int           m_prevVariancePoc;
     bool          m_isFadeIn;
     uint64_t      m_fadeCount;
     int           m_fadeStart;
+
+    /* histogram based scene cut detection, on the visible picture area */
+    bool          m_bHistPreAnalysis;    // histograms computed by pre-lookahead rather than by the API thread
+    int           m_histWidth;
+    int           m_histHeight;
+    int32_t       m_prevEdgeHist[EDGE_BINS];
+    int32_t       m_prevYUVHist[3][HISTOGRAM_BINS];
+    double        m_edgeHistThreshold;
+    double        m_chromaHistThreshold;
+    double        m_scaledEdgeThreshold;
+    double        m_scaledChromaThreshold;
+
     Lookahead(x265_param *param, ThreadPool *pool);
 #if DETAILED_CU_STATS
     int64_t       m_slicetypeDecideElapsedTime;
@@ -175,6 +223,11 @@ public:
     void    getEstimatedPictureCost(Frame *pic);
     void    setLookaheadQueue();
 
+    /* compares the histograms of a picture with those of the previous one, in
+     * input order. bDup is only set when the pictures cannot be told apart */
+    void    histBasedSceneCut(const int32_t* edgeHist, int32_t* const yuvHist[3], bool bFirst,
+                              bool& bScenecut, bool& bDup, bool& isMaxThres, bool& isHardSC);
+
 protected:
 
     void    findJob(int workerThreadID);
@@ -267,5 +320,14 @@ protected:
 };
 
 bool computeEdge(pixel* edgePic, pixel* refPic, pixel* edgeTheta, intptr_t stride, int height, int width, bool bcalcTheta, pixel whitePixel = EDGE_THRESHOLD);
+
+/* sums of the satd costs of fenc against ref weighted by each of count
+ * weights, in one pass over the planes; defined in weightPrediction.cpp */
+void weightCostBatch(uint32_t* costs, const WeightParam* w, int count, const pixel* fenc, const pixel* ref,
+                     pixel* weightTemp, intptr_t stride, int width, int height, const int* intraCost, int blockSize);
+
+/* luma edge histogram and YUV histograms of a width x height picture */
+void computeSceneCutHistograms(const pixel* const planes[3], const intptr_t stride[3], int width, int height, int csp,
+                               int32_t* edgeHist, int32_t* const yuvHist[3]);
 }
 #endif // ifndef X265_SLICETYPE_H
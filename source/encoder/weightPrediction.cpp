@@ -161,64 +161,62 @@ void mcChroma(pixel *      mcout,
         }
     }
 }
+}
 
-/* Measure sum of 8x8 satd costs between source frame and reference
- * frame (potentially weighted, potentially motion compensated). We
- * always use source images for this analysis since reference recon
- * pixels have unreliable availability */
-uint32_t weightCost(pixel *         fenc,
-                    pixel *         ref,
-                    pixel *         weightTemp,
-                    intptr_t        stride,
-                    const Cache &   cache,
-                    int             width,
-                    int             height,
-                    WeightParam *   w,
-                    bool            bLuma)
+namespace X265_NS {
+/* Measure sums of 8x8 satd costs (16x16 for 4:4:4 chroma) between source
+ * frame and reference frame (potentially motion compensated) for a batch of
+ * weights, unweighted for those without wtPresent. We always use source
+ * images for this analysis since reference recon pixels have unreliable
+ * availability. The weights are measured together a band of blocks at a
+ * time, so each band of the planes is read from memory once for the whole
+ * batch. weightTemp has the stride of the planes and room for a band */
+void weightCostBatch(uint32_t* costs, const WeightParam* w, int count, const pixel* fenc, const pixel* ref,
+                     pixel* weightTemp, intptr_t stride, int width, int height, const int* intraCost, int blockSize)
 {
-    if (w)
-    {
-        /* make a weighted copy of the reference plane */
-        int offset = w->inputOffset << (X265_DEPTH - 8);
-        int weight = w->inputWeight;
-        int denom = w->log2WeightDenom;
-        int round = denom ? 1 << (denom - 1) : 0;
-        int correction = IF_INTERNAL_PREC - X265_DEPTH; /* intermediate interpolation depth */
-        int pwidth = ((width + 31) >> 5) << 5;
-        primitives.weight_pp(ref, weightTemp, stride, pwidth, height,
-                             weight, round << correction, denom + correction, offset);
-        ref = weightTemp;
-    }
+    const int pwidth = ((width + 31) >> 5) << 5;
+    const int correction = IF_INTERNAL_PREC - X265_DEPTH; /* intermediate interpolation depth */
+    pixelcmp_t satd = primitives.pu[blockSize == 16 ? LUMA_16x16 : LUMA_8x8].satd;
+    const int blocksInRow = (width + blockSize - 1) / blockSize;
 
-    uint32_t cost = 0;
-    pixel *f = fenc, *r = ref;
+    for (int i = 0; i < count; i++)
+        costs[i] = 0;
 
-    if (bLuma)
+    for (int y = 0, cu = 0; y < height; y += blockSize, cu += blocksInRow, fenc += blockSize * stride, ref += blockSize * stride)
     {
-        int cu = 0;
-        for (int y = 0; y < height; y += 8, r += 8 * stride, f += 8 * stride)
+        for (int i = 0; i < count; i++)
         {
-            for (int x = 0; x < width; x += 8, cu++)
+            const pixel* r = ref;
+            if (w[i].wtPresent)
+            {
+                /* make a weighted copy of the band of the reference plane */
+                int offset = w[i].inputOffset << (X265_DEPTH - 8);
+                int denom = w[i].log2WeightDenom;
+                int round = denom ? 1 << (denom - 1) : 0;
+                primitives.weight_pp(ref, weightTemp, stride, pwidth, blockSize,
+                                     w[i].inputWeight, round << correction, denom + correction, offset);
+                r = weightTemp;
+            }
+
+            uint32_t cost = 0;
+            if (intraCost)
+            {
+                for (int x = 0, blockCu = cu; x < width; x += blockSize, blockCu++)
+                {
+                    int cmp = satd(r + x, stride, fenc + x, stride);
+                    cost += X265_MIN(cmp, intraCost[blockCu]);
+                }
+            }
+            else
             {
-                int cmp = primitives.pu[LUMA_8x8].satd(r + x, stride, f + x, stride);
-                cost += X265_MIN(cmp, cache.intraCost[cu]);
+                for (int x = 0; x < width; x += blockSize)
+                    cost += satd(r + x, stride, fenc + x, stride);
             }
+            costs[i] += cost;
         }
     }
-    else if (cache.csp == X265_CSP_I444)
-        for (int y = 0; y < height; y += 16, r += 16 * stride, f += 16 * stride)
-            for (int x = 0; x < width; x += 16)
-                cost += primitives.pu[LUMA_16x16].satd(r + x, stride, f + x, stride);
-    else
-        for (int y = 0; y < height; y += 8, r += 8 * stride, f += 8 * stride)
-            for (int x = 0; x < width; x += 8)
-                cost += primitives.pu[LUMA_8x8].satd(r + x, stride, f + x, stride);
-
-    return cost;
-}
 }
 
-namespace X265_NS {
 void weightAnalyse(Slice& slice, Frame& frame, x265_param& param)
 {
     WeightParam wp[2][MAX_NUM_REF][3];
@@ -236,8 +234,8 @@ void weightAnalyse(Slice& slice, Frame& frame, x265_param& param)
     cache.hshift = CHROMA_H_SHIFT(cache.csp);
     cache.vshift = CHROMA_V_SHIFT(cache.csp);
 
-    /* Use single allocation for motion compensated ref and weight buffers */
-    pixel *mcbuf = X265_MALLOC(pixel, 2 * fencPic->m_stride * fencPic->m_picHeight);
+    /* Use single allocation for motion compensated ref and a band of weighted ref */
+    pixel *mcbuf = X265_MALLOC(pixel, fencPic->m_stride * (fencPic->m_picHeight + 16));
     if (!mcbuf)
     {
         slice.disableWeights();
@@ -402,7 +400,13 @@ void weightAnalyse(Slice& slice, Frame& frame, x265_param& param)
                 return;
             }
 
-            uint32_t origscore = weightCost(orig, fref, weightTemp, stride, cache, width, height, NULL, !plane);
+            const int* intraCost = plane ? NULL : cache.intraCost;
+            int blockSize = plane && cache.csp == X265_CSP_I444 ? 16 : 8;
+
+            WeightParam unweighted;
+            SET_WEIGHT(unweighted, false, 1 << denom, denom, 0);
+            uint32_t origscore;
+            weightCostBatch(&origscore, &unweighted, 1, orig, fref, weightTemp, stride, width, height, intraCost, blockSize);
             if (!origscore)
             {
                 SET_WEIGHT(weights[plane], 0, 1 << denom, denom, 0);
@@ -439,12 +443,25 @@ void weightAnalyse(Slice& slice, Frame& frame, x265_param& param)
 
                 int startOffset = x265_clip3(-128, 127, curOffset - offsetDist);
                 int endOffset   = x265_clip3(-128, 127, curOffset + offsetDist);
+                WeightParam wsp[2 * offsetDist + 1];
+                uint32_t cost[2 * offsetDist + 1];
+                for (int off = startOffset; off <= endOffset; off++)
+                    SET_WEIGHT(wsp[off - startOffset], true, curScale, mindenom, off);
+
+                int measured = 0;
                 for (int off = startOffset; off <= endOffset; off++)
                 {
-                    WeightParam wsp;
-                    SET_WEIGHT(wsp, true, curScale, mindenom, off);
-                    uint32_t s = weightCost(orig, fref, weightTemp, stride, cache, width, height, &wsp, !plane) +
-                                 sliceHeaderCost(&wsp, lambda, !!plane);
+                    /* The search can stop after the second offset, the others
+                     * are only measured, in one batch, if it goes on */
+                    int idx = off - startOffset;
+                    if (idx == measured)
+                    {
+                        int batch = idx ? endOffset - off + 1 : X265_MIN(2, endOffset - startOffset + 1);
+                        weightCostBatch(cost + idx, wsp + idx, batch, orig, fref, weightTemp, stride, width, height, intraCost, blockSize);
+                        measured += batch;
+                    }
+
+                    uint32_t s = cost[idx] + sliceHeaderCost(&wsp[idx], lambda, !!plane);
                     COPY4_IF_LT(minscore, s, minscale, curScale, minoff, off, bFound, true);
 
                     /* Don't check any more offsets if the previous one had a lower cost than the current one */
@@ -31,6 +31,17 @@
 #define MIN_FRAME_RATE 1
 #define MAX_FRAME_RATE 300
 
+#define INPUT_IO_SLOTS 5
+
+enum InputIOMode
+{
+    INPUT_IO_STDIO,  // buffered fread into a frame queue
+    INPUT_IO_MMAP,   // frames are read in place from a file mapping
+    INPUT_IO_DIRECT, // O_DIRECT reads into block aligned buffers
+};
+
+static const char * const x265_input_io_names[] = { "stdio", "mmap", "direct", 0 };
+
 #include "common.h"
 
 namespace X265_NS {
@@ -53,6 +64,7 @@ struct InputFileInfo
 
     /* user supplied */
     int skipFrames;
+    int ioMode;
     const char *filename;
 };
 
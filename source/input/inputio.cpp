@@ -0,0 +1,203 @@
+/*****************************************************************************
+ * Copyright (C) 2013-2020 MulticoreWare, Inc
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02111, USA.
+ *
+ * This program is also available under a commercial proprietary license.
+ * For more information, contact us at license @ x265.com.
+ *****************************************************************************/
+#define _FILE_OFFSET_BITS 64
+#define _LARGEFILE_SOURCE
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE // O_DIRECT
+#endif
+#include "inputio.h"
+
+#if !_WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <errno.h>
+#endif
+
+/* offsets and lengths of O_DIRECT reads are multiples of this, which covers
+ * the logical block size of common devices */
+#define DIRECT_ALIGN 4096
+
+using namespace X265_NS;
+
+InputIO::InputIO()
+    : m_mode(INPUT_IO_STDIO)
+    , m_fd(-1)
+    , m_fileSize(0)
+    , m_base(NULL)
+    , m_slotSize(0)
+{
+    for (int i = 0; i < INPUT_IO_SLOTS; i++)
+        m_slot[i] = NULL;
+}
+
+InputIO::~InputIO()
+{
+    close();
+}
+
+#if _WIN32
+
+bool InputIO::open(const char*, int mode, size_t)
+{
+    x265_log(NULL, X265_LOG_WARNING, "input: %s reads are not supported on this platform, using stdio\n",
+             x265_input_io_names[mode]);
+    return false;
+}
+
+void InputIO::close()
+{
+}
+
+const char* InputIO::read(int64_t, size_t, int)
+{
+    return NULL;
+}
+
+#else
+
+bool InputIO::open(const char* filename, int mode, size_t maxRead)
+{
+    const char* modeName = x265_input_io_names[mode];
+    int flags = O_RDONLY;
+    if (mode == INPUT_IO_DIRECT)
+    {
+#ifdef O_DIRECT
+        flags |= O_DIRECT;
+#else
+        x265_log(NULL, X265_LOG_WARNING, "input: direct reads are not supported on this platform, using stdio\n");
+        return false;
+#endif
+    }
+
+    m_fd = ::open(filename, flags);
+    struct stat st;
+    if (m_fd < 0 || fstat(m_fd, &st) || !S_ISREG(st.st_mode))
+    {
+        x265_log(NULL, X265_LOG_WARNING, "input: %s reads need a regular file, using stdio\n", modeName);
+        close();
+        return false;
+    }
+    m_fileSize = st.st_size;
+    m_mode = mode;
+
+    if (mode == INPUT_IO_MMAP)
+    {
+        /* the whole file is mapped at once, a 32bit address space cannot
+         * hold typical inputs */
+        if (sizeof(void*) < 8 || !m_fileSize)
+        {
+            x265_log(NULL, X265_LOG_WARNING, "input: cannot map <%s>, using stdio\n", filename);
+            close();
+            return false;
+        }
+        void* base = mmap(NULL, (size_t)m_fileSize, PROT_READ, MAP_SHARED, m_fd, 0);
+        if (base == MAP_FAILED)
+        {
+            x265_log(NULL, X265_LOG_WARNING, "input: cannot map <%s>, using stdio\n", filename);
+            close();
+            return false;
+        }
+        m_base = (uint8_t*)base;
+        madvise(m_base, (size_t)m_fileSize, MADV_SEQUENTIAL);
+    }
+    else
+    {
+        /* a read may start anywhere within its first block and end anywhere
+         * within its last */
+        m_slotSize = (maxRead + 2 * DIRECT_ALIGN - 1) & ~(size_t)(DIRECT_ALIGN - 1);
+        for (int i = 0; i < INPUT_IO_SLOTS; i++)
+        {
+            void* buf = NULL;
+            if (posix_memalign(&buf, DIRECT_ALIGN, m_slotSize))
+            {
+                x265_log(NULL, X265_LOG_ERROR, "input: buffer allocation failure, using stdio\n");
+                close();
+                return false;
+            }
+            m_slot[i] = (uint8_t*)buf;
+        }
+
+        /* some file systems accept O_DIRECT at open but fail the reads */
+        if (!read(0, X265_MIN((size_t)m_fileSize, maxRead), 0))
+        {
+            x265_log(NULL, X265_LOG_WARNING, "input: direct reads of <%s> failed, using stdio\n", filename);
+            close();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void InputIO::close()
+{
+    if (m_base)
+        munmap(m_base, (size_t)m_fileSize);
+    m_base = NULL;
+    for (int i = 0; i < INPUT_IO_SLOTS; i++)
+    {
+        free(m_slot[i]);
+        m_slot[i] = NULL;
+    }
+    if (m_fd >= 0)
+        ::close(m_fd);
+    m_fd = -1;
+}
+
+const char* InputIO::read(int64_t offset, size_t size, int slot)
+{
+    if (offset < 0 || offset + (int64_t)size > m_fileSize)
+        return NULL;
+
+    if (m_mode == INPUT_IO_MMAP)
+    {
+        /* start paging in the data while the caller works on earlier frames */
+        uint8_t* data = m_base + offset;
+        uint8_t* page = (uint8_t*)((intptr_t)data & ~(intptr_t)(DIRECT_ALIGN - 1));
+        madvise(page, size + (data - page), MADV_WILLNEED);
+        return (const char*)data;
+    }
+
+    int64_t start = offset & ~(int64_t)(DIRECT_ALIGN - 1);
+    size_t lead = (size_t)(offset - start);
+    size_t length = (lead + size + DIRECT_ALIGN - 1) & ~(size_t)(DIRECT_ALIGN - 1);
+    if (length > m_slotSize)
+        return NULL;
+
+    /* the last block of the file may be short */
+    uint8_t* buf = m_slot[slot];
+    size_t done = 0;
+    while (done < lead + size)
+    {
+        ssize_t ret = pread(m_fd, buf + done, length - done, start + (int64_t)done);
+        if (ret < 0 && errno == EINTR)
+            continue;
+        if (ret <= 0)
+            return NULL;
+        done += (size_t)ret;
+    }
+
+    return (const char*)buf + lead;
+}
+
+#endif // if _WIN32
@@ -0,0 +1,68 @@
+/*****************************************************************************
+ * Copyright (C) 2013-2020 MulticoreWare, Inc
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02111, USA.
+ *
+ * This program is also available under a commercial proprietary license.
+ * For more information, contact us at license @ x265.com.
+ *****************************************************************************/
+
+#ifndef X265_INPUTIO_H
+#define X265_INPUTIO_H
+
+#include "input.h"
+
+namespace X265_NS {
+// private x265 namespace
+
+/* Frame access to a regular input file without stdio. With INPUT_IO_MMAP the
+ * whole file is mapped and frames are returned in place; with INPUT_IO_DIRECT
+ * each read bypasses the page cache into a block aligned buffer per slot */
+class InputIO
+{
+protected:
+
+    int      m_mode;
+    int      m_fd;
+    int64_t  m_fileSize;
+
+    uint8_t* m_base;       // file mapping, INPUT_IO_MMAP
+    uint8_t* m_slot[INPUT_IO_SLOTS];
+    size_t   m_slotSize;   // bytes allocated per slot, INPUT_IO_DIRECT
+
+public:
+
+    InputIO();
+
+    ~InputIO();
+
+    /* returns false if the file cannot be accessed in this mode, the caller
+     * then reads it with stdio. maxRead bounds the size of a single read */
+    bool open(const char* filename, int mode, size_t maxRead);
+
+    void close();
+
+    bool isOpen() const      { return m_fd >= 0; }
+
+    int64_t fileSize() const { return m_fileSize; }
+
+    /* returns size bytes of the file at offset, or NULL if the file ends
+     * first or the read fails. Mapped data stays valid until close(), direct
+     * reads until the same slot is read again */
+    const char* read(int64_t offset, size_t size, int slot);
+};
+}
+
+#endif // ifndef X265_INPUTIO_H
@@ -43,7 +43,10 @@ static const char header[] = {'F','R','A','M','E'};
 Y4MInput::Y4MInput(InputFileInfo& info)
 {
     for (int i = 0; i < QUEUE_SIZE; i++)
+    {
         buf[i] = NULL;
+        frame[i] = NULL;
+    }
 
     threadActive = false;
     colorSpace = info.csp;
@@ -55,6 +58,7 @@ Y4MInput::Y4MInput(InputFileInfo& info)
     rateDenom = info.fpsDenom;
     depth = info.depth;
     framesize = 0;
+    filePos = 0;
 
     ifs = NULL;
     if (!strcmp(info.filename, "-"))
@@ -75,8 +79,15 @@ Y4MInput::Y4MInput(InputFileInfo& info)
             framesize += (stride * (height >> x265_cli_csps[colorSpace].height[i]));
         }
 
+        /* frames read through io need no queue buffers of their own, the
+         * largest read covers a FRAME\n header and the frame */
+        if (info.ioMode != INPUT_IO_STDIO && ifs != stdin)
+            io.open(info.filename, info.ioMode, framesize + sizeof(header) + 1);
+        else if (info.ioMode != INPUT_IO_STDIO)
+            x265_log(NULL, X265_LOG_WARNING, "y4m: %s reads need a regular file, using stdio\n", x265_input_io_names[info.ioMode]);
+
         threadActive = true;
-        for (int q = 0; q < QUEUE_SIZE; q++)
+        for (int q = 0; q < QUEUE_SIZE && !io.isOpen(); q++)
         {
             buf[q] = X265_MALLOC(char, framesize);
             if (!buf[q])
@@ -85,6 +96,7 @@ Y4MInput::Y4MInput(InputFileInfo& info)
                 threadActive = false;
                 break;
             }
+            frame[q] = buf[q];
         }
     }
     if (!threadActive)
@@ -116,11 +128,14 @@ Y4MInput::Y4MInput(InputFileInfo& info)
             fseeko(ifs, cur, SEEK_SET);
             if (size > 0)
                 info.frameCount = (int)((size - cur) / estFrameSize);
+            filePos = cur;
         }
     }
     if (info.skipFrames)
     {
-        if (ifs != stdin)
+        if (io.isOpen())
+            filePos += (int64_t)estFrameSize * info.skipFrames;
+        else if (ifs != stdin)
             fseeko(ifs, (int64_t)estFrameSize * info.skipFrames, SEEK_CUR);
         else
             for (int i = 0; i < info.skipFrames; i++)
@@ -333,6 +348,8 @@ bool Y4MInput::populateFrameQueue()
 {
     if (!ifs || ferror(ifs))
         return false;
+    if (io.isOpen())
+        return populateFromIO();
     /* strip off the FRAME\n header */
     char hbuf[sizeof(header) + 1];
     if (fread(hbuf, sizeof(hbuf), 1, ifs) != 1 || memcmp(hbuf, header, sizeof(header)))
@@ -365,6 +382,63 @@ bool Y4MInput::populateFrameQueue()
         return false;
 }
 
+bool Y4MInput::populateFromIO()
+{
+    int written = writeCount.get();
+    int read = readCount.get();
+    while (written - read > QUEUE_SIZE - 2)
+    {
+        read = readCount.waitForChange(read);
+        if (!threadActive)
+            return false;
+    }
+    ProfileScopeEvent(frameRead);
+
+    /* read the frame assuming a FRAME\n header, frames whose header carries
+     * parameters are read again past the line feed */
+    int slot = written % QUEUE_SIZE;
+    const size_t basicHeader = sizeof(header) + 1;
+    const char* data = io.read(filePos, basicHeader + framesize, slot);
+    if (!data)
+        return false;
+    if (memcmp(data, header, sizeof(header)))
+    {
+        x265_log(NULL, X265_LOG_ERROR, "y4m: frame header missing\n");
+        return false;
+    }
+
+    size_t headerSize = sizeof(header);
+    while (headerSize < basicHeader + framesize && data[headerSize] != '\n')
+        headerSize++;
+    headerSize++;
+
+    if (headerSize == basicHeader)
+        frame[slot] = data + basicHeader;
+    else
+        frame[slot] = io.read(filePos + headerSize, framesize, slot);
+    if (!frame[slot])
+        return false;
+
+    /* the FRAME headers have any length, so 16bit samples read in place may
+     * be misaligned; those frames are copied into the queue buffer */
+    if (depth > 8 && ((intptr_t)frame[slot] & 1))
+    {
+        if (!buf[slot])
+            buf[slot] = X265_MALLOC(char, framesize);
+        if (!buf[slot])
+        {
+            x265_log(NULL, X265_LOG_ERROR, "y4m: buffer allocation failure, aborting");
+            return false;
+        }
+        memcpy(buf[slot], frame[slot], framesize);
+        frame[slot] = buf[slot];
+    }
+
+    filePos += headerSize + framesize;
+    writeCount.incr();
+    return true;
+}
+
 bool Y4MInput::readPicture(x265_picture& pic)
 {
     int read = readCount.get();
@@ -393,7 +467,7 @@ bool Y4MInput::readPicture(x265_picture& pic)
         pic.stride[0] = width * pixelbytes;
         pic.stride[1] = pic.stride[0] >> x265_cli_csps[colorSpace].width[1];
         pic.stride[2] = pic.stride[0] >> x265_cli_csps[colorSpace].width[2];
-        pic.planes[0] = buf[read % QUEUE_SIZE];
+        pic.planes[0] = (char*)frame[read % QUEUE_SIZE];
         pic.planes[1] = (char*)pic.planes[0] + pic.stride[0] * height;
         pic.planes[2] = (char*)pic.planes[1] + pic.stride[1] * (height >> x265_cli_csps[colorSpace].height[1]);
         readCount.incr();
@@ -25,10 +25,11 @@
 #define X265_Y4M_H
 
 #include "input.h"
+#include "inputio.h"
 #include "threading.h"
 #include <fstream>
 
-#define QUEUE_SIZE 5
+#define QUEUE_SIZE INPUT_IO_SLOTS
 
 namespace X265_NS {
 // x265 private namespace
@@ -61,12 +62,17 @@ protected:
 
     ThreadSafeInteger writeCount;
     char* buf[QUEUE_SIZE];
+    const char* frame[QUEUE_SIZE]; // queued frames, in buf or returned by io
     FILE *ifs;
+    InputIO io;
+    int64_t filePos;               // offset of the next frame read through io
     bool parseHeader();
     void threadMain();
 
     bool populateFrameQueue();
 
+    bool populateFromIO();
+
 public:
 
     Y4MInput(InputFileInfo& info);
@@ -43,7 +43,10 @@ using namespace std;
 YUVInput::YUVInput(InputFileInfo& info)
 {
     for (int i = 0; i < QUEUE_SIZE; i++)
+    {
         buf[i] = NULL;
+        frame[i] = NULL;
+    }
 
     depth = info.depth;
     width = info.width;
@@ -51,6 +54,7 @@ YUVInput::YUVInput(InputFileInfo& info)
     colorSpace = info.csp;
     threadActive = false;
     ifs = NULL;
+    filePos = 0;
 
     uint32_t pixelbytes = depth > 8 ? 2 : 1;
     framesize = 0;
@@ -85,7 +89,13 @@ YUVInput::YUVInput(InputFileInfo& info)
         return;
     }
 
-    for (uint32_t i = 0; i < QUEUE_SIZE; i++)
+    /* frames read through io need no queue buffers of their own */
+    if (info.ioMode != INPUT_IO_STDIO && ifs != stdin)
+        io.open(info.filename, info.ioMode, framesize);
+    else if (info.ioMode != INPUT_IO_STDIO)
+        x265_log(NULL, X265_LOG_WARNING, "yuv: %s reads need a regular file, using stdio\n", x265_input_io_names[info.ioMode]);
+
+    for (uint32_t i = 0; i < QUEUE_SIZE && !io.isOpen(); i++)
     {
         buf[i] = X265_MALLOC(char, framesize);
         if (buf[i] == NULL)
@@ -94,6 +104,7 @@ YUVInput::YUVInput(InputFileInfo& info)
             threadActive = false;
             return;
         }
+        frame[i] = buf[i];
     }
 
     info.frameCount = -1;
@@ -112,7 +123,9 @@ YUVInput::YUVInput(InputFileInfo& info)
     }
     if (info.skipFrames)
     {
-        if (ifs != stdin)
+        if (io.isOpen())
+            filePos = (int64_t)framesize * info.skipFrames;
+        else if (ifs != stdin)
             fseeko(ifs, (int64_t)framesize * info.skipFrames, SEEK_CUR);
         else
             for (int i = 0; i < info.skipFrames; i++)
@@ -171,13 +184,19 @@ bool YUVInput::populateFrameQueue()
             return false;
     }
     ProfileScopeEvent(frameRead);
-    if (fread(buf[written % QUEUE_SIZE], framesize, 1, ifs) == 1)
+    int slot = written % QUEUE_SIZE;
+    if (io.isOpen())
     {
-        writeCount.incr();
-        return true;
+        frame[slot] = io.read(filePos, framesize, slot);
+        if (!frame[slot])
+            return false;
+        filePos += framesize;
     }
-    else
+    else if (fread(buf[slot], framesize, 1, ifs) != 1)
         return false;
+
+    writeCount.incr();
+    return true;
 }
 
 bool YUVInput::readPicture(x265_picture& pic)
@@ -208,7 +227,7 @@ bool YUVInput::readPicture(x265_picture& pic)
         pic.stride[0] = width * pixelbytes;
         pic.stride[1] = pic.stride[0] >> x265_cli_csps[colorSpace].width[1];
         pic.stride[2] = pic.stride[0] >> x265_cli_csps[colorSpace].width[2];
-        pic.planes[0] = buf[read % QUEUE_SIZE];
+        pic.planes[0] = (char*)frame[read % QUEUE_SIZE];
         pic.planes[1] = (char*)pic.planes[0] + pic.stride[0] * height;
         pic.planes[2] = (char*)pic.planes[1] + pic.stride[1] * (height >> x265_cli_csps[colorSpace].height[1]);
         readCount.incr();
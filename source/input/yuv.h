@@ -25,10 +25,11 @@
 #define X265_YUV_H
 
 #include "input.h"
+#include "inputio.h"
 #include "threading.h"
 #include <fstream>
 
-#define QUEUE_SIZE 5
+#define QUEUE_SIZE INPUT_IO_SLOTS
 
 namespace X265_NS {
 // private x265 namespace
@@ -53,7 +54,10 @@ protected:
 
     ThreadSafeInteger writeCount;
     char* buf[QUEUE_SIZE];
+    const char* frame[QUEUE_SIZE]; // queued frames, in buf or returned by io
     FILE *ifs;
+    InputIO io;
+    int64_t filePos;               // offset of the next frame read through io
     int guessFrameCount();
     void threadMain();
 
@@ -0,0 +1,254 @@
+/*****************************************************************************
+ * Copyright (C) 2013-2020 MulticoreWare, Inc
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02111, USA.
+ *
+ * This program is also available under a commercial proprietary license.
+ * For more information, contact us at license @ x265.com.
+ *****************************************************************************/
+
+#include "asyncwriter.h"
+
+using namespace X265_NS;
+
+AsyncWriter::AsyncWriter(const char* name)
+    : m_bThreaded(false)
+    , m_name(name)
+    , m_stallCount(0)
+    , m_stallTime(0)
+{
+    memset(m_batch, 0, sizeof(m_batch));
+}
+
+AsyncWriter::~AsyncWriter()
+{
+    for (int i = 0; i < WRITE_QUEUE_SIZE; i++)
+    {
+        X265_FREE(m_batch[i].buf);
+        X265_FREE(m_batch[i].nal);
+    }
+}
+
+void AsyncWriter::threadMain()
+{
+    THREAD_NAME("Writer", 0);
+
+    /* only this thread advances m_written */
+    int written = m_written.get();
+    for (;;)
+    {
+        int queued = m_queued.get();
+        while (queued == written)
+            queued = m_queued.waitForChange(queued);
+
+        Batch& batch = m_batch[written % WRITE_QUEUE_SIZE];
+        if (batch.type == BATCH_END)
+            break;
+
+        writeBatch(batch);
+        written++;
+        m_written.incr();
+    }
+}
+
+AsyncWriter::Batch* AsyncWriter::acquireBatch(size_t size)
+{
+    int queued = m_queued.get();
+    if (m_bThreaded)
+    {
+        int written = m_written.get();
+        if (queued - written >= WRITE_QUEUE_SIZE)
+        {
+            int64_t startTime = x265_mdate();
+            while (queued - written >= WRITE_QUEUE_SIZE)
+                written = m_written.waitForChange(written);
+            m_stallTime += x265_mdate() - startTime;
+            m_stallCount++;
+        }
+    }
+
+    Batch& batch = m_batch[queued % WRITE_QUEUE_SIZE];
+    if (size > batch.allocSize)
+    {
+        X265_FREE(batch.buf);
+        batch.buf = X265_MALLOC(uint8_t, size);
+        batch.allocSize = batch.buf ? size : 0;
+        if (!batch.buf)
+        {
+            x265_log(NULL, X265_LOG_ERROR, "%s writer: unable to allocate write buffer, writing synchronously\n", m_name);
+            return NULL;
+        }
+    }
+
+    return &batch;
+}
+
+void AsyncWriter::submitBatch(Batch& batch)
+{
+    if (m_bThreaded)
+        m_queued.incr();
+    else
+        writeBatch(batch);
+}
+
+void AsyncWriter::finish()
+{
+    if (m_bThreaded)
+    {
+        Batch* batch = acquireBatch(0);
+        batch->type = BATCH_END;
+        m_queued.incr();
+        stop();
+        m_bThreaded = false;
+    }
+
+    if (m_stallCount)
+        x265_log(NULL, X265_LOG_INFO, "%s writer: encoder waited %.1f ms for storage in %d stalls\n",
+                 m_name, m_stallTime / 1000.0, m_stallCount);
+    m_stallCount = 0;
+    m_stallTime = 0;
+}
+
+int AsyncOutput::queueNals(BatchType type, const x265_nal* nal, uint32_t nalcount, const x265_picture* pic)
+{
+    size_t size = 0;
+    for (uint32_t i = 0; i < nalcount; i++)
+        size += nal[i].sizeBytes;
+
+    Batch* batch = acquireBatch(size);
+    if (batch && nalcount > batch->nalAllocCount)
+    {
+        X265_FREE(batch->nal);
+        batch->nal = X265_MALLOC(x265_nal, nalcount);
+        batch->nalAllocCount = batch->nal ? nalcount : 0;
+        if (!batch->nal)
+            batch = NULL;
+    }
+
+    if (!batch)
+    {
+        finish();
+        if (type == BATCH_HEADERS)
+            return m_output->writeHeaders(nal, nalcount);
+        return m_output->writeFrame(nal, nalcount, *const_cast<x265_picture*>(pic));
+    }
+
+    uint8_t* out = batch->buf;
+    for (uint32_t i = 0; i < nalcount; i++)
+    {
+        batch->nal[i] = nal[i];
+        batch->nal[i].payload = out;
+        memcpy(out, nal[i].payload, nal[i].sizeBytes);
+        out += nal[i].sizeBytes;
+    }
+
+    batch->type = type;
+    batch->nalcount = nalcount;
+    if (pic)
+        batch->pic = *pic;
+    submitBatch(*batch);
+
+    return (int)size;
+}
+
+void AsyncOutput::writeBatch(Batch& batch)
+{
+    if (batch.type == BATCH_HEADERS)
+        m_output->writeHeaders(batch.nal, batch.nalcount);
+    else
+        m_output->writeFrame(batch.nal, batch.nalcount, batch.pic);
+    if (m_output->isFail())
+        m_failed.set(1);
+}
+
+int AsyncOutput::writeHeaders(const x265_nal* nal, uint32_t nalcount)
+{
+    return queueNals(BATCH_HEADERS, nal, nalcount, NULL);
+}
+
+/* the queued picture keeps the fields of pic, its plane pointers are not
+ * valid by the time the frame is written */
+int AsyncOutput::writeFrame(const x265_nal* nal, uint32_t nalcount, x265_picture& pic)
+{
+    return queueNals(BATCH_FRAME, nal, nalcount, &pic);
+}
+
+void AsyncOutput::closeFile(int64_t largest_pts, int64_t second_largest_pts)
+{
+    finish();
+    m_output->closeFile(largest_pts, second_largest_pts);
+}
+
+void AsyncOutput::release()
+{
+    finish();
+    m_output->release();
+    delete this;
+}
+
+bool AsyncRecon::writePicture(const x265_picture& pic)
+{
+    const int planes = x265_cli_csps[m_colorSpace].planes;
+
+    size_t size = 0;
+    for (int i = 0; i < planes; i++)
+        size += (size_t)((m_width >> x265_cli_csps[m_colorSpace].width[i]) * sizeof(pixel)) * (m_height >> x265_cli_csps[m_colorSpace].height[i]);
+
+    Batch* batch = acquireBatch(size);
+    if (!batch)
+    {
+        finish();
+        return m_recon->writePicture(pic);
+    }
+
+    /* the planes are packed without padding, the writers only use width
+     * and height they were opened with */
+    batch->pic = pic;
+    uint8_t* out = batch->buf;
+    for (int i = 0; i < planes; i++)
+    {
+        const size_t rowBytes = (m_width >> x265_cli_csps[m_colorSpace].width[i]) * sizeof(pixel);
+        const int rows = m_height >> x265_cli_csps[m_colorSpace].height[i];
+        const uint8_t* src = (const uint8_t*)pic.planes[i];
+
+        batch->pic.planes[i] = out;
+        batch->pic.stride[i] = (int)rowBytes;
+        for (int y = 0; y < rows; y++)
+        {
+            memcpy(out, src, rowBytes);
+            src += pic.stride[i];
+            out += rowBytes;
+        }
+    }
+
+    batch->type = BATCH_FRAME;
+    submitBatch(*batch);
+
+    return true;
+}
+
+void AsyncRecon::writeBatch(Batch& batch)
+{
+    m_recon->writePicture(batch.pic);
+    if (m_recon->isFail())
+        m_failed.set(1);
+}
+
+void AsyncRecon::release()
+{
+    finish();
+    m_recon->release();
+    delete this;
+}
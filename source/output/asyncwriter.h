@@ -0,0 +1,152 @@
+/*****************************************************************************
+ * Copyright (C) 2013-2020 MulticoreWare, Inc
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02111, USA.
+ *
+ * This program is also available under a commercial proprietary license.
+ * For more information, contact us at license @ x265.com.
+ *****************************************************************************/
+
+#ifndef X265_ASYNCWRITER_H
+#define X265_ASYNCWRITER_H
+
+#include "output.h"
+#include "common.h"
+#include "threading.h"
+
+#define WRITE_QUEUE_SIZE 8
+
+namespace X265_NS {
+// private x265 namespace
+
+/* Bounded ring of pending writes drained by a background thread, so the
+ * encoder only waits on slow storage once the ring is full. The data is copied
+ * into the ring since libx265 reuses its buffers on the next call to
+ * x265_encoder_encode(). That one memcpy of each access unit is the price of
+ * taking the write off the encode thread; the gathered write of the raw
+ * output still avoids a second copy into a contiguous buffer */
+class AsyncWriter : public Thread
+{
+protected:
+
+    enum BatchType { BATCH_HEADERS, BATCH_FRAME, BATCH_END };
+
+    struct Batch
+    {
+        BatchType    type;
+        uint8_t*     buf;
+        size_t       allocSize;
+        x265_nal*    nal;
+        uint32_t     nalcount;
+        uint32_t     nalAllocCount;
+        x265_picture pic;
+    };
+
+    Batch             m_batch[WRITE_QUEUE_SIZE];
+
+    ThreadSafeInteger m_queued;   // batches handed over by the encode thread
+    ThreadSafeInteger m_written;  // batches completed by the writer thread
+
+    /* set when a write of the writer thread failed. The fail flag of the
+     * wrapped file is only read directly once no writer thread runs */
+    mutable ThreadSafeInteger m_failed;
+
+    bool              m_bThreaded;
+    const char*       m_name;
+
+    /* time the encode thread spent waiting for a free batch */
+    int               m_stallCount;
+    int64_t           m_stallTime;
+
+    AsyncWriter(const char* name);
+
+    virtual ~AsyncWriter();
+
+    void threadMain();
+
+    /* waits for a free batch, returns it with room for size bytes */
+    Batch* acquireBatch(size_t size);
+
+    /* queues the batch, or writes it directly without a writer thread */
+    void submitBatch(Batch& batch);
+
+    /* writes the remaining batches and joins the writer thread */
+    void finish();
+
+    virtual void writeBatch(Batch& batch) = 0;
+
+public:
+
+    void startWriter()            { m_bThreaded = start(); }
+};
+
+class AsyncOutput : public OutputFile, public AsyncWriter
+{
+protected:
+
+    OutputFile* m_output;
+
+    void writeBatch(Batch& batch);
+
+    int queueNals(BatchType type, const x265_nal* nal, uint32_t nalcount, const x265_picture* pic);
+
+public:
+
+    AsyncOutput(OutputFile* output) : AsyncWriter(output->getName()), m_output(output) {}
+
+    bool isFail() const           { return m_bThreaded ? !!m_failed.get() : m_output->isFail(); }
+
+    bool needPTS() const          { return m_output->needPTS(); }
+
+    void release();
+
+    const char* getName() const   { return m_output->getName(); }
+
+    void setParam(x265_param* param) { m_output->setParam(param); }
+
+    int writeHeaders(const x265_nal* nal, uint32_t nalcount);
+
+    int writeFrame(const x265_nal* nal, uint32_t nalcount, x265_picture& pic);
+
+    void closeFile(int64_t largest_pts, int64_t second_largest_pts);
+};
+
+class AsyncRecon : public ReconFile, public AsyncWriter
+{
+protected:
+
+    ReconFile* m_recon;
+    int        m_width;
+    int        m_height;
+    int        m_colorSpace;
+
+    void writeBatch(Batch& batch);
+
+public:
+
+    AsyncRecon(ReconFile* recon, int width, int height, int csp)
+        : AsyncWriter(recon->getName()), m_recon(recon), m_width(width), m_height(height), m_colorSpace(csp) {}
+
+    bool isFail() const           { return m_bThreaded ? !!m_failed.get() : m_recon->isFail(); }
+
+    void release();
+
+    bool writePicture(const x265_picture& pic);
+
+    const char *getName() const   { return m_recon->getName(); }
+};
+}
+
+#endif // ifndef X265_ASYNCWRITER_H
@@ -27,20 +27,36 @@
 #include "y4m.h"
 
 #include "raw.h"
+#include "asyncwriter.h"
 
 using namespace X265_NS;
 
 ReconFile* ReconFile::open(const char *fname, int width, int height, uint32_t bitdepth, uint32_t fpsNum, uint32_t fpsDenom, int csp)
 {
     const char * s = strrchr(fname, '.');
+    ReconFile* recon;
 
     if (s && !strcmp(s, ".y4m"))
-        return new Y4MOutput(fname, width, height, fpsNum, fpsDenom, csp);
+        recon = new Y4MOutput(fname, width, height, fpsNum, fpsDenom, csp);
     else
-        return new YUVOutput(fname, width, height, bitdepth, csp);
+        recon = new YUVOutput(fname, width, height, bitdepth, csp);
+
+    if (recon->isFail())
+        return recon;
+
+    AsyncRecon* async = new AsyncRecon(recon, width, height, csp);
+    async->startWriter();
+    return async;
 }
 
 OutputFile* OutputFile::open(const char *fname, InputFileInfo& inputInfo)
 {
-    return new RAWOutput(fname, inputInfo);
+    OutputFile* output = new RAWOutput(fname, inputInfo);
+
+    if (output->isFail())
+        return output;
+
+    AsyncOutput* async = new AsyncOutput(output);
+    async->startWriter();
+    return async;
 }
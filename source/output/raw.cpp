@@ -28,6 +28,10 @@
 #if defined(_MSC_VER)
 #pragma warning(disable: 4996) // POSIX setmode and fileno deprecated
 #endif
+#else
+#include <sys/uio.h>
+#include <unistd.h>
+#include <errno.h>
 #endif
 
 using namespace X265_NS;
@@ -53,34 +57,84 @@ void RAWOutput::setParam(x265_param* param)
     param->bAnnexB = true;
 }
 
-int RAWOutput::writeHeaders(const x265_nal* nal, uint32_t nalcount)
+/* libx265 returns the NALs of an access unit sequential in memory, so they
+ * are normally written by a single system call straight from the encoder's
+ * buffer, without going through the stdio buffer */
+int RAWOutput::writeNals(const x265_nal* nal, uint32_t nalcount)
 {
     uint32_t bytes = 0;
 
-    for (uint32_t i = 0; i < nalcount; i++)
+#if _WIN32
+    for (uint32_t i = 0; i < nalcount;)
     {
-        fwrite((const void*)nal->payload, 1, nal->sizeBytes, ofs);
-        bytes += nal->sizeBytes;
-        nal++;
+        const uint8_t* start = nal[i].payload;
+        uint32_t size = 0;
+        for (; i < nalcount && nal[i].payload == start + size; i++)
+            size += nal[i].sizeBytes;
+
+        if (fwrite((const void*)start, 1, size, ofs) != size)
+            b_fail = true;
+        bytes += size;
     }
+#else
+    /* the minimum IOV_MAX guaranteed by POSIX */
+    struct iovec iov[16];
+    int fd = fileno(ofs);
 
-    return bytes;
-}
+    for (uint32_t i = 0; i < nalcount && !b_fail;)
+    {
+        int iovcnt = 0;
+        for (; i < nalcount && iovcnt < 16; iovcnt++)
+        {
+            iov[iovcnt].iov_base = (void*)nal[i].payload;
+            iov[iovcnt].iov_len = 0;
+            for (; i < nalcount && nal[i].payload == (uint8_t*)iov[iovcnt].iov_base + iov[iovcnt].iov_len; i++)
+                iov[iovcnt].iov_len += nal[i].sizeBytes;
+            bytes += (uint32_t)iov[iovcnt].iov_len;
+        }
 
-int RAWOutput::writeFrame(const x265_nal* nal, uint32_t nalcount, x265_picture&)
-{
-    uint32_t bytes = 0;
+        /* resume short writes from the first vector not fully written */
+        struct iovec* cur = iov;
+        for (;;)
+        {
+            for (; iovcnt && !cur->iov_len; cur++)
+                iovcnt--;
+            if (!iovcnt)
+                break;
 
-    for (uint32_t i = 0; i < nalcount; i++)
-    {
-        fwrite((const void*)nal->payload, 1, nal->sizeBytes, ofs);
-        bytes += nal->sizeBytes;
-        nal++;
+            ssize_t ret = writev(fd, cur, iovcnt);
+            if (ret < 0 && errno == EINTR)
+                continue;
+            if (ret <= 0)
+            {
+                b_fail = true;
+                break;
+            }
+
+            for (; iovcnt && (size_t)ret >= cur->iov_len; cur++, iovcnt--)
+                ret -= cur->iov_len;
+            if (iovcnt)
+            {
+                cur->iov_base = (uint8_t*)cur->iov_base + ret;
+                cur->iov_len -= ret;
+            }
+        }
     }
+#endif
 
     return bytes;
 }
 
+int RAWOutput::writeHeaders(const x265_nal* nal, uint32_t nalcount)
+{
+    return writeNals(nal, nalcount);
+}
+
+int RAWOutput::writeFrame(const x265_nal* nal, uint32_t nalcount, x265_picture&)
+{
+    return writeNals(nal, nalcount);
+}
+
 void RAWOutput::closeFile(int64_t, int64_t)
 {
     if (ofs != stdout)
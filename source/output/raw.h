@@ -39,6 +39,9 @@ protected:
 
     bool b_fail;
 
+    /* writes the NAL payloads, merging those adjacent in memory */
+    int writeNals(const x265_nal* nal, uint32_t nalcount);
+
 public:
 
     RAWOutput(const char* fname, InputFileInfo&);
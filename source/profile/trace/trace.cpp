@@ -0,0 +1,231 @@
+/*****************************************************************************
+ * Copyright (C) 2013-2020 MulticoreWare, Inc
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02111, USA.
+ *
+ * This program is also available under a commercial proprietary license.
+ * For more information, contact us at license @ x265.com.
+ *****************************************************************************/
+
+#include "common.h"
+#include "threading.h"
+#include "trace.h"
+
+#if !_WIN32
+#include <time.h>
+#endif
+
+/* events kept per thread, a power of two. Each thread keeps its most recent
+ * events, so a long encode is traced up to its end */
+#ifndef TRACE_RING_SIZE
+#define TRACE_RING_SIZE   (1 << 16)
+#endif
+#define TRACE_MAX_THREADS 256
+
+#if _MSC_VER
+#define TRACE_TLS __declspec(thread)
+#else
+#define TRACE_TLS __thread
+#endif
+
+using namespace X265_NS;
+
+namespace {
+
+#define CPU_EVENT(x) #x,
+const char *eventNames[] =
+{
+#include "../cpuEvents.h"
+};
+#undef CPU_EVENT
+
+struct TraceRecord
+{
+    int64_t start;
+    int64_t duration;
+    int     event;
+};
+
+/* written only by the thread which claimed it, read and freed by
+ * traceClose() once the threads of the session have stopped */
+struct ThreadRing
+{
+    TraceRecord* records;
+    uint32_t     count;     // records written, the ring holds the last TRACE_RING_SIZE
+    char         name[32];
+};
+
+ThreadRing s_rings[TRACE_MAX_THREADS];
+int        s_numRings;
+volatile int s_session;     // the open trace, 0 when none
+int        s_lastSession;   // incremented by each traceOpen(), invalidates the rings claimed before
+int        s_dropped;       // events of threads beyond TRACE_MAX_THREADS
+int        s_tracing;
+FILE*      s_file;
+int64_t    s_base;
+
+TRACE_TLS int  t_session;       // the trace this thread records into
+TRACE_TLS int  t_slot;
+TRACE_TLS int  t_ringSession;   // the trace t_slot was claimed in
+TRACE_TLS char t_name[32];
+
+/* returns the ring of the calling thread, claiming one on its first event of
+ * this trace */
+ThreadRing* threadRing()
+{
+    if (t_ringSession != t_session)
+    {
+        t_ringSession = t_session;
+        t_slot = ATOMIC_INC(&s_numRings) - 1;
+        if (t_slot < TRACE_MAX_THREADS)
+        {
+            ThreadRing& ring = s_rings[t_slot];
+            if (!ring.records)
+                ring.records = X265_MALLOC(TraceRecord, TRACE_RING_SIZE);
+            ring.count = 0;
+            strcpy(ring.name, t_name);
+        }
+    }
+    if (t_slot >= TRACE_MAX_THREADS || !s_rings[t_slot].records)
+        return NULL;
+    return &s_rings[t_slot];
+}
+
+}
+
+namespace X265_NS {
+
+int64_t traceTime()
+{
+#if _WIN32
+    static LARGE_INTEGER freq;
+    LARGE_INTEGER t;
+    if (!freq.QuadPart)
+        QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&t);
+    return (int64_t)((double)t.QuadPart * 1e9 / (double)freq.QuadPart);
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+#endif
+}
+
+bool traceEnabled()
+{
+    return t_session && t_session == s_session;
+}
+
+int traceSession()
+{
+    return t_session;
+}
+
+void traceSetSession(int session)
+{
+    t_session = session;
+}
+
+void traceEvent(int event, int64_t start)
+{
+    int64_t end = traceTime();
+    if (!traceEnabled())
+        return;
+
+    ThreadRing* ring = threadRing();
+    if (!ring)
+    {
+        ATOMIC_INC(&s_dropped);
+        return;
+    }
+    TraceRecord& rec = ring->records[ring->count & (TRACE_RING_SIZE - 1)];
+    rec.start = start;
+    rec.duration = end - start;
+    rec.event = event;
+    ring->count++;
+}
+
+int traceOpen(const char* filename)
+{
+    if (ATOMIC_OR(&s_tracing, 1))
+        return 0;
+
+    s_file = x265_fopen(filename, "wb");
+    if (!s_file)
+    {
+        s_tracing = 0;
+        return 0;
+    }
+    s_numRings = 0;
+    s_dropped = 0;
+    s_base = traceTime();
+    s_session = ++s_lastSession;
+    return s_session;
+}
+
+void traceClose()
+{
+    if (!s_file)
+        return;
+    s_session = 0;
+
+    /* complete events, one track per thread. Timestamps are microseconds
+     * from traceOpen() */
+    fprintf(s_file, "{\"traceEvents\":[\n");
+    int numRings = X265_MIN(s_numRings, TRACE_MAX_THREADS);
+    int64_t overwritten = 0;
+    for (int i = 0; i < numRings; i++)
+    {
+        ThreadRing& ring = s_rings[i];
+        if (ring.name[0])
+            fprintf(s_file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+                    i ? ",\n" : "", i + 1, ring.name);
+        else
+            fprintf(s_file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"Thread %d\"}}",
+                    i ? ",\n" : "", i + 1, i + 1);
+        if (!ring.records)
+            continue;
+
+        uint32_t count = ring.count;
+        uint32_t kept = X265_MIN(count, (uint32_t)TRACE_RING_SIZE);
+        overwritten += count - kept;
+        for (uint32_t n = count - kept; n != count; n++)
+        {
+            const TraceRecord& rec = ring.records[n & (TRACE_RING_SIZE - 1)];
+            fprintf(s_file, ",\n{\"name\":\"%s\",\"cat\":\"x265\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                    eventNames[rec.event], i + 1, (rec.start - s_base) / 1000.0, rec.duration / 1000.0);
+        }
+        X265_FREE(ring.records);
+        ring.records = NULL;
+    }
+    fprintf(s_file, "\n],\n\"displayTimeUnit\":\"ms\",\n\"otherData\":{\"version\":\"%s\",\"overwritten_events\":%lld,\"dropped_events\":%d}}\n",
+            x265_version_str, (long long)overwritten, s_dropped);
+    fclose(s_file);
+    s_file = NULL;
+    s_tracing = 0;
+}
+
+void traceSetThreadName(const char *name, int id)
+{
+    snprintf(t_name, sizeof(t_name), "%s %d", name, id);
+    if (traceEnabled())
+    {
+        ThreadRing* ring = threadRing();
+        if (ring)
+            strcpy(ring->name, t_name);
+    }
+}
+
+}
@@ -0,0 +1,82 @@
+/*****************************************************************************
+ * Copyright (C) 2013-2020 MulticoreWare, Inc
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02111, USA.
+ *
+ * This program is also available under a commercial proprietary license.
+ * For more information, contact us at license @ x265.com.
+ *****************************************************************************/
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdint.h>
+
+namespace X265_NS {
+
+#define CPU_EVENT(x) x,
+enum TraceEventsEnum
+{
+#include "../cpuEvents.h"
+    NUM_TRACE_EVENTS
+};
+#undef CPU_EVENT
+
+/* monotonic time in nanoseconds */
+int64_t traceTime();
+
+/* true if the calling thread belongs to the open trace */
+bool traceEnabled();
+
+/* appends an event that began at start and ends now to the ring of the
+ * calling thread */
+void traceEvent(int event, int64_t start);
+
+struct TraceScopeEvent
+{
+    int     m_event;
+    int64_t m_start;
+
+    TraceScopeEvent(int e) : m_event(e), m_start(traceEnabled() ? traceTime() : 0) {}
+    ~TraceScopeEvent()     { if (m_start) traceEvent(m_event, m_start); }
+};
+
+/* the trace the calling thread records into, 0 for none. A Thread inherits
+ * the session of the thread which started it */
+int  traceSession();
+void traceSetSession(int session);
+
+/* records the calling thread into session until the end of the scope */
+struct TraceSessionScope
+{
+    int m_prev;
+
+    TraceSessionScope(int session) : m_prev(traceSession()) { traceSetSession(session); }
+    ~TraceSessionScope()                                     { traceSetSession(m_prev); }
+};
+
+/* starts a trace recorded by the threads of its session, returns the session
+ * or 0 if the file cannot be written or another encoder is already tracing */
+int traceOpen(const char* filename);
+
+/* stops recording, writes the events in Chrome trace JSON and frees the
+ * rings. Every thread of the session must have been stopped */
+void traceClose();
+
+void traceSetThreadName(const char* name, int id);
+
+}
+
+#endif
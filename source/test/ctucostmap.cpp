@@ -0,0 +1,314 @@
+/*****************************************************************************
+ * Copyright (C) 2013-2020 MulticoreWare, Inc
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02111, USA.
+ *
+ * This program is also available under a commercial proprietary license.
+ * For more information, contact us at license @ x265.com.
+ *****************************************************************************/
+
+/* Renders the per-CTU cost map written by --ctu-cost-map: a summary line per
+ * frame, an ASCII heatmap of one metric over the CTU grid, the most expensive
+ * CTUs, and optionally a PPM image of the heatmap */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <vector>
+#include <algorithm>
+
+namespace {
+
+enum Metric
+{
+    WALL_TIME,
+    RD_EVALS,
+    ME_SEARCHES,
+    TOTAL_BITS,
+    NUM_METRICS
+};
+
+const char *metricNames[NUM_METRICS] = { "time", "rd", "me", "bits" };
+
+/* matches FrameData::CTUCost */
+struct CTUCost
+{
+    uint32_t value[NUM_METRICS];
+};
+
+struct MapFrame
+{
+    int32_t poc;
+    int32_t encodeOrder;
+    int32_t sliceType;
+    std::vector<CTUCost> ctus;
+};
+
+struct HotCTU
+{
+    uint64_t value;
+    uint32_t addr;
+
+    bool operator<(const HotCTU& other) const { return value > other.value; }
+};
+
+/* darkest to brightest, one symbol per tenth of the maximum */
+const char shades[] = " .:-=+*#%@";
+
+void usage(const char* name)
+{
+    printf("usage: %s <map.ctucost> [options]\n\n", name);
+    printf("   --metric time|rd|me|bits   Cost shown in the heatmap. Default time\n");
+    printf("   --frame N                  Only the frame of encode order N, else the sum of all frames\n");
+    printf("   --top N                    Most expensive CTUs listed. Default 10\n");
+    printf("   --ppm <filename>           Also write the heatmap as a PPM image\n");
+    printf("   --scale N                  PPM pixels per CTU side. Default 8\n");
+    printf("   --quiet                    No per-frame summary\n");
+}
+
+/* black through red and yellow to white */
+void heatColor(double t, unsigned char rgb[3])
+{
+    double r = t * 3, g = t * 3 - 1, b = t * 3 - 2;
+    rgb[0] = (unsigned char)(255 * (r < 0 ? 0 : r > 1 ? 1 : r));
+    rgb[1] = (unsigned char)(255 * (g < 0 ? 0 : g > 1 ? 1 : g));
+    rgb[2] = (unsigned char)(255 * (b < 0 ? 0 : b > 1 ? 1 : b));
+}
+
+bool writePPM(const char* filename, const std::vector<uint64_t>& grid, uint64_t maxValue, uint32_t cols, uint32_t rows, int scale)
+{
+    FILE* f = fopen(filename, "wb");
+    if (!f)
+        return false;
+
+    fprintf(f, "P6\n%u %u\n255\n", cols * scale, rows * scale);
+    std::vector<unsigned char> line(cols * scale * 3);
+    for (uint32_t y = 0; y < rows; y++)
+    {
+        for (uint32_t x = 0; x < cols; x++)
+        {
+            unsigned char rgb[3];
+            heatColor(maxValue ? (double)grid[y * cols + x] / maxValue : 0, rgb);
+            for (int i = 0; i < scale; i++)
+                memcpy(&line[(x * scale + i) * 3], rgb, 3);
+        }
+        for (int i = 0; i < scale; i++)
+            fwrite(&line[0], 1, line.size(), f);
+    }
+    bool bError = ferror(f) != 0;
+    fclose(f);
+    return !bError;
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+    const char* input = NULL;
+    const char* ppm = NULL;
+    int metric = WALL_TIME;
+    int frameSel = -1;
+    int top = 10;
+    int scale = 8;
+    bool bQuiet = false;
+
+    for (int i = 1; i < argc; i++)
+    {
+        const char* name = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : NULL;
+        if (!strcmp(name, "--help") || !strcmp(name, "-h"))
+        {
+            usage(argv[0]);
+            return 0;
+        }
+        else if (!strcmp(name, "--quiet"))
+        {
+            bQuiet = true;
+            continue;
+        }
+        else if (name[0] != '-')
+        {
+            input = name;
+            continue;
+        }
+        else if (!value)
+        {
+            printf("option %s requires a value\n", name);
+            return 1;
+        }
+
+        if (!strcmp(name, "--metric"))
+        {
+            for (metric = 0; metric < NUM_METRICS; metric++)
+                if (!strcmp(value, metricNames[metric]))
+                    break;
+            if (metric == NUM_METRICS)
+            {
+                printf("unknown metric %s\n", value);
+                return 1;
+            }
+        }
+        else if (!strcmp(name, "--frame"))
+            frameSel = atoi(value);
+        else if (!strcmp(name, "--top"))
+            top = atoi(value);
+        else if (!strcmp(name, "--ppm"))
+            ppm = value;
+        else if (!strcmp(name, "--scale"))
+            scale = atoi(value) > 0 ? atoi(value) : 1;
+        else
+        {
+            printf("unknown option %s\n", name);
+            usage(argv[0]);
+            return 1;
+        }
+        i++;
+    }
+
+    if (!input)
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    FILE* f = fopen(input, "rb");
+    if (!f)
+    {
+        printf("unable to open %s\n", input);
+        return 1;
+    }
+
+    /* version, CTU size, width, height, columns, rows */
+    char magic[8];
+    uint32_t header[6];
+    if (fread(magic, 1, 8, f) != 8 || memcmp(magic, "x265ctu", 8) ||
+        fread(header, sizeof(uint32_t), 6, f) != 6 || header[0] != 1 || !header[4] || !header[5])
+    {
+        printf("%s is not a version 1 CTU cost map\n", input);
+        fclose(f);
+        return 1;
+    }
+    const uint32_t ctuSize = header[1], cols = header[4], rows = header[5];
+    const uint32_t numCTUs = cols * rows;
+
+    std::vector<MapFrame> frames;
+    for (;;)
+    {
+        MapFrame frame;
+        int32_t frameHeader[3];
+        if (fread(frameHeader, sizeof(int32_t), 3, f) != 3)
+            break;
+        frame.poc = frameHeader[0];
+        frame.encodeOrder = frameHeader[1];
+        frame.sliceType = frameHeader[2];
+        frame.ctus.resize(numCTUs);
+        if (fread(&frame.ctus[0], sizeof(CTUCost), numCTUs, f) != numCTUs)
+        {
+            printf("warning: %s is truncated after %d frames\n", input, (int)frames.size());
+            break;
+        }
+        frames.push_back(frame);
+    }
+    fclose(f);
+
+    printf("%s: %ux%u, %ux%u CTUs of %u, %d frames\n", input, header[2], header[3], cols, rows, ctuSize, (int)frames.size());
+
+    if (!bQuiet)
+        printf("\n enc   poc type   time(ms)     rd evals  me searches         bits  hottest CTU\n");
+
+    std::vector<uint64_t> grid(numCTUs, 0);
+    uint64_t total[NUM_METRICS] = { 0 };
+    int numSelected = 0;
+    for (size_t n = 0; n < frames.size(); n++)
+    {
+        const MapFrame& frame = frames[n];
+        uint64_t sum[NUM_METRICS] = { 0 };
+        uint32_t hottest = 0;
+        for (uint32_t addr = 0; addr < numCTUs; addr++)
+        {
+            for (int m = 0; m < NUM_METRICS; m++)
+                sum[m] += frame.ctus[addr].value[m];
+            if (frame.ctus[addr].value[metric] > frame.ctus[hottest].value[metric])
+                hottest = addr;
+        }
+        if (!bQuiet)
+            printf("%4d %5d    %c %10.2f %12llu %12llu %12llu  %u (%u,%u)\n", frame.encodeOrder, frame.poc, (char)frame.sliceType,
+                   sum[WALL_TIME] / 1000.0, (unsigned long long)sum[RD_EVALS], (unsigned long long)sum[ME_SEARCHES],
+                   (unsigned long long)sum[TOTAL_BITS], hottest, hottest % cols, hottest / cols);
+
+        if (frameSel >= 0 && frame.encodeOrder != frameSel)
+            continue;
+        numSelected++;
+        for (int m = 0; m < NUM_METRICS; m++)
+            total[m] += sum[m];
+        for (uint32_t addr = 0; addr < numCTUs; addr++)
+            grid[addr] += frame.ctus[addr].value[metric];
+    }
+
+    if (!numSelected)
+    {
+        printf("no frame selected\n");
+        return 1;
+    }
+
+    if (frameSel >= 0)
+        printf("\n%s of frame %d:", metricNames[metric], frameSel);
+    else
+        printf("\n%s of %d frames:", metricNames[metric], numSelected);
+    printf(" time %.2f ms, %llu rd evals, %llu me searches, %llu bits\n\n", total[WALL_TIME] / 1000.0,
+           (unsigned long long)total[RD_EVALS], (unsigned long long)total[ME_SEARCHES], (unsigned long long)total[TOTAL_BITS]);
+
+    uint64_t maxValue = *std::max_element(grid.begin(), grid.end());
+    for (uint32_t y = 0; y < rows; y++)
+    {
+        printf("  |");
+        for (uint32_t x = 0; x < cols; x++)
+        {
+            int shade = maxValue ? (int)(grid[y * cols + x] * 9 / maxValue) : 0;
+            putchar(shades[shade]);
+            putchar(shades[shade]);
+        }
+        printf("|\n");
+    }
+
+    std::vector<HotCTU> hot(numCTUs);
+    for (uint32_t addr = 0; addr < numCTUs; addr++)
+    {
+        hot[addr].value = grid[addr];
+        hot[addr].addr = addr;
+    }
+    std::stable_sort(hot.begin(), hot.end());
+    top = std::min(top, (int)numCTUs);
+    if (top > 0)
+    {
+        uint64_t sum = total[metric] ? total[metric] : 1;
+        printf("\n  CTU   col row  %12s  share\n", metricNames[metric]);
+        for (int i = 0; i < top; i++)
+            printf("%5u %5u %3u  %12llu  %4.1f%%\n", hot[i].addr, hot[i].addr % cols, hot[i].addr / cols,
+                   (unsigned long long)hot[i].value, 100.0 * hot[i].value / sum);
+    }
+
+    if (ppm)
+    {
+        if (!writePPM(ppm, grid, maxValue, cols, rows, scale))
+        {
+            printf("unable to write %s\n", ppm);
+            return 1;
+        }
+        printf("\nheatmap written to %s\n", ppm);
+    }
+    return 0;
+}
@@ -0,0 +1,459 @@
+/*****************************************************************************
+ * Copyright (C) 2013-2020 MulticoreWare, Inc
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02111, USA.
+ *
+ * This program is also available under a commercial proprietary license.
+ * For more information, contact us at license @ x265.com.
+ *****************************************************************************/
+
+#include "encoderbench.h"
+#include "x265.h"
+
+#if DETAILED_CU_STATS
+#include "encoder.h"
+#include "frameencoder.h"
+#include "slicetype.h"
+#endif
+
+#define BENCH_FPS 30
+
+namespace {
+/* the peak RSS of each run is measured by resetting the high water mark of
+ * the process, which only Linux supports */
+bool resetPeakRSS()
+{
+#if __linux__
+    FILE* f = fopen("/proc/self/clear_refs", "w");
+    if (f)
+    {
+        bool bOk = fputs("5", f) >= 0;
+        bOk &= !fclose(f);
+        return bOk;
+    }
+#endif
+    return false;
+}
+
+int64_t peakRSS()
+{
+#if __linux__
+    FILE* f = fopen("/proc/self/status", "r");
+    if (f)
+    {
+        char line[256];
+        long kb = -1;
+        while (fgets(line, sizeof(line), f))
+        {
+            if (sscanf(line, "VmHWM: %ld", &kb) == 1)
+                break;
+        }
+        fclose(f);
+        if (kb >= 0)
+            return kb;
+    }
+#endif
+    return -1;
+}
+
+/* the synthetic clip pans over a texture with detail at several scales, so
+ * motion search, intra and RDO all have work to do */
+void fillTexture(uint8_t* plane, int width, int height, int seed)
+{
+    for (int y = 0; y < height; y++)
+    {
+        for (int x = 0; x < width; x++)
+        {
+            /* unsigned, the hashes wrap */
+            uint32_t coarse = (((uint32_t)x >> 4) * 73856093u) ^ (((uint32_t)y >> 4) * 19349663u) ^ (uint32_t)seed;
+            uint32_t fine = ((uint32_t)x * 83492791u) ^ ((uint32_t)y * 2654435761u);
+            coarse = (coarse ^ (coarse >> 13)) * 0x5bd1e995;
+            fine = (fine ^ (fine >> 15)) * 0x5bd1e995;
+            int ramp = ((x + 2 * y) >> 2) & 63;
+            plane[y * width + x] = (uint8_t)(48 + ramp + ((coarse >> 24) & 95) + ((fine >> 28) & 7));
+        }
+    }
+}
+
+void writeJsonString(FILE* f, const char* str)
+{
+    fputc('"', f);
+    for (; *str; str++)
+    {
+        if (*str == '"' || *str == '\\')
+            fputc('\\', f);
+        fputc(*str, f);
+    }
+    fputc('"', f);
+}
+
+bool parseList(const char* str, int* values, int& count, bool bResolution, int* heights)
+{
+    count = 0;
+    while (*str)
+    {
+        if (count == ENCODER_BENCH_MAX_LIST)
+            return false;
+        char* end;
+        values[count] = (int)strtol(str, &end, 10);
+        if (bResolution)
+        {
+            if (*end != 'x')
+                return false;
+            heights[count] = (int)strtol(end + 1, &end, 10);
+            if (heights[count] <= 0)
+                return false;
+        }
+        if (end == str || values[count] <= 0 || (*end && *end != ','))
+            return false;
+        count++;
+        str = *end ? end + 1 : end;
+    }
+    return count > 0;
+}
+}
+
+EncoderBench::EncoderBench()
+    : m_presets(NULL)
+    , m_resolutions("416x240,1280x720")
+    , m_threads("1")
+    , m_input(NULL)
+    , m_json(NULL)
+    , m_frames(60)
+    , m_cpuid(-1)
+    , m_numPresets(0)
+    , m_numResolutions(0)
+    , m_numThreads(0)
+{
+}
+
+bool EncoderBench::parseLists()
+{
+    if (strlen(m_presets) >= sizeof(m_presetNames))
+        return false;
+    strcpy(m_presetNames, m_presets);
+
+    x265_param* param = x265_param_alloc();
+    char* name = m_presetNames;
+    for (;;)
+    {
+        char* next = strchr(name, ',');
+        if (next)
+            *next = 0;
+        if (m_numPresets == ENCODER_BENCH_MAX_LIST || x265_param_default_preset(param, name, NULL) < 0)
+        {
+            printf("Invalid preset: %s\n", name);
+            x265_param_free(param);
+            return false;
+        }
+        m_presetList[m_numPresets++] = name;
+        if (!next)
+            break;
+        name = next + 1;
+    }
+    x265_param_free(param);
+
+    if (!parseList(m_resolutions, m_width, m_numResolutions, true, m_height))
+    {
+        printf("Invalid resolution list: %s\n", m_resolutions);
+        return false;
+    }
+    if (!parseList(m_threads, m_threadList, m_numThreads, false, NULL))
+    {
+        printf("Invalid thread list: %s\n", m_threads);
+        return false;
+    }
+    /* the input file has the first resolution of the list */
+    if (m_input)
+        m_numResolutions = 1;
+    if (m_frames <= 0)
+    {
+        printf("Invalid frame count: %d\n", m_frames);
+        return false;
+    }
+    return true;
+}
+
+bool EncoderBench::run()
+{
+    if (!parseLists())
+        return false;
+
+    FILE* json = NULL;
+    if (m_json)
+    {
+        json = x265_fopen(m_json, "w");
+        if (!json)
+        {
+            printf("Unable to open %s\n", m_json);
+            return false;
+        }
+    }
+
+    int count = m_numPresets * m_numResolutions * m_numThreads;
+    Result* results = new Result[count];
+    memset(results, 0, sizeof(Result) * count);
+
+    printf("x265 encoder benchmark, %s %dbit, %d frames of %s\n\n", x265_version_str, X265_DEPTH, m_frames,
+           m_input ? m_input : "synthetic video");
+    printf("%-10s %11s %7s %9s %6s %10s %10s %10s %10s %10s\n", "preset", "resolution", "threads", "fps", "scale",
+           "kbps", "la-wait ms", "ctu ms", "stall ms", "peak kB");
+
+    bool bOk = true;
+    Result* res = results;
+    for (int p = 0; p < m_numPresets && bOk; p++)
+    {
+        for (int r = 0; r < m_numResolutions && bOk; r++)
+        {
+            const Result* first = res;
+            for (int t = 0; t < m_numThreads; t++, res++)
+            {
+                res->preset = m_presetList[p];
+                res->width = m_width[r];
+                res->height = m_height[r];
+                res->threads = m_threadList[t];
+                res->frames = m_frames;
+                if (!encode(*res))
+                {
+                    bOk = false;
+                    break;
+                }
+
+                res->efficiency = (res->fps / first->fps) / ((double)res->threads / first->threads);
+                printf("%-10s %5dx%-5d %7d %9.2f %5.1f%% %10.2f %10.2f %10.2f %10.2f %10d\n", res->preset,
+                       res->width, res->height, res->threads, res->fps, 100.0 * res->efficiency, res->kbps,
+                       res->decideWait / res->frames, res->ctuTime / res->frames, res->stallTime / res->frames, (int)res->peakRSS);
+                fflush(stdout);
+            }
+        }
+    }
+
+    if (json)
+    {
+        writeJson(json, results, (int)(res - results));
+        fclose(json);
+    }
+    delete [] results;
+    printf("\n");
+    return bOk;
+}
+
+bool EncoderBench::encode(Result& res)
+{
+    x265_param* param = x265_param_alloc();
+    x265_param_default_preset(param, res.preset, NULL);
+    param->sourceWidth = res.width;
+    param->sourceHeight = res.height;
+    param->fpsNum = BENCH_FPS;
+    param->fpsDenom = 1;
+    param->totalFrames = res.frames;
+    param->internalCsp = X265_CSP_I420;
+    param->logLevel = X265_LOG_ERROR;
+    param->bEnablePsnr = param->bEnableSsim = 0;
+    if (m_cpuid >= 0)
+        param->cpuid = m_cpuid;
+
+    /* the frame encoders only time their stages for CSV level 2 */
+    param->csvLogLevel = 2;
+
+    char pools[16];
+    sprintf(pools, "%d", res.threads);
+    x265_param_parse(param, "pools", pools);
+
+    /* the clip pans two pixels right and one down per frame */
+    int texWidth = res.width + 2 * res.frames + 2;
+    int texHeight = res.height + res.frames + 2;
+    uint8_t* planes[3] = { NULL, NULL, NULL };
+    FILE* input = NULL;
+    size_t frameSize = (size_t)res.width * res.height * 3 / 2;
+    if (m_input)
+    {
+        input = x265_fopen(m_input, "rb");
+        planes[0] = X265_MALLOC(uint8_t, frameSize);
+    }
+    else
+    {
+        planes[0] = X265_MALLOC(uint8_t, texWidth * texHeight);
+        planes[1] = X265_MALLOC(uint8_t, (texWidth / 2) * (texHeight / 2));
+        planes[2] = X265_MALLOC(uint8_t, (texWidth / 2) * (texHeight / 2));
+        if (planes[1] && planes[2])
+        {
+            fillTexture(planes[0], texWidth, texHeight, 1);
+            fillTexture(planes[1], texWidth / 2, texHeight / 2, 2);
+            fillTexture(planes[2], texWidth / 2, texHeight / 2, 3);
+        }
+    }
+    if (!planes[0] || (!m_input && (!planes[1] || !planes[2])) || (m_input && !input))
+    {
+        printf("Unable to %s\n", m_input ? "read the input file" : "allocate the synthetic clip");
+        if (input)
+            fclose(input);
+        X265_FREE(planes[0]);
+        X265_FREE(planes[1]);
+        X265_FREE(planes[2]);
+        x265_param_free(param);
+        return false;
+    }
+
+    bool bHavePeakRSS = resetPeakRSS();
+    x265_encoder* encoder = x265_encoder_open(param);
+    if (!encoder)
+    {
+        printf("Unable to open the encoder with preset %s at %dx%d\n", res.preset, res.width, res.height);
+        if (input)
+            fclose(input);
+        X265_FREE(planes[0]);
+        X265_FREE(planes[1]);
+        X265_FREE(planes[2]);
+        x265_param_free(param);
+        return false;
+    }
+
+    x265_picture pic, picOut;
+    x265_picture_init(param, &pic);
+    x265_picture_init(param, &picOut);
+    pic.bitDepth = 8;
+    pic.colorSpace = X265_CSP_I420;
+
+    x265_nal* nal;
+    uint32_t nalCount;
+    uint64_t bytes = 0;
+    int encoded = 0;
+    int64_t startTime = x265_mdate();
+    for (int i = 0;; i++)
+    {
+        x265_picture* picIn = NULL;
+        if (i < res.frames && input)
+        {
+            if (fread(planes[0], frameSize, 1, input) == 1)
+            {
+                pic.planes[0] = planes[0];
+                pic.planes[1] = planes[0] + res.width * res.height;
+                pic.planes[2] = planes[0] + res.width * res.height * 5 / 4;
+                pic.stride[0] = res.width;
+                pic.stride[1] = pic.stride[2] = res.width / 2;
+                picIn = &pic;
+            }
+            else
+                res.frames = i;
+        }
+        else if (i < res.frames)
+        {
+            int x = 2 * i, y = i & ~1;
+            pic.planes[0] = planes[0] + y * texWidth + x;
+            pic.planes[1] = planes[1] + (y / 2) * (texWidth / 2) + x / 2;
+            pic.planes[2] = planes[2] + (y / 2) * (texWidth / 2) + x / 2;
+            pic.stride[0] = texWidth;
+            pic.stride[1] = pic.stride[2] = texWidth / 2;
+            picIn = &pic;
+        }
+        if (picIn)
+            pic.pts = i;
+
+        int ret = x265_encoder_encode(encoder, &nal, &nalCount, picIn, &picOut);
+        if (ret < 0)
+            break;
+        for (uint32_t n = 0; n < nalCount; n++)
+            bytes += nal[n].sizeBytes;
+        if (ret)
+        {
+            const x265_frame_stats& stats = picOut.frameData;
+            res.decideWait += stats.decideWaitTime;
+            res.row0Wait += stats.row0WaitTime;
+            res.refWait += stats.refWaitWallTime;
+            res.ctuTime += stats.totalCTUTime;
+            res.stallTime += stats.stallTime;
+            res.wallTime += stats.wallTime;
+            encoded++;
+        }
+        else if (!picIn)
+            break;
+    }
+    res.elapsed = (double)(x265_mdate() - startTime) / 1000000;
+    res.peakRSS = bHavePeakRSS ? peakRSS() : -1;
+
+#if DETAILED_CU_STATS
+#define ELAPSED_MSEC(val) ((double)(val) / 1000)
+    Encoder* enc = static_cast<Encoder*>(encoder);
+    CUStats cuStats;
+    for (int i = 0; i < enc->m_param->frameNumThreads; i++)
+    {
+        /* accumulate() clears its source, the encoder still logs these */
+        CUStats frameStats = enc->m_frameEncoder[i]->m_cuStats;
+        cuStats.accumulate(frameStats, *enc->m_param);
+    }
+
+    int64_t batchElapsedTime, coopSliceElapsedTime;
+    uint64_t batchCount, coopSliceCount;
+    enc->m_lookahead->getWorkerStats(batchElapsedTime, batchCount, coopSliceElapsedTime, coopSliceCount);
+    res.lookahead = ELAPSED_MSEC(enc->m_lookahead->m_slicetypeDecideElapsedTime + enc->m_lookahead->m_preLookaheadElapsedTime +
+                                 batchElapsedTime + coopSliceElapsedTime);
+    res.intraAnalysis = ELAPSED_MSEC(cuStats.intraAnalysisElapsedTime);
+    res.motionEstimation = ELAPSED_MSEC(cuStats.motionEstimationElapsedTime + cuStats.pmeTime);
+    for (uint32_t i = 0; i <= enc->m_param->maxCUDepth; i++)
+    {
+        res.interRDO += ELAPSED_MSEC(cuStats.interRDOElapsedTime[i]);
+        res.intraRDO += ELAPSED_MSEC(cuStats.intraRDOElapsedTime[i]);
+    }
+    res.loopFilter = ELAPSED_MSEC(cuStats.loopFilterElapsedTime);
+    res.weightAnalysis = ELAPSED_MSEC(cuStats.weightAnalyzeTime);
+    res.entropy = ELAPSED_MSEC(cuStats.entropyElapsedTime);
+    res.rateControl = ELAPSED_MSEC(cuStats.rateControlElapsedTime);
+#undef ELAPSED_MSEC
+#endif
+
+    x265_encoder_close(encoder);
+    x265_param_free(param);
+    if (input)
+        fclose(input);
+    X265_FREE(planes[0]);
+    X265_FREE(planes[1]);
+    X265_FREE(planes[2]);
+
+    if (encoded != res.frames || !encoded)
+    {
+        printf("Encoding with preset %s at %dx%d failed\n", res.preset, res.width, res.height);
+        return false;
+    }
+    res.fps = res.frames / res.elapsed;
+    res.kbps = bytes * 8.0 * BENCH_FPS / res.frames / 1000;
+    return true;
+}
+
+void EncoderBench::writeJson(FILE* f, const Result* results, int count)
+{
+    fprintf(f, "{\n  \"version\": \"%s\",\n  \"bit_depth\": %d,\n  \"input\": ", x265_version_str, X265_DEPTH);
+    writeJsonString(f, m_input ? m_input : "synthetic");
+    fprintf(f, ",\n  \"runs\": [");
+    for (int i = 0; i < count; i++)
+    {
+        const Result& res = results[i];
+        fprintf(f, "%s\n    {\n", i ? "," : "");
+        fprintf(f, "      \"preset\": \"%s\", \"width\": %d, \"height\": %d, \"threads\": %d, \"frames\": %d,\n",
+                res.preset, res.width, res.height, res.threads, res.frames);
+        fprintf(f, "      \"seconds\": %.4f, \"fps\": %.3f, \"kbps\": %.2f, \"scaling_efficiency\": %.4f, \"peak_rss_kb\": %d,\n",
+                res.elapsed, res.fps, res.kbps, res.efficiency, (int)res.peakRSS);
+        fprintf(f, "      \"stages_ms\": { \"lookahead_wait\": %.3f, \"row0_wait\": %.3f, \"ref_wait\": %.3f, \"ctu\": %.3f, \"stall\": %.3f, \"frame_wall\": %.3f }",
+                res.decideWait, res.row0Wait, res.refWait, res.ctuTime, res.stallTime, res.wallTime);
+#if DETAILED_CU_STATS
+        fprintf(f, ",\n      \"worker_ms\": { \"lookahead\": %.3f, \"intra_analysis\": %.3f, \"motion_estimation\": %.3f, \"inter_rdo\": %.3f, \"intra_rdo\": %.3f,\n"
+                "                     \"loop_filter\": %.3f, \"weight_analysis\": %.3f, \"entropy\": %.3f, \"rate_control\": %.3f }",
+                res.lookahead, res.intraAnalysis, res.motionEstimation, res.interRDO, res.intraRDO,
+                res.loopFilter, res.weightAnalysis, res.entropy, res.rateControl);
+#endif
+        fprintf(f, "\n    }");
+    }
+    fprintf(f, "\n  ]\n}\n");
+}
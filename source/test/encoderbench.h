@@ -0,0 +1,105 @@
+/*****************************************************************************
+ * Copyright (C) 2013-2020 MulticoreWare, Inc
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02111, USA.
+ *
+ * This program is also available under a commercial proprietary license.
+ * For more information, contact us at license @ x265.com.
+ *****************************************************************************/
+
+#ifndef _ENCODERBENCH_H_
+#define _ENCODERBENCH_H_ 1
+
+#include "common.h"
+
+#define ENCODER_BENCH_MAX_LIST 16
+
+using namespace X265_NS;
+
+/* End to end benchmark of the encoder over a matrix of presets, resolutions
+ * and thread pool sizes. Each run encodes a panning synthetic clip, or a raw
+ * 8bit 4:2:0 file, and reports throughput, the frame encoder stage times the
+ * library keeps, peak RSS and the scaling over the first pool size */
+class EncoderBench
+{
+public:
+
+    const char* m_presets;     // comma separated preset names
+    const char* m_resolutions; // comma separated WxH, the input file has the first one
+    const char* m_threads;     // comma separated pool thread counts
+    const char* m_input;       // raw 8bit 4:2:0 input, else synthetic
+    const char* m_json;        // machine readable report
+    int         m_frames;
+    int         m_cpuid;       // from --cpuid, -1 for the detected CPU
+
+    EncoderBench();
+
+    /* returns false if the matrix is invalid or an encode fails */
+    bool run();
+
+protected:
+
+    struct Result
+    {
+        const char* preset;
+        int         width;
+        int         height;
+        int         threads;
+        int         frames;
+        double      elapsed;     // seconds from the first picture until the flush completed
+        double      fps;
+        double      kbps;
+        double      efficiency;  // fps per thread relative to the first pool size
+        int64_t     peakRSS;     // kB, -1 if unknown
+
+        /* sums of the per-frame statistics, in ms */
+        double      decideWait;
+        double      row0Wait;
+        double      refWait;
+        double      ctuTime;
+        double      stallTime;
+        double      wallTime;
+
+#if DETAILED_CU_STATS
+        /* worker and frame thread times of each stage, in ms */
+        double      lookahead;
+        double      intraAnalysis;
+        double      motionEstimation;
+        double      interRDO;
+        double      intraRDO;
+        double      loopFilter;
+        double      weightAnalysis;
+        double      entropy;
+        double      rateControl;
+#endif
+    };
+
+    const char* m_presetList[ENCODER_BENCH_MAX_LIST];
+    int         m_numPresets;
+    int         m_width[ENCODER_BENCH_MAX_LIST];
+    int         m_height[ENCODER_BENCH_MAX_LIST];
+    int         m_numResolutions;
+    int         m_threadList[ENCODER_BENCH_MAX_LIST];
+    int         m_numThreads;
+    char        m_presetNames[256];
+
+    bool parseLists();
+
+    bool encode(Result& res);
+
+    void writeJson(FILE* f, const Result* results, int count);
+};
+
+#endif // ifndef _ENCODERBENCH_H_
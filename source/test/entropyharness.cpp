@@ -0,0 +1,124 @@
+/*****************************************************************************
+ * Copyright (C) 2013-2020 MulticoreWare, Inc
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02111, USA.
+ *
+ * This program is also available under a commercial proprietary license.
+ * For more information, contact us at license @ x265.com.
+ *****************************************************************************/
+
+#include "common.h"
+#include "entropyharness.h"
+
+using namespace X265_NS;
+
+namespace {
+
+/* a small RD trial: the handful of flags a CU/TU decision typically codes */
+void codeTrial(Entropy& coder, int seed)
+{
+    coder.codeQtCbfLuma(seed & 1, seed & 2);
+    coder.codeQtCbfChroma((seed >> 2) & 1, (seed >> 3) & 3);
+    coder.codeTransformSubdivFlag((seed >> 5) & 1, (seed >> 6) % 3);
+    coder.codePredMode((seed >> 8) & 1 ? MODE_INTRA : MODE_INTER);
+    coder.codeQtRootCbf((seed >> 9) & 1);
+}
+
+/* RD trial, reload of the starting snapshot and RDOQ rate estimation, once
+ * into the coder's own table (which may be reused) and once into a table the
+ * coder does not own (always rebuilt, as before snapshot tracking) */
+void trialEstBit(Entropy* coder, const Entropy* snapshot, int seed)
+{
+    codeTrial(*coder, seed);
+    coder->load(*snapshot);
+    coder->estBit(coder->m_estBitsSbac, 4, true);
+}
+
+EstBitsSbac g_estBits;
+
+void trialEstBitUncached(Entropy* coder, const Entropy* snapshot, int seed)
+{
+    codeTrial(*coder, seed);
+    coder->load(*snapshot);
+    coder->estBit(g_estBits, 4, true);
+}
+}
+
+void EntropyHarness::randomizeContexts(Entropy& entropy)
+{
+    Entropy scratch;
+    for (int k = 0; k < MAX_OFF_CTX_MOD; k++)
+        scratch.m_contextState[k] = (uint8_t)(rand() % 126);
+    scratch.zeroFract();
+    entropy.load(scratch);
+}
+
+bool EntropyHarness::testCorrectness(const EncoderPrimitives&, const EncoderPrimitives&)
+{
+    for (int s = 0; s < NUM_SNAPSHOTS; s++)
+        randomizeContexts(m_snapshot[s]);
+    m_coder.zeroFract();
+
+    for (int i = 0; i < ITERS; i++)
+    {
+        Entropy& snapshot = m_snapshot[rand() % NUM_SNAPSHOTS];
+
+        switch (rand() % 8)
+        {
+        case 0:
+            /* source replaced since the last copy */
+            randomizeContexts(snapshot);
+            break;
+        case 1:
+            /* source coded into directly */
+            codeTrial(snapshot, rand());
+            break;
+        case 2:
+            /* snapshot taken from the working coder */
+            m_coder.store(snapshot);
+            break;
+        default:
+            break;
+        }
+
+        codeTrial(m_coder, rand());
+        m_coder.load(snapshot);
+        if (rand() & 1)
+            codeTrial(m_coder, rand());
+
+        uint32_t log2TrSize = 2 + rand() % 4;
+        bool bIsLuma = !!(rand() & 1);
+        m_coder.estBit(m_coder.m_estBitsSbac, log2TrSize, bIsLuma);
+
+        /* a fresh estimate on top of the same table must not change it */
+        EstBitsSbac fresh;
+        memcpy(&fresh, &m_coder.m_estBitsSbac, sizeof(fresh));
+        m_coder.estBit(fresh, log2TrSize, bIsLuma);
+
+        if (memcmp(&fresh, &m_coder.m_estBitsSbac, sizeof(fresh)))
+            return false;
+    }
+
+    return true;
+}
+
+void EntropyHarness::measureSpeed(const EncoderPrimitives&, const EncoderPrimitives&)
+{
+    randomizeContexts(m_snapshot[0]);
+    m_coder.load(m_snapshot[0]);
+
+    HPerf.header("estBit after reload");
+    REPORT_SPEEDUP(trialEstBit, trialEstBitUncached, &m_coder, &m_snapshot[0], 0x3ff);
+}
@@ -210,6 +210,30 @@ bool IntraPredHarness::check_intra_filter_primitive(const intra_filter_t ref, co
     }
     return true;
 }
+bool IntraPredHarness::check_intra_grad_hist_primitive(const intra_grad_hist_t ref, const intra_grad_hist_t opt, int width)
+{
+    uint32_t hist_c[NUM_INTRA_MODE];
+    uint32_t hist_vec[NUM_INTRA_MODE];
+    int j = 0;
+
+    for (int i = 0; i < ITERS; i++)
+    {
+        int index = rand() % TEST_CASES;
+        intptr_t stride = (rand() & 1) ? STRIDE : width;
+
+        ref(pixel_test_buff[index] + j, stride, hist_c);
+        checked(opt, pixel_test_buff[index] + j, stride, hist_vec);
+
+        if (memcmp(hist_c, hist_vec, sizeof(hist_c)))
+            return false;
+
+        reportfail();
+        j += INCR;
+    }
+
+    return true;
+}
+
 bool IntraPredHarness::testCorrectness(const EncoderPrimitives& ref, const EncoderPrimitives& opt)
 {
     for (int i = BLOCK_4x4; i <= BLOCK_32x32; i++)
@@ -254,6 +278,14 @@ bool IntraPredHarness::testCorrectness(const EncoderPrimitives& ref, const Encod
                 return false;
             }
         }
+        if (opt.cu[i].intra_grad_hist)
+        {
+            if (!check_intra_grad_hist_primitive(ref.cu[i].intra_grad_hist, opt.cu[i].intra_grad_hist, size))
+            {
+                printf("intra_grad_hist_%dx%d failed\n", size, size);
+                return false;
+            }
+        }
     }
 
     return true;
@@ -269,18 +301,18 @@ void IntraPredHarness::measureSpeed(const EncoderPrimitives& ref, const EncoderP
         const int size = (1 << (i + 2));
         if (opt.cu[i].intra_pred[PLANAR_IDX])
         {
-            printf("intra_planar_%dx%d", size, size);
+            HPerf.header("intra_planar_%dx%d", size, size);
             REPORT_SPEEDUP(opt.cu[i].intra_pred[PLANAR_IDX], ref.cu[i].intra_pred[PLANAR_IDX],
                            pixel_out_vec, FENC_STRIDE, pixel_buff + srcStride, 0, 0);
         }
         if (opt.cu[i].intra_pred[DC_IDX])
         {
-            printf("intra_dc_%dx%d[f=0]", size, size);
+            HPerf.header("intra_dc_%dx%d[f=0]", size, size);
             REPORT_SPEEDUP(opt.cu[i].intra_pred[DC_IDX], ref.cu[i].intra_pred[DC_IDX],
                 pixel_out_vec, FENC_STRIDE, pixel_buff + srcStride, 0, 0);
             if (size <= 16)
             {
-                printf("intra_dc_%dx%d[f=1]", size, size);
+                HPerf.header("intra_dc_%dx%d[f=1]", size, size);
                 REPORT_SPEEDUP(opt.cu[i].intra_pred[DC_IDX], ref.cu[i].intra_pred[DC_IDX],
                     pixel_out_vec, FENC_STRIDE, pixel_buff + srcStride, 0, 1);
             }
@@ -291,7 +323,7 @@ void IntraPredHarness::measureSpeed(const EncoderPrimitives& ref, const EncoderP
             pixel * refAbove = pixel_buff + srcStride;
             pixel * refLeft = refAbove + 3 * size;
             refLeft[0] = refAbove[0];
-            printf("intra_allangs%dx%d", size, size);
+            HPerf.header("intra_allangs%dx%d", size, size);
             REPORT_SPEEDUP(opt.cu[i].intra_pred_allangs, ref.cu[i].intra_pred_allangs,
                            pixel_out_33_vec, refAbove, refLeft, bFilter);
         }
@@ -304,15 +336,21 @@ void IntraPredHarness::measureSpeed(const EncoderPrimitives& ref, const EncoderP
                 pixel * refAbove = pixel_buff + srcStride;
                 pixel * refLeft = refAbove + 3 * width;
                 refLeft[0] = refAbove[0];
-                printf("intra_ang_%dx%d[%2d]", width, width, mode);
+                HPerf.header("intra_ang_%dx%d[%2d]", width, width, mode);
                 REPORT_SPEEDUP(opt.cu[i].intra_pred[mode], ref.cu[i].intra_pred[mode],
                                pixel_out_vec, FENC_STRIDE, pixel_buff + srcStride, mode, bFilter);
             }
         }
         if (opt.cu[i].intra_filter)
         {
-            printf("intra_filter_%dx%d", size, size);
+            HPerf.header("intra_filter_%dx%d", size, size);
             REPORT_SPEEDUP(opt.cu[i].intra_filter, ref.cu[i].intra_filter, pixel_buff, pixel_out_c);
         }
+        if (opt.cu[i].intra_grad_hist)
+        {
+            uint32_t hist[NUM_INTRA_MODE];
+            HPerf.header("intra_grad_hist_%dx%d", size, size);
+            REPORT_SPEEDUP(opt.cu[i].intra_grad_hist, ref.cu[i].intra_grad_hist, pixel_buff, STRIDE, hist);
+        }
     }
 }
@@ -54,6 +54,7 @@ protected:
     bool check_angular_primitive(const intra_pred_t ref[], const intra_pred_t opt[], int size);
     bool check_allangs_primitive(const intra_allangs_t ref, const intra_allangs_t opt, int size);
     bool check_intra_filter_primitive(const intra_filter_t ref, const intra_filter_t opt);
+    bool check_intra_grad_hist_primitive(const intra_grad_hist_t ref, const intra_grad_hist_t opt, int size);
 
 public:
 
@@ -716,14 +716,14 @@ void IPFilterHarness::measureSpeed(const EncoderPrimitives& ref, const EncoderPr
     {
         if (opt.pu[value].luma_hpp)
         {
-            printf("luma_hpp[%s]\t", lumaPartStr[value]);
+            HPerf.header("luma_hpp[%s]\t", lumaPartStr[value]);
             REPORT_SPEEDUP(opt.pu[value].luma_hpp, ref.pu[value].luma_hpp,
                 pixel_buff + srcStride, srcStride, IPF_vec_output_p, dstStride, 1);
         }
 
         if (opt.pu[value].luma_hps)
         {
-            printf("luma_hps[%s]\t", lumaPartStr[value]);
+            HPerf.header("luma_hps[%s]\t", lumaPartStr[value]);
             REPORT_SPEEDUP(opt.pu[value].luma_hps, ref.pu[value].luma_hps,
                 pixel_buff + maxVerticalfilterHalfDistance * srcStride, srcStride,
                 IPF_vec_output_s, dstStride, 1, 1);
@@ -731,7 +731,7 @@ void IPFilterHarness::measureSpeed(const EncoderPrimitives& ref, const EncoderPr
 
         if (opt.pu[value].luma_vpp)
         {
-            printf("luma_vpp[%s]\t", lumaPartStr[value]);
+            HPerf.header("luma_vpp[%s]\t", lumaPartStr[value]);
             REPORT_SPEEDUP(opt.pu[value].luma_vpp, ref.pu[value].luma_vpp,
                 pixel_buff + maxVerticalfilterHalfDistance * srcStride, srcStride,
                 IPF_vec_output_p, dstStride, 1);
@@ -739,7 +739,7 @@ void IPFilterHarness::measureSpeed(const EncoderPrimitives& ref, const EncoderPr
 
         if (opt.pu[value].luma_vps)
         {
-            printf("luma_vps[%s]\t", lumaPartStr[value]);
+            HPerf.header("luma_vps[%s]\t", lumaPartStr[value]);
             REPORT_SPEEDUP(opt.pu[value].luma_vps, ref.pu[value].luma_vps,
                 pixel_buff + maxVerticalfilterHalfDistance * srcStride, srcStride,
                 IPF_vec_output_s, dstStride, 1);
@@ -747,7 +747,7 @@ void IPFilterHarness::measureSpeed(const EncoderPrimitives& ref, const EncoderPr
 
         if (opt.pu[value].luma_vsp)
         {
-            printf("luma_vsp[%s]\t", lumaPartStr[value]);
+            HPerf.header("luma_vsp[%s]\t", lumaPartStr[value]);
             REPORT_SPEEDUP(opt.pu[value].luma_vsp, ref.pu[value].luma_vsp,
                 short_buff + maxVerticalfilterHalfDistance * srcStride, srcStride,
                 IPF_vec_output_p, dstStride, 1);
@@ -755,7 +755,7 @@ void IPFilterHarness::measureSpeed(const EncoderPrimitives& ref, const EncoderPr
 
         if (opt.pu[value].luma_vss)
         {
-            printf("luma_vss[%s]\t", lumaPartStr[value]);
+            HPerf.header("luma_vss[%s]\t", lumaPartStr[value]);
             REPORT_SPEEDUP(opt.pu[value].luma_vss, ref.pu[value].luma_vss,
                 short_buff + maxVerticalfilterHalfDistance * srcStride, srcStride,
                 IPF_vec_output_s, dstStride, 1);
@@ -763,14 +763,14 @@ void IPFilterHarness::measureSpeed(const EncoderPrimitives& ref, const EncoderPr
 
         if (opt.pu[value].luma_hvpp)
         {
-            printf("luma_hv [%s]\t", lumaPartStr[value]);
+            HPerf.header("luma_hv [%s]\t", lumaPartStr[value]);
             REPORT_SPEEDUP(opt.pu[value].luma_hvpp, ref.pu[value].luma_hvpp,
                 pixel_buff + 3 * srcStride, srcStride, IPF_vec_output_p, srcStride, 1, 3);
         }
 
         if (opt.pu[value].convert_p2s[NONALIGNED])
         {
-            printf("convert_p2s[%s]\t", lumaPartStr[value]);
+            HPerf.header("convert_p2s[%s]\t", lumaPartStr[value]);
             REPORT_SPEEDUP(opt.pu[value].convert_p2s[NONALIGNED], ref.pu[value].convert_p2s[NONALIGNED],
                 pixel_buff, srcStride,
                 IPF_vec_output_s, dstStride);
@@ -778,7 +778,7 @@ void IPFilterHarness::measureSpeed(const EncoderPrimitives& ref, const EncoderPr
 
         if (opt.pu[value].convert_p2s[ALIGNED])
         {
-            printf("convert_p2s_aligned[%s]\t", lumaPartStr[value]);
+            HPerf.header("convert_p2s_aligned[%s]\t", lumaPartStr[value]);
             REPORT_SPEEDUP(opt.pu[value].convert_p2s[ALIGNED], ref.pu[value].convert_p2s[ALIGNED],
                 pixel_buff, srcStride,
                 IPF_vec_output_s, dstStride);
@@ -792,53 +792,53 @@ void IPFilterHarness::measureSpeed(const EncoderPrimitives& ref, const EncoderPr
         {
             if (opt.chroma[csp].pu[value].filter_hpp)
             {
-                printf("chroma_hpp[%s]", chromaPartStr[csp][value]);
+                HPerf.header("chroma_hpp[%s]", chromaPartStr[csp][value]);
                 REPORT_SPEEDUP(opt.chroma[csp].pu[value].filter_hpp, ref.chroma[csp].pu[value].filter_hpp,
                     pixel_buff + srcStride, srcStride, IPF_vec_output_p, dstStride, 1);
             }
             if (opt.chroma[csp].pu[value].filter_hps)
             {
-                printf("chroma_hps[%s]", chromaPartStr[csp][value]);
+                HPerf.header("chroma_hps[%s]", chromaPartStr[csp][value]);
                 REPORT_SPEEDUP(opt.chroma[csp].pu[value].filter_hps, ref.chroma[csp].pu[value].filter_hps,
                     pixel_buff + srcStride, srcStride, IPF_vec_output_s, dstStride, 1, 1);
             }
             if (opt.chroma[csp].pu[value].filter_vpp)
             {
-                printf("chroma_vpp[%s]", chromaPartStr[csp][value]);
+                HPerf.header("chroma_vpp[%s]", chromaPartStr[csp][value]);
                 REPORT_SPEEDUP(opt.chroma[csp].pu[value].filter_vpp, ref.chroma[csp].pu[value].filter_vpp,
                     pixel_buff + maxVerticalfilterHalfDistance * srcStride, srcStride,
                     IPF_vec_output_p, dstStride, 1);
             }
             if (opt.chroma[csp].pu[value].filter_vps)
             {
-                printf("chroma_vps[%s]", chromaPartStr[csp][value]);
+                HPerf.header("chroma_vps[%s]", chromaPartStr[csp][value]);
                 REPORT_SPEEDUP(opt.chroma[csp].pu[value].filter_vps, ref.chroma[csp].pu[value].filter_vps,
                     pixel_buff + maxVerticalfilterHalfDistance * srcStride, srcStride,
                     IPF_vec_output_s, dstStride, 1);
             }
             if (opt.chroma[csp].pu[value].filter_vsp)
             {
-                printf("chroma_vsp[%s]", chromaPartStr[csp][value]);
+                HPerf.header("chroma_vsp[%s]", chromaPartStr[csp][value]);
                 REPORT_SPEEDUP(opt.chroma[csp].pu[value].filter_vsp, ref.chroma[csp].pu[value].filter_vsp,
                     short_buff + maxVerticalfilterHalfDistance * srcStride, srcStride,
                     IPF_vec_output_p, dstStride, 1);
             }
             if (opt.chroma[csp].pu[value].filter_vss)
             {
-                printf("chroma_vss[%s]", chromaPartStr[csp][value]);
+                HPerf.header("chroma_vss[%s]", chromaPartStr[csp][value]);
                 REPORT_SPEEDUP(opt.chroma[csp].pu[value].filter_vss, ref.chroma[csp].pu[value].filter_vss,
                     short_buff + maxVerticalfilterHalfDistance * srcStride, srcStride,
                     IPF_vec_output_s, dstStride, 1);
             }
             if (opt.chroma[csp].pu[value].p2s[NONALIGNED])
             {
-                printf("chroma_p2s[%s]\t", chromaPartStr[csp][value]);
+                HPerf.header("chroma_p2s[%s]\t", chromaPartStr[csp][value]);
                 REPORT_SPEEDUP(opt.chroma[csp].pu[value].p2s[NONALIGNED], ref.chroma[csp].pu[value].p2s[NONALIGNED],
                     pixel_buff, srcStride, IPF_vec_output_s, dstStride);
             }
             if (opt.chroma[csp].pu[value].p2s[ALIGNED])
             {
-                printf("chroma_p2s_aligned[%s]\t", chromaPartStr[csp][value]);
+                HPerf.header("chroma_p2s_aligned[%s]\t", chromaPartStr[csp][value]);
                 REPORT_SPEEDUP(opt.chroma[csp].pu[value].p2s[ALIGNED], ref.chroma[csp].pu[value].p2s[ALIGNED],
                     pixel_buff, srcStride, IPF_vec_output_s, dstStride);
             }
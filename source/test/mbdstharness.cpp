@@ -413,6 +413,55 @@ bool MBDstHarness::check_psyRdoQuant_primitive_avx2(psyRdoQuant_t1 ref, psyRdoQu
 
     return true;
 }
+bool MBDstHarness::check_rdoQuantLevelDist_primitive(rdoQuantLevelDist_t ref, rdoQuantLevelDist_t opt, int log2TrSize)
+{
+    int j = 0;
+    const int trSize = 1 << log2TrSize;
+    const int transformShift = MAX_TR_DYNAMIC_RANGE - X265_DEPTH - log2TrSize;
+
+    ALIGN_VAR_32(int64_t, ref_uncoded[MAX_TU_SIZE]);
+    ALIGN_VAR_32(int64_t, opt_uncoded[MAX_TU_SIZE]);
+    ALIGN_VAR_32(int64_t, ref_dist[2 * MLS_CG_BLK_SIZE]);
+    ALIGN_VAR_32(int64_t, opt_dist[2 * MLS_CG_BLK_SIZE]);
+    ALIGN_VAR_32(int32_t, ref_level[2 * MLS_CG_BLK_SIZE]);
+    ALIGN_VAR_32(int32_t, opt_level[2 * MLS_CG_BLK_SIZE]);
+
+    for (int i = 0; i < ITERS; i++)
+    {
+        int index = rand() % TEST_CASES;
+        const int16_t* coef = short_test_buff[index] + j;
+
+        /* quantized levels at or somewhat below the coefficient magnitude, often zero */
+        for (int k = 0; k < trSize * trSize; k++)
+        {
+            mshortbuf2[k] = (int16_t)(abs(coef[k]) >> (rand() % 8));
+            mintbuf1[k] = 16 * (rand() % 73);
+        }
+
+        int cgX = rand() % (trSize >> MLS_CG_LOG2_SIZE);
+        int cgY = rand() % (trSize >> MLS_CG_LOG2_SIZE);
+        uint32_t blkPos = (cgY << MLS_CG_LOG2_SIZE) * trSize + (cgX << MLS_CG_LOG2_SIZE);
+        int per = rand() % 9;
+        int unquantShift = QUANT_IQUANT_SHIFT - QUANT_SHIFT - transformShift + (rand() & 1) * 4;
+
+        memset(ref_uncoded, 0, sizeof(ref_uncoded));
+        memset(opt_uncoded, 0, sizeof(opt_uncoded));
+
+        ref(coef, mshortbuf2, mintbuf1, ref_uncoded, ref_dist, ref_level, blkPos, per, unquantShift);
+        checked(opt, coef, mshortbuf2, mintbuf1, opt_uncoded, opt_dist, opt_level, blkPos, per, unquantShift);
+
+        if (memcmp(ref_uncoded, opt_uncoded, sizeof(ref_uncoded)) ||
+            memcmp(ref_dist, opt_dist, sizeof(ref_dist)) ||
+            memcmp(ref_level, opt_level, sizeof(ref_level)))
+            return false;
+
+        reportfail();
+        j += INCR;
+    }
+
+    return true;
+}
+
 bool MBDstHarness::check_count_nonzero_primitive(count_nonzero_t ref, count_nonzero_t opt)
 {
     int j = 0;
@@ -584,6 +633,17 @@ bool MBDstHarness::testCorrectness(const EncoderPrimitives& ref, const EncoderPr
         }
     }
     for (int i = 0; i < NUM_TR_SIZE; i++)
+    {
+        if (opt.cu[i].rdoQuantLevelDist)
+        {
+            if (!check_rdoQuantLevelDist_primitive(ref.cu[i].rdoQuantLevelDist, opt.cu[i].rdoQuantLevelDist, i + 2))
+            {
+                printf("rdoQuantLevelDist[%dx%d]: Failed!\n", 4 << i, 4 << i);
+                return false;
+            }
+        }
+    }
+    for (int i = 0; i < NUM_TR_SIZE; i++)
     {
         if (opt.cu[i].count_nonzero)
         {
@@ -619,7 +679,7 @@ void MBDstHarness::measureSpeed(const EncoderPrimitives& ref, const EncoderPrimi
 {
     if (opt.dst4x4)
     {
-        printf("dst4x4\t");
+        HPerf.header("dst4x4\t");
         REPORT_SPEEDUP(opt.dst4x4, ref.dst4x4, mbuf1, mshortbuf2, 4);
     }
 
@@ -627,14 +687,14 @@ void MBDstHarness::measureSpeed(const EncoderPrimitives& ref, const EncoderPrimi
     {
         if (opt.cu[value].dct)
         {
-            printf("%s\t", dctInfo[value].name);
+            HPerf.header("%s\t", dctInfo[value].name);
             REPORT_SPEEDUP(opt.cu[value].dct, ref.cu[value].dct, mbuf1, mshortbuf2, dctInfo[value].width);
         }
     }
 
     if (opt.idst4x4)
     {
-        printf("idst4x4\t");
+        HPerf.header("idst4x4\t");
         REPORT_SPEEDUP(opt.idst4x4, ref.idst4x4, mbuf1, mshortbuf2, 4);
     }
 
@@ -642,32 +702,32 @@ void MBDstHarness::measureSpeed(const EncoderPrimitives& ref, const EncoderPrimi
     {
         if (opt.cu[value].idct)
         {
-            printf("%s\t", idctInfo[value].name);
+            HPerf.header("%s\t", idctInfo[value].name);
             REPORT_SPEEDUP(opt.cu[value].idct, ref.cu[value].idct, mshortbuf3, mshortbuf2, idctInfo[value].width);
         }
     }
 
     if (opt.dequant_normal)
     {
-        printf("dequant_normal\t");
+        HPerf.header("dequant_normal\t");
         REPORT_SPEEDUP(opt.dequant_normal, ref.dequant_normal, short_test_buff[0], mshortbuf2, 32 * 32, 70, 1);
     }
 
     if (opt.dequant_scaling)
     {
-        printf("dequant_scaling\t");
+        HPerf.header("dequant_scaling\t");
         REPORT_SPEEDUP(opt.dequant_scaling, ref.dequant_scaling, short_test_buff[0], mintbuf3, mshortbuf2, 32 * 32, 5, 1);
     }
 
     if (opt.quant)
     {
-        printf("quant\t\t");
+        HPerf.header("quant\t\t");
         REPORT_SPEEDUP(opt.quant, ref.quant, short_test_buff[0], int_test_buff[1], mintbuf3, mshortbuf2, 23, 23785, 32 * 32);
     }
 
     if (opt.nquant)
     {
-        printf("nquant\t\t");
+        HPerf.header("nquant\t\t");
         REPORT_SPEEDUP(opt.nquant, ref.nquant, short_test_buff[0], int_test_buff[1], mshortbuf2, 23, 23785, 32 * 32);
     }
 
@@ -678,7 +738,7 @@ void MBDstHarness::measureSpeed(const EncoderPrimitives& ref, const EncoderPrimi
             ALIGN_VAR_32(int64_t, opt_dest[4 * MAX_TU_SIZE]);
             int64_t totalRdCost = 0;
             int64_t totalUncodedCost = 0;
-            printf("nonPsyRdoQuant[%dx%d]", 4 << value, 4 << value);
+            HPerf.header("nonPsyRdoQuant[%dx%d]", 4 << value, 4 << value);
             REPORT_SPEEDUP(opt.cu[value].nonPsyRdoQuant, ref.cu[value].nonPsyRdoQuant, short_test_buff[0], opt_dest, &totalUncodedCost, &totalRdCost, 0);
         }
     }
@@ -691,7 +751,7 @@ void MBDstHarness::measureSpeed(const EncoderPrimitives& ref, const EncoderPrimi
             int64_t totalUncodedCost = 0;
             int64_t *psyScale = X265_MALLOC(int64_t, 1);
             *psyScale = 0;
-            printf("psyRdoQuant[%dx%d]", 4 << value, 4 << value);
+            HPerf.header("psyRdoQuant[%dx%d]", 4 << value, 4 << value);
             REPORT_SPEEDUP(opt.cu[value].psyRdoQuant, ref.cu[value].psyRdoQuant, short_test_buff[0], short_test_buff1[0], opt_dest, &totalUncodedCost, &totalRdCost, psyScale, 0);
         }
     }
@@ -702,21 +762,37 @@ void MBDstHarness::measureSpeed(const EncoderPrimitives& ref, const EncoderPrimi
             ALIGN_VAR_32(int64_t, opt_dest[4 * MAX_TU_SIZE]);
             int64_t totalRdCost = 0;
             int64_t totalUncodedCost = 0;
-            printf("psyRdoQuant_1p[%dx%d]", 4 << value, 4 << value);
+            HPerf.header("psyRdoQuant_1p[%dx%d]", 4 << value, 4 << value);
             REPORT_SPEEDUP(opt.cu[value].psyRdoQuant_1p, ref.cu[value].psyRdoQuant_1p, short_test_buff[0], opt_dest, &totalUncodedCost, &totalRdCost, 0);
         }
     }
     for (int value = 0; value < NUM_TR_SIZE; value++)
+    {
+        if (opt.cu[value].rdoQuantLevelDist)
+        {
+            ALIGN_VAR_32(int64_t, opt_dest[MAX_TU_SIZE]);
+            ALIGN_VAR_32(int64_t, levelDist[2 * MLS_CG_BLK_SIZE]);
+            ALIGN_VAR_32(int32_t, unquantLevel[2 * MLS_CG_BLK_SIZE]);
+            for (int k = 0; k < MAX_TU_SIZE; k++)
+            {
+                mshortbuf2[k] = (int16_t)(rand() & 7);
+                mintbuf1[k] = 16 * 40;
+            }
+            HPerf.header("rdoQuantLevelDist[%dx%d]", 4 << value, 4 << value);
+            REPORT_SPEEDUP(opt.cu[value].rdoQuantLevelDist, ref.cu[value].rdoQuantLevelDist, short_test_buff[0], mshortbuf2, mintbuf1, opt_dest, levelDist, unquantLevel, 0, 4, 5);
+        }
+    }
+    for (int value = 0; value < NUM_TR_SIZE; value++)
     {
         if (opt.cu[value].count_nonzero)
         {
-            printf("count_nonzero[%dx%d]", 4 << value, 4 << value);
+            HPerf.header("count_nonzero[%dx%d]", 4 << value, 4 << value);
             REPORT_SPEEDUP(opt.cu[value].count_nonzero, ref.cu[value].count_nonzero, mbuf1);
         }
     }
     if (opt.denoiseDct)
     {
-        printf("denoiseDct\t");
+        HPerf.header("denoiseDct\t");
         REPORT_SPEEDUP(opt.denoiseDct, ref.denoiseDct, short_denoise_test_buff1[0], mubuf1, mushortbuf1, 32 * 32);
     }
 }
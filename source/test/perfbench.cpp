@@ -0,0 +1,366 @@
+/*****************************************************************************
+ * Copyright (C) 2013-2020 MulticoreWare, Inc
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02111, USA.
+ *
+ * This program is also available under a commercial proprietary license.
+ * For more information, contact us at license @ x265.com.
+ *****************************************************************************/
+
+#include "testharness.h"
+#include "perfbench.h"
+#include "x265.h"
+#include <stdarg.h>
+
+#if __linux__
+#include <unistd.h>
+#include <sched.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+#define PERF_WARMUP_MS 200   // busy time before the first sample, lets the core leave its idle clock
+
+namespace {
+const char* const counterNames[PerfBench::NUM_COUNTERS] =
+{
+    "tsc", "cycles", "instructions", "l1d_misses", "llc_misses", "branch_misses"
+};
+
+int compareSamples(const void* a, const void* b)
+{
+    uint64_t x = *(const uint64_t*)a;
+    uint64_t y = *(const uint64_t*)b;
+    return x < y ? -1 : x > y;
+}
+}
+
+PerfBench::PerfBench()
+    : m_harness("")
+    , m_enabled(false)
+    , m_bCounters(false)
+    , m_numEvents(0)
+    , m_core(-1)
+    , m_json(NULL)
+    , m_numReports(0)
+{
+    for (int c = 0; c < NUM_COUNTERS; c++)
+    {
+        m_fd[c] = -1;
+        m_slot[c] = 0;
+        m_begin[c] = 0;
+        m_overhead[c] = 0;
+    }
+    m_opt.count = m_ref.count = 0;
+    m_name[0] = 0;
+}
+
+PerfBench::~PerfBench()
+{
+    close();
+}
+
+bool PerfBench::open(int core, const char* json)
+{
+    m_core = core;
+#if __linux__
+    if (core >= 0)
+    {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(core, &set);
+        if (sched_setaffinity(0, sizeof(set), &set))
+        {
+            printf("Unable to pin the benchmark to core %d, it may migrate between samples\n", core);
+            m_core = -1;
+        }
+    }
+#else
+    if (core >= 0)
+    {
+        printf("Pinning the benchmark to a core is not supported on this platform\n");
+        m_core = -1;
+    }
+#endif
+
+    openCounters();
+    if (!m_bCounters)
+        printf("Performance counters are unavailable (see /proc/sys/kernel/perf_event_paranoid), sampling the TSC only\n");
+
+    if (json)
+    {
+        m_json = fopen(json, "w");
+        if (!m_json)
+        {
+            printf("Unable to open %s\n", json);
+            close();
+            return false;
+        }
+        fprintf(m_json, "{\n  \"version\": \"%s\",\n  \"bit_depth\": %d,\n  \"core\": %d,\n", x265_version_str, X265_DEPTH, m_core);
+        fprintf(m_json, "  \"calls_per_sample\": %d,\n  \"counters\": [", PERF_BENCH_CALLS);
+        for (int c = 0, n = 0; c < NUM_COUNTERS; c++)
+        {
+            if (c == TSC || m_fd[c] >= 0)
+                fprintf(m_json, "%s\"%s\"", n++ ? ", " : "", counterNames[c]);
+        }
+        fprintf(m_json, "],\n  \"primitives\": [");
+    }
+
+    warmupCore();
+
+    /* the user mode side of start() and stop() is counted with every sample,
+     * its median is subtracted from all of them */
+    m_opt.count = 0;
+    for (int i = 0; i < PERF_BENCH_SAMPLES; i++)
+    {
+        start();
+        stop(m_opt);
+    }
+    for (int c = 0; c < NUM_COUNTERS; c++)
+    {
+        uint64_t* v = m_opt.value[c];
+        qsort(v, m_opt.count, sizeof(uint64_t), compareSamples);
+        m_overhead[c] = v[m_opt.count / 2];
+    }
+    m_opt.count = 0;
+
+    m_enabled = true;
+    return true;
+}
+
+void PerfBench::close()
+{
+    if (m_json)
+    {
+        fprintf(m_json, "\n  ]\n}\n");
+        fclose(m_json);
+        m_json = NULL;
+    }
+#if __linux__
+    for (int c = NUM_COUNTERS - 1; c >= 0; c--)
+    {
+        if (m_fd[c] >= 0)
+            ::close(m_fd[c]);
+        m_fd[c] = -1;
+    }
+#endif
+    m_bCounters = false;
+    m_numEvents = 0;
+    m_enabled = false;
+}
+
+void PerfBench::openCounters()
+{
+#if __linux__
+    static const struct { uint32_t type; uint64_t config; } events[NUM_COUNTERS] =
+    {
+        { 0, 0 }, // TSC, read with rdtsc
+        { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+        { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+        { PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16) },
+        { PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_LL | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16) },
+        { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+    };
+
+    /* all counters are one group led by the cycle counter, so they count the
+     * same instructions. An event the PMU cannot schedule alongside the others
+     * is left out rather than multiplexed */
+    for (int c = CYCLES; c < NUM_COUNTERS; c++)
+    {
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = events[c].type;
+        attr.config = events[c].config;
+        attr.disabled = c == CYCLES;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        int leader = m_fd[CYCLES];
+        int fd = (int)syscall(__NR_perf_event_open, &attr, 0, -1, leader, 0);
+        if (fd < 0)
+        {
+            if (c == CYCLES)
+                return;
+            continue;
+        }
+        m_fd[c] = fd;
+        m_slot[c] = m_numEvents++;
+        m_bCounters = true;
+
+        uint64_t buf[3 + NUM_COUNTERS];
+        ioctl(m_fd[CYCLES], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(m_fd[CYCLES], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+        for (volatile int i = 0; i < 10000; i++)
+        {
+        }
+        ioctl(m_fd[CYCLES], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+        if (::read(m_fd[CYCLES], buf, sizeof(buf)) <= 0 || !buf[2] || buf[1] != buf[2])
+        {
+            ::close(fd);
+            m_fd[c] = -1;
+            m_numEvents--;
+            if (c == CYCLES)
+            {
+                m_bCounters = false;
+                return;
+            }
+        }
+    }
+#endif
+}
+
+void PerfBench::warmupCore()
+{
+    int64_t end = x265_mdate() + PERF_WARMUP_MS * 1000;
+    volatile uint32_t x = 1;
+    while (x265_mdate() < end)
+    {
+        for (int i = 0; i < 100000; i++)
+            x = x * 1664525 + 1013904223;
+    }
+}
+
+void PerfBench::header(const char* fmt, ...)
+{
+    va_list arg;
+    va_start(arg, fmt);
+    vsnprintf(m_name, sizeof(m_name), fmt, arg);
+    va_end(arg);
+    printf("%s", m_name);
+}
+
+void PerfBench::start()
+{
+#if __linux__
+    if (m_bCounters)
+    {
+        ioctl(m_fd[CYCLES], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(m_fd[CYCLES], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+#endif
+    m_begin[TSC] = (uint64_t)__rdtsc();
+}
+
+void PerfBench::stop(Samples& s)
+{
+    uint64_t tsc = (uint64_t)__rdtsc() - m_begin[TSC];
+    if (s.count == PERF_BENCH_SAMPLES)
+        return;
+
+    int i = s.count++;
+    s.value[TSC][i] = tsc;
+#if __linux__
+    if (m_bCounters)
+    {
+        uint64_t buf[3 + NUM_COUNTERS];
+        ioctl(m_fd[CYCLES], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+        if (::read(m_fd[CYCLES], buf, sizeof(buf)) <= 0)
+            memset(buf, 0, sizeof(buf));
+        for (int c = CYCLES; c < NUM_COUNTERS; c++)
+            s.value[c][i] = m_fd[c] >= 0 ? buf[3 + m_slot[c]] : 0;
+        return;
+    }
+#endif
+    for (int c = CYCLES; c < NUM_COUNTERS; c++)
+        s.value[c][i] = 0;
+}
+
+void PerfBench::summarize(Samples& s, Stats* stats)
+{
+    for (int c = 0; c < NUM_COUNTERS; c++)
+    {
+        Stats& st = stats[c];
+        st.valid = s.count && (c == TSC || m_fd[c] >= 0);
+        if (!st.valid)
+            continue;
+
+        uint64_t* v = s.value[c];
+        qsort(v, s.count, sizeof(uint64_t), compareSamples);
+
+        /* values are per primitive call, less the cost of measuring */
+        double scale = 1.0 / PERF_BENCH_CALLS;
+        double overhead = (double)m_overhead[c];
+        st.min    = X265_MAX((double)v[0] - overhead, 0.0) * scale;
+        st.p10    = X265_MAX((double)v[s.count / 10] - overhead, 0.0) * scale;
+        st.median = X265_MAX((double)v[s.count / 2] - overhead, 0.0) * scale;
+        st.p90    = X265_MAX((double)v[s.count * 9 / 10] - overhead, 0.0) * scale;
+    }
+}
+
+void PerfBench::writeStats(const char* key, int count, const Stats* stats)
+{
+    fprintf(m_json, ",\n      \"%s\": { \"samples\": %d", key, count);
+    for (int c = 0; c < NUM_COUNTERS; c++)
+    {
+        const Stats& st = stats[c];
+        if (st.valid)
+            fprintf(m_json, ",\n        \"%s\": { \"min\": %.2f, \"p10\": %.2f, \"median\": %.2f, \"p90\": %.2f }",
+                    counterNames[c], st.min, st.p10, st.median, st.p90);
+    }
+    fprintf(m_json, " }");
+}
+
+void PerfBench::report()
+{
+    Stats opt[NUM_COUNTERS], ref[NUM_COUNTERS];
+    summarize(m_opt, opt);
+    summarize(m_ref, ref);
+
+    /* core cycles when available, they do not drift with the clock speed */
+    int primary = m_fd[CYCLES] >= 0 ? CYCLES : TSC;
+    double speedup = opt[primary].median > 0 ? ref[primary].median / opt[primary].median : 0;
+    printf("\t%3.2fx ", speedup);
+    printf("\t %-8.2lf \t %-8.2lf", opt[primary].median, ref[primary].median);
+    printf("\t p90 %-8.2lf", opt[primary].p90);
+    if (opt[INSTRUCTIONS].valid && opt[CYCLES].median > 0)
+        printf(" ipc %.2f", opt[INSTRUCTIONS].median / opt[CYCLES].median);
+    if (opt[BRANCH_MISSES].valid)
+        printf(" brmiss %.2f", opt[BRANCH_MISSES].median);
+    if (opt[L1D_MISSES].valid)
+        printf(" l1dmiss %.2f", opt[L1D_MISSES].median);
+    if (opt[LLC_MISSES].valid)
+        printf(" llcmiss %.2f", opt[LLC_MISSES].median);
+    printf("\n");
+
+    if (m_json)
+    {
+        /* the printed name carries the padding of the console columns */
+        char name[sizeof(m_name)];
+        int len = 0;
+        for (const char* p = m_name; *p; p++)
+        {
+            bool bSpace = *p == ' ' || *p == '\t' || *p == '\n';
+            if (bSpace && (!len || name[len - 1] == ' ' || name[len - 1] == '['))
+                continue;
+            if (*p == '"' || *p == '\\')
+                continue;
+            name[len++] = bSpace ? ' ' : *p;
+        }
+        while (len && name[len - 1] == ' ')
+            len--;
+        name[len] = 0;
+
+        fprintf(m_json, "%s\n    {\n      \"harness\": \"%s\", \"name\": \"%s\", \"speedup\": %.3f",
+                m_numReports++ ? "," : "", m_harness, name, speedup);
+        writeStats("opt", m_opt.count, opt);
+        writeStats("ref", m_ref.count, ref);
+        fprintf(m_json, "\n    }");
+        fflush(m_json);
+    }
+    m_name[0] = 0;
+}
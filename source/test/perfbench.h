@@ -0,0 +1,125 @@
+/*****************************************************************************
+ * Copyright (C) 2013-2020 MulticoreWare, Inc
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02111, USA.
+ *
+ * This program is also available under a commercial proprietary license.
+ * For more information, contact us at license @ x265.com.
+ *****************************************************************************/
+
+#ifndef _PERFBENCH_H_
+#define _PERFBENCH_H_ 1
+
+#include "common.h"
+
+#define PERF_BENCH_SAMPLES  2000   // samples of the optimized primitive, the C reference takes a quarter
+#define PERF_BENCH_WARMUP   50     // untimed calls before each primitive is sampled
+#define PERF_BENCH_CALLS    4      // primitive calls per sample
+
+using namespace X265_NS;
+
+/* Per-primitive performance counter measurements for the speed tests. When
+ * enabled, REPORT_SPEEDUP takes every sample of a primitive through start()
+ * and stop() instead of accumulating rdtsc deltas, and reports the median
+ * and percentiles of each counter per call. On Linux the counters are read
+ * with perf_event_open on the pinned core; where that is unavailable only the
+ * time stamp counter is sampled */
+class PerfBench
+{
+public:
+
+    enum Counter
+    {
+        TSC,
+        CYCLES,
+        INSTRUCTIONS,
+        L1D_MISSES,
+        LLC_MISSES,
+        BRANCH_MISSES,
+        NUM_COUNTERS
+    };
+
+    struct Samples
+    {
+        uint64_t value[NUM_COUNTERS][PERF_BENCH_SAMPLES];
+        int      count;
+    };
+
+    Samples     m_opt;
+    Samples     m_ref;
+
+    const char* m_harness;     // name of the harness being measured
+
+    PerfBench();
+
+    ~PerfBench();
+
+    /* pins the calling thread to core (-1 leaves the affinity alone), opens
+     * the counters, and the JSON report if json is not NULL. Returns false if
+     * the report cannot be written */
+    bool open(int core, const char* json);
+
+    void close();
+
+    bool isEnabled() const { return m_enabled; }
+
+    /* formats the name of the next primitive, prints it and keeps it for
+     * the report */
+    void header(const char* fmt, ...);
+
+    void start();
+
+    void stop(Samples& s);
+
+    /* prints the speedup line of the primitive whose samples were just taken
+     * and appends it to the JSON report */
+    void report();
+
+protected:
+
+    bool        m_enabled;
+    bool        m_bCounters;              // perf events are available, else TSC only
+    int         m_fd[NUM_COUNTERS];       // perf event of each counter, -1 if absent
+    int         m_slot[NUM_COUNTERS];     // position of each counter in a group read
+    int         m_numEvents;
+    int         m_core;
+    uint64_t    m_begin[NUM_COUNTERS];
+    uint64_t    m_overhead[NUM_COUNTERS]; // median of an empty sample
+    FILE*       m_json;
+    int         m_numReports;
+    char        m_name[128];
+
+    struct Stats
+    {
+        bool   valid;
+        double min;
+        double p10;
+        double median;
+        double p90;
+    };
+
+    void openCounters();
+
+    void warmupCore();
+
+    /* sorts the samples of each counter into per call statistics */
+    void summarize(Samples& s, Stats* stats);
+
+    void writeStats(const char* key, int count, const Stats* stats);
+};
+
+extern PerfBench HPerf;
+
+#endif // ifndef _PERFBENCH_H_
@@ -269,6 +269,24 @@ bool PixelHarness::check_ssd_s(pixel_ssd_s_t ref, pixel_ssd_s_t opt)
     }
     return true;
 }
+bool PixelHarness::check_sad_s(pixel_sad_s_t ref, pixel_sad_s_t opt)
+{
+    int j = 0;
+    for (int i = 0; i < ITERS; i++)
+    {
+        int stride = STRIDE + (rand() % STRIDE);
+        uint32_t cres = ref(sbuf1 + j, stride);
+        uint32_t vres = (uint32_t)checked(opt, sbuf1 + j, (intptr_t)stride);
+
+        if (cres != vres)
+            return false;
+
+        reportfail();
+        j += INCR;
+    }
+    return true;
+}
+
 bool PixelHarness::check_ssd_s_aligned(pixel_ssd_s_t ref, pixel_ssd_s_t opt)
 {
     int j = 0;
@@ -1462,6 +1480,50 @@ bool PixelHarness::check_saoCuStatsE3_t(saoCuStatsE3_t ref, saoCuStatsE3_t opt)
     return true;
 }
 
+bool PixelHarness::check_saoEstOffsets_t(saoEstOffsets_t ref, saoEstOffsets_t opt)
+{
+    enum { MAX_NUM_SAO_CLASS = 32 };
+    const int offsetThresh = 1 << X265_MIN(X265_DEPTH - 5, 5);
+
+    int32_t count[MAX_NUM_SAO_CLASS];
+    int32_t offsetOrg[MAX_NUM_SAO_CLASS];
+    int32_t offset_ref[MAX_NUM_SAO_CLASS], offset_vec[MAX_NUM_SAO_CLASS];
+    int32_t dist_ref[MAX_NUM_SAO_CLASS], dist_vec[MAX_NUM_SAO_CLASS];
+    int64_t cost_ref[MAX_NUM_SAO_CLASS], cost_vec[MAX_NUM_SAO_CLASS];
+
+    for (int i = 0; i < ITERS; i++)
+    {
+        // statistics in the range of a 64x64 CTU, initial offsets not always matching them
+        for (int x = 0; x < MAX_NUM_SAO_CLASS; x++)
+        {
+            count[x] = (rand() & 3) ? rand() % (MAX_CU_SIZE * MAX_CU_SIZE + 1) : 0;
+            offsetOrg[x] = count[x] * ((rand() % (4 * offsetThresh + 1)) - 2 * offsetThresh) + (rand() % 64) - 32;
+            offset_ref[x] = offset_vec[x] = (rand() % 8) ? (rand() % (2 * offsetThresh - 1)) - (offsetThresh - 1) : 0;
+        }
+
+        int numClasses = (rand() & 1) ? MAX_NUM_SAO_CLASS : 4;
+        int bBandOffset = numClasses == MAX_NUM_SAO_CLASS;
+        int64_t lambda = rand() % (1 << 26);
+
+        memset(dist_ref, 0xCD, sizeof(dist_ref));
+        memset(dist_vec, 0xCD, sizeof(dist_vec));
+        memset(cost_ref, 0xCD, sizeof(cost_ref));
+        memset(cost_vec, 0xCD, sizeof(cost_vec));
+
+        ref(count, offsetOrg, offset_ref, dist_ref, cost_ref, numClasses, bBandOffset, lambda);
+        checked(opt, count, offsetOrg, offset_vec, dist_vec, cost_vec, numClasses, bBandOffset, lambda);
+
+        if (memcmp(offset_ref, offset_vec, sizeof(offset_ref))
+            || memcmp(dist_ref, dist_vec, sizeof(dist_ref))
+            || memcmp(cost_ref, cost_vec, sizeof(cost_ref)))
+            return false;
+
+        reportfail();
+    }
+
+    return true;
+}
+
 bool PixelHarness::check_saoCuOrgE3_32_t(saoCuOrgE3_t ref, saoCuOrgE3_t opt)
 {
     ALIGN_VAR_16(pixel, ref_dest[64 * 64]);
@@ -1491,6 +1553,175 @@ bool PixelHarness::check_saoCuOrgE3_32_t(saoCuOrgE3_t ref, saoCuOrgE3_t opt)
     return true;
 }
 
+bool PixelHarness::check_hashCRC_t(hashCRC_t ref, hashCRC_t opt)
+{
+    for (int i = 0; i < ITERS; i++)
+    {
+        int index = i % TEST_CASES;
+        intptr_t stride = 64 * (rand() % 8 + 1);
+        uint32_t width = rand() % stride + 1;
+        uint32_t height = rand() % (BUFFSIZE / stride) + 1;
+        uint32_t crcVal = (i & 1) ? 0xffff : rand() & 0xffff;
+
+        uint32_t ref_crc = ref(pixel_test_buff[index], stride, width, height, crcVal);
+        uint32_t opt_crc = (uint32_t)checked(opt, pixel_test_buff[index], stride, width, height, crcVal);
+
+        if (ref_crc != opt_crc)
+            return false;
+
+        reportfail();
+    }
+
+    return true;
+}
+
+bool PixelHarness::check_hashChecksum_t(hashChecksum_t ref, hashChecksum_t opt)
+{
+    for (int i = 0; i < ITERS; i++)
+    {
+        int index = i % TEST_CASES;
+        intptr_t stride = 64 * (rand() % 8 + 1);
+        uint32_t width = rand() % stride + 1;
+        uint32_t height = rand() % (BUFFSIZE / stride) + 1;
+        uint32_t y0 = rand() % (1 << 17);
+
+        uint32_t ref_sum = ref(pixel_test_buff[index], stride, width, height, y0);
+        uint32_t opt_sum = (uint32_t)checked(opt, pixel_test_buff[index], stride, width, height, y0);
+
+        if (ref_sum != opt_sum)
+            return false;
+
+        reportfail();
+    }
+
+    return true;
+}
+
+bool PixelHarness::check_nalEscape_t(nalEscape_t ref, nalEscape_t opt)
+{
+    ALIGN_VAR_32(uint8_t, payload[BUFFSIZE]);
+    ALIGN_VAR_32(uint8_t, ref_dest[BUFFSIZE + BUFFSIZE / 2]);
+    ALIGN_VAR_32(uint8_t, opt_dest[BUFFSIZE + BUFFSIZE / 2]);
+
+    /* random payloads with runs of zeros and small values at a few densities,
+     * so that escapes land at every offset of a vector and back to back */
+    for (int i = 0; i < ITERS * 10; i++)
+    {
+        uint32_t size = (i < 64) ? i : rand() % BUFFSIZE;
+        int zeroOdds = 1 << (rand() % 7);
+        for (uint32_t j = 0; j < size; j++)
+        {
+            int r = rand();
+            payload[j] = (r % zeroOdds) ? (uint8_t)((r >> 8) & ((r & 1) ? 0x03 : 0xff)) : 0;
+        }
+
+        memset(ref_dest, 0xCD, sizeof(ref_dest));
+        memset(opt_dest, 0xCD, sizeof(opt_dest));
+
+        uint32_t ref_size = ref(ref_dest, payload, size);
+        uint32_t opt_size = (uint32_t)checked(opt, opt_dest, payload, size);
+
+        if (ref_size != opt_size || memcmp(ref_dest, opt_dest, ref_size))
+            return false;
+
+        reportfail();
+    }
+
+    return true;
+}
+
+bool PixelHarness::check_edgeCount_t(edgeCount_t ref, edgeCount_t opt)
+{
+    ALIGN_VAR_32(pixel, ramp[BUFFSIZE]);
+
+    /* noisy ramps of varying slope place the gradients around the threshold,
+     * the random and flat test buffers give the extremes */
+    for (int i = 0; i < BUFFSIZE; i++)
+    {
+        int x = i % STRIDE, y = i / STRIDE;
+        int slope = ((y >> 2) & 15) << (X265_DEPTH - 8);
+        ramp[i] = (pixel)((x * slope + (y & 1) * (x & 3) * slope + rand() % 4) & PIXEL_MAX);
+    }
+
+    for (int i = 0; i < ITERS; i++)
+    {
+        const pixel* src = (i % 4) ? ramp : pixel_test_buff[i % TEST_CASES];
+        intptr_t stride = 64 * (rand() % 4 + 1);
+        int width = rand() % stride + 1;
+        int height = rand() % (BUFFSIZE / stride) + 1;
+        int threshold = (i & 1) ? (255 << (X265_DEPTH - 8)) : rand() % (2 * PIXEL_MAX) + 1;
+
+        uint32_t ref_count = ref(src, stride, width, height, threshold);
+        uint32_t opt_count = (uint32_t)checked(opt, src, stride, width, height, threshold);
+
+        if (ref_count != opt_count)
+            return false;
+
+        reportfail();
+    }
+
+    return true;
+}
+
+bool PixelHarness::check_gaussianRow_t(gaussianRow_t ref, gaussianRow_t opt)
+{
+    ALIGN_VAR_32(pixel, ref_dest[STRIDE]);
+    ALIGN_VAR_32(pixel, opt_dest[STRIDE]);
+
+    for (int i = 0; i < ITERS; i++)
+    {
+        int index = i % TEST_CASES;
+        int width = rand() % (STRIDE - 4) + 1;
+        const pixel* src = pixel_test_buff[index] + 2 * STRIDE + 2 + rand() % 4 * STRIDE;
+
+        memset(ref_dest, 0xCD, sizeof(ref_dest));
+        memset(opt_dest, 0xCD, sizeof(opt_dest));
+
+        ref(ref_dest, src, STRIDE, width);
+        checked(opt, opt_dest, src, (intptr_t)STRIDE, width);
+
+        if (memcmp(ref_dest, opt_dest, sizeof(ref_dest)))
+            return false;
+
+        reportfail();
+    }
+
+    return true;
+}
+
+bool PixelHarness::check_edgeRow_t(edgeRow_t ref, edgeRow_t opt)
+{
+    ALIGN_VAR_32(pixel, ramp[4 * STRIDE]);
+    ALIGN_VAR_32(pixel, ref_dest[STRIDE]);
+    ALIGN_VAR_32(pixel, opt_dest[STRIDE]);
+
+    for (int i = 0; i < ITERS; i++)
+    {
+        /* noisy ramps place the gradients around the threshold */
+        int slope = (rand() & 15) << (X265_DEPTH - 8);
+        for (int j = 0; j < 4 * STRIDE; j++)
+            ramp[j] = (pixel)(((j % STRIDE) * slope + (j / STRIDE) * (j & 3) * slope + rand() % 4) & PIXEL_MAX);
+
+        const pixel* src = (i % 4) ? ramp + STRIDE + 1 : pixel_test_buff[i % TEST_CASES] + STRIDE + 1 + rand() % 4 * STRIDE;
+        int width = rand() % (STRIDE - 2) + 1;
+        int threshold = (i & 1) ? (255 << (X265_DEPTH - 8)) : rand() % (2 * PIXEL_MAX) + 1;
+        pixel white = (pixel)(rand() & PIXEL_MAX);
+
+        memset(ref_dest, 0xCD, sizeof(ref_dest));
+        memset(opt_dest, 0xCD, sizeof(opt_dest));
+
+        ref(ref_dest, src, STRIDE, width, threshold, white);
+        checked(opt, opt_dest, src, (intptr_t)STRIDE, width, threshold, white);
+
+        if (memcmp(ref_dest, opt_dest, sizeof(ref_dest)))
+            return false;
+
+        reportfail();
+    }
+
+    return true;
+}
+
 bool PixelHarness::check_planecopy_sp(planecopy_sp_t ref, planecopy_sp_t opt)
 {
     ALIGN_VAR_16(pixel, ref_dest[64 * 64]);
@@ -2712,6 +2943,14 @@ bool PixelHarness::testCorrectness(const EncoderPrimitives& ref, const EncoderPr
                     return false;
                 }
             }
+            if (opt.cu[i].sad_s)
+            {
+                if (!check_sad_s(ref.cu[i].sad_s, opt.cu[i].sad_s))
+                {
+                    printf("sad_s[%dx%d]: failed!\n", 4 << i, 4 << i);
+                    return false;
+                }
+            }
             if (opt.cu[i].copy_cnt)
             {
                 if (!check_copy_cnt_t(ref.cu[i].copy_cnt, opt.cu[i].copy_cnt))
@@ -2958,6 +3197,69 @@ bool PixelHarness::testCorrectness(const EncoderPrimitives& ref, const EncoderPr
         }
     }
 
+    if (opt.saoEstOffsets)
+    {
+        if (!check_saoEstOffsets_t(ref.saoEstOffsets, opt.saoEstOffsets))
+        {
+            printf("saoEstOffsets failed\n");
+            return false;
+        }
+    }
+
+    if (opt.hashCRC)
+    {
+        if (!check_hashCRC_t(ref.hashCRC, opt.hashCRC))
+        {
+            printf("hashCRC failed\n");
+            return false;
+        }
+    }
+
+    if (opt.hashChecksum)
+    {
+        if (!check_hashChecksum_t(ref.hashChecksum, opt.hashChecksum))
+        {
+            printf("hashChecksum failed\n");
+            return false;
+        }
+    }
+
+    if (opt.nalEscape)
+    {
+        if (!check_nalEscape_t(ref.nalEscape, opt.nalEscape))
+        {
+            printf("nalEscape failed\n");
+            return false;
+        }
+    }
+
+    if (opt.edgeCount)
+    {
+        if (!check_edgeCount_t(ref.edgeCount, opt.edgeCount))
+        {
+            printf("edgeCount failed\n");
+            return false;
+        }
+    }
+
+    if (opt.gaussianRow)
+    {
+        if (!check_gaussianRow_t(ref.gaussianRow, opt.gaussianRow))
+        {
+            printf("gaussianRow failed\n");
+            return false;
+        }
+    }
+
+    if (opt.edgeRow)
+    {
+        if (!check_edgeRow_t(ref.edgeRow, opt.edgeRow))
+        {
+            printf("edgeRow failed\n");
+            return false;
+        }
+    }
+
     if (opt.planecopy_sp)
     {
         if (!check_planecopy_sp(ref.planecopy_sp, opt.planecopy_sp))
@@ -3173,7 +3475,7 @@ void PixelHarness::measurePartition(int part, const EncoderPrimitives& ref, cons
     ALIGN_VAR_16(int, cres[16]);
     pixel *fref = pbuf2 + 2 * INCR;
     char header[128];
-#define HEADER(str, ...) sprintf(header, str, __VA_ARGS__); printf("%22s", header);
+#define HEADER(str, ...) sprintf(header, str, __VA_ARGS__); HPerf.header("%22s", header);
 
     if (opt.pu[part].satd)
     {
@@ -3345,8 +3647,8 @@ void PixelHarness::measureSpeed(const EncoderPrimitives& ref, const EncoderPrimi
 {
     char header[128];
 
-#define HEADER(str, ...) sprintf(header, str, __VA_ARGS__); printf("%22s", header);
-#define HEADER0(str) printf("%22s", str);
+#define HEADER(str, ...) sprintf(header, str, __VA_ARGS__); HPerf.header("%22s", header);
+#define HEADER0(str) HPerf.header("%22s", str);
 
     for (int size = 4; size <= 64; size *= 2)
     {
@@ -3386,6 +3688,11 @@ void PixelHarness::measureSpeed(const EncoderPrimitives& ref, const EncoderPrimi
             HEADER("ssd_s_aligned[%dx%d]", 4 << i, 4 << i);
             REPORT_SPEEDUP(opt.cu[i].ssd_s[ALIGNED], ref.cu[i].ssd_s[ALIGNED], sbuf1, STRIDE);
         }
+        if ((i <= BLOCK_32x32) && opt.cu[i].sad_s)
+        {
+            HEADER("sad_s[%dx%d]", 4 << i, 4 << i);
+            REPORT_SPEEDUP(opt.cu[i].sad_s, ref.cu[i].sad_s, sbuf1, STRIDE);
+        }
         if (opt.cu[i].sa8d)
         {
             HEADER("sa8d[%dx%d]", 4 << i, 4 << i);
@@ -3469,7 +3776,7 @@ void PixelHarness::measureSpeed(const EncoderPrimitives& ref, const EncoderPrimi
         {
             uint64_t dst1 = 0, dst2 = 0;
             int shift = X265_DEPTH - 8;
-            printf("ssimDist[%dx%d]", 4 << i, 4 << i);
+            HPerf.header("ssimDist[%dx%d]", 4 << i, 4 << i);
             REPORT_SPEEDUP(opt.cu[i].ssimDist, ref.cu[i].ssimDist, pixel_test_buff[0], 32, pixel_test_buff[5], 64, &dst1, shift, &dst2);
         }
     }
@@ -3619,6 +3926,59 @@ void PixelHarness::measureSpeed(const EncoderPrimitives& ref, const EncoderPrimi
         REPORT_SPEEDUP(opt.saoCuStatsE3, ref.saoCuStatsE3, sbuf2, pbuf3, 64, upBuff1 + 1, 60, 61, stats, count);
     }
 
+    if (opt.saoEstOffsets)
+    {
+        const int offsetThresh = 1 << X265_MIN(X265_DEPTH - 5, 5);
+        int32_t count[32], offsetOrg[32], offset[32], dist[32];
+        int64_t cost[32];
+        for (int x = 0; x < 32; x++)
+        {
+            count[x] = 100 + 37 * x;
+            offset[x] = (x % (2 * offsetThresh - 1)) - (offsetThresh - 1);
+            offsetOrg[x] = count[x] * offset[x];
+        }
+        /* the search runs in place, the timed calls start from the offsets chosen by the first one */
+        HEADER0("saoEstOffsets");
+        REPORT_SPEEDUP(opt.saoEstOffsets, ref.saoEstOffsets, count, offsetOrg, offset, dist, cost, 32, 1, 4000);
+    }
+
+    if (opt.hashCRC)
+    {
+        HEADER0("hashCRC");
+        REPORT_SPEEDUP(opt.hashCRC, ref.hashCRC, pbuf1, 256, 256, 32, 0xffff);
+    }
+
+    if (opt.hashChecksum)
+    {
+        HEADER0("hashChecksum");
+        REPORT_SPEEDUP(opt.hashChecksum, ref.hashChecksum, pbuf1, 256, 256, 32, 64);
+    }
+
+    if (opt.nalEscape)
+    {
+        /* CABAC data rarely escapes, the uchar test buffer is uniformly random */
+        HEADER0("nalEscape");
+        REPORT_SPEEDUP(opt.nalEscape, ref.nalEscape, (uint8_t*)psbuf1, uchar_test_buff[0], 4096);
+    }
+
+    if (opt.edgeCount)
+    {
+        HEADER0("edgeCount");
+        REPORT_SPEEDUP(opt.edgeCount, ref.edgeCount, pbuf1, 64, 64, 64, 255 << (X265_DEPTH - 8));
+    }
+
+    if (opt.gaussianRow)
+    {
+        HEADER0("gaussianRow");
+        REPORT_SPEEDUP(opt.gaussianRow, ref.gaussianRow, pbuf2, pbuf1 + 2 * STRIDE + 2, STRIDE, STRIDE - 4);
+    }
+
+    if (opt.edgeRow)
+    {
+        HEADER0("edgeRow");
+        REPORT_SPEEDUP(opt.edgeRow, ref.edgeRow, pbuf2, pbuf1 + STRIDE + 1, STRIDE, STRIDE - 2, 255 << (X265_DEPTH - 8), (pixel)(255 << (X265_DEPTH - 8)));
+    }
+
     if (opt.planecopy_sp)
     {
         HEADER0("planecopy_sp");
@@ -3813,7 +4173,7 @@ void PixelHarness::measureSpeed(const EncoderPrimitives& ref, const EncoderPrimi
             uint64_t dst = 0;
             int blockSize = 4 << i;
             int shift = X265_DEPTH - 8;
-            printf("normFact[%dx%d]", blockSize, blockSize);
+            HPerf.header("normFact[%dx%d]", blockSize, blockSize);
             REPORT_SPEEDUP(opt.cu[i].normFact, ref.cu[i].normFact, pixel_test_buff[0], blockSize, shift, &dst);
         }
     }
@@ -88,6 +88,7 @@ protected:
     bool check_scale2D_pp(scale2D_t ref, scale2D_t opt);
     bool check_ssd_s(pixel_ssd_s_t ref, pixel_ssd_s_t opt);
     bool check_ssd_s_aligned(pixel_ssd_s_t ref, pixel_ssd_s_t opt);
+    bool check_sad_s(pixel_sad_s_t ref, pixel_sad_s_t opt);
     bool check_blockfill_s(blockfill_s_t ref, blockfill_s_t opt);
     bool check_blockfill_s_aligned(blockfill_s_t ref, blockfill_s_t opt);
     bool check_calresidual(calcresidual_t ref, calcresidual_t opt);
@@ -118,6 +119,13 @@ protected:
     bool check_saoCuStatsE1_t(saoCuStatsE1_t ref, saoCuStatsE1_t opt);
     bool check_saoCuStatsE2_t(saoCuStatsE2_t ref, saoCuStatsE2_t opt);
     bool check_saoCuStatsE3_t(saoCuStatsE3_t ref, saoCuStatsE3_t opt);
+    bool check_saoEstOffsets_t(saoEstOffsets_t ref, saoEstOffsets_t opt);
+    bool check_hashCRC_t(hashCRC_t ref, hashCRC_t opt);
+    bool check_hashChecksum_t(hashChecksum_t ref, hashChecksum_t opt);
+    bool check_nalEscape_t(nalEscape_t ref, nalEscape_t opt);
+    bool check_edgeCount_t(edgeCount_t ref, edgeCount_t opt);
+    bool check_gaussianRow_t(gaussianRow_t ref, gaussianRow_t opt);
+    bool check_edgeRow_t(edgeRow_t ref, edgeRow_t opt);
     bool check_planecopy_sp(planecopy_sp_t ref, planecopy_sp_t opt);
     bool check_planecopy_cp(planecopy_cp_t ref, planecopy_cp_t opt);
     bool check_cutree_propagate_cost(cutree_propagate_cost ref, cutree_propagate_cost opt);
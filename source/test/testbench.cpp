@@ -31,6 +31,9 @@
 #include "mbdstharness.h"
 #include "ipfilterharness.h"
 #include "intrapredharness.h"
+#include "entropyharness.h"
+#include "encoderbench.h"
+#include "perfbench.h"
 #include "param.h"
 #include "cpu.h"
 
@@ -83,23 +86,41 @@ const char* const* chromaPartStr[X265_CSP_COUNT] =
 void do_help()
 {
     printf("x265 optimized primitive testbench\n\n");
-    printf("usage: TestBench [--cpuid CPU] [--testbench BENCH] [--help]\n\n");
+    printf("usage: TestBench [--cpuid CPU] [--testbench BENCH] [--perf CORE] [--json FILE] [--help]\n\n");
     printf("       CPU is comma separated SIMD arch list, example: SSE4,AVX\n");
     printf("       BENCH is one of (pixel,transforms,interp,intrapred)\n\n");
     printf("By default, the test bench will test all benches on detected CPU architectures\n");
-    printf("Options and testbench name may be truncated.\n");
+    printf("Options and testbench name may be truncated.\n\n");
+    printf("       --perf pins the speed tests to CORE (-1 for any core) and samples each\n");
+    printf("       primitive with the cycle, instruction, L1D/LLC miss and branch miss\n");
+    printf("       counters of perf_event_open, or the TSC where those are unavailable.\n");
+    printf("       Reports the median per call and the 90th percentile, and writes every\n");
+    printf("       counter's min/p10/median/p90 to the --json file\n\n");
+    printf("usage: TestBench --encoder PRESETS [--resolutions WxH,..] [--threads N,..] [--frames N]\n");
+    printf("                 [--input FILE] [--json FILE] [--cpuid CPU]\n\n");
+    printf("       Benchmarks whole encodes for each comma separated preset, resolution\n");
+    printf("       (default 416x240,1280x720) and thread pool size (default 1) instead of\n");
+    printf("       testing primitives. A synthetic clip is encoded unless FILE gives raw\n");
+    printf("       8bit 4:2:0 video at the first resolution. Reports fps, scaling over the\n");
+    printf("       first pool size, frame encoder stage times and peak RSS, and writes them\n");
+    printf("       to the --json file. Builds with DETAILED_CU_STATS add worker time per stage\n");
 }
 
 PixelHarness  HPixel;
 MBDstHarness  HMBDist;
 IPFilterHarness HIPFilter;
 IntraPredHarness HIPred;
+EntropyHarness HEntropy;
+EncoderBench  HEncoder;
+PerfBench     HPerf;
 
 int main(int argc, char *argv[])
 {
     bool enableavx512 = true;
     int cpuid = X265_NS::cpu_detect(enableavx512);
     const char *testname = 0;
+    const char *json = 0;
+    int perfCore = -2;
 
     if (!(argc & 1))
     {
@@ -125,12 +146,27 @@ int main(int argc, char *argv[])
                 printf("Invalid CPU name: %s\n", value);
                 return 1;
             }
+            HEncoder.m_cpuid = cpuid;
         }
         else if (!strncmp(name, "testbench", strlen(name)))
         {
             testname = value;
             printf("Testing only harnesses that match name <%s>\n", testname);
         }
+        else if (!strncmp(name, "encoder", strlen(name)))
+            HEncoder.m_presets = value;
+        else if (!strncmp(name, "resolutions", strlen(name)))
+            HEncoder.m_resolutions = value;
+        else if (!strncmp(name, "threads", strlen(name)))
+            HEncoder.m_threads = value;
+        else if (!strncmp(name, "frames", strlen(name)))
+            HEncoder.m_frames = atoi(value);
+        else if (!strncmp(name, "input", strlen(name)))
+            HEncoder.m_input = value;
+        else if (!strncmp(name, "json", strlen(name)))
+            json = HEncoder.m_json = value;
+        else if (!strncmp(name, "perf", strlen(name)))
+            perfCore = atoi(value);
         else
         {
             printf("** invalid long argument: %s\n\n", name);
@@ -139,6 +175,9 @@ int main(int argc, char *argv[])
         }
     }
 
+    if (HEncoder.m_presets)
+        return HEncoder.run() ? 0 : 1;
+
     int seed = (int)time(NULL);
     printf("Using random seed %X %dbit\n", seed, X265_DEPTH);
     srand(seed);
@@ -149,7 +188,8 @@ int main(int argc, char *argv[])
         &HPixel,
         &HMBDist,
         &HIPFilter,
-        &HIPred
+        &HIPred,
+        &HEntropy
     };
 
     EncoderPrimitives cprim;
@@ -257,6 +297,12 @@ int main(int argc, char *argv[])
     memcpy(&primitives, &optprim, sizeof(EncoderPrimitives));
 
     printf("\nTest performance improvement with full optimizations\n");
+    if (perfCore >= -1)
+    {
+        if (!HPerf.open(perfCore, json))
+            return 1;
+        printf("Median and p90 cycles per call, speedup of the medians\n");
+    }
     fflush(stdout);
 
     for (size_t h = 0; h < sizeof(harness) / sizeof(TestHarness*); h++)
@@ -264,9 +310,12 @@ int main(int argc, char *argv[])
         if (testname && strncmp(testname, harness[h]->getName(), strlen(testname)))
             continue;
         printf("== %s primitives ==\n", harness[h]->getName());
+        HPerf.m_harness = harness[h]->getName();
         harness[h]->measureSpeed(cprim, optprim);
     }
 
+    HPerf.close();
+
     printf("\n");
     return 0;
 }
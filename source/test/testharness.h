@@ -28,6 +28,7 @@
 
 #include "common.h"
 #include "primitives.h"
+#include "perfbench.h"
 
 #if _MSC_VER
 #pragma warning(disable: 4324) // structure was padded due to __declspec(align())
@@ -98,11 +99,36 @@ static inline uint32_t __rdtsc(void)
 
 #define BENCH_RUNS 2000
 
+/* Takes RUNS samples of PERF_BENCH_CALLS calls each into SAMPLES, after the
+ * primitive has warmed the caches and branch predictors */
+#define PERF_SAMPLE(SAMPLES, RUNS, RUN, ...) \
+    { \
+        SAMPLES.count = 0; \
+        for (int wi = 0; wi < PERF_BENCH_WARMUP; wi++) \
+            RUN(__VA_ARGS__); \
+        for (int ti = 0; ti < RUNS; ti++) { \
+            HPerf.start(); \
+            RUN(__VA_ARGS__); \
+            RUN(__VA_ARGS__); \
+            RUN(__VA_ARGS__); \
+            RUN(__VA_ARGS__); \
+            HPerf.stop(SAMPLES); \
+        } \
+    }
+
 /* Adapted from checkasm.c, runs each optimized primitive four times, measures rdtsc
  * and discards invalid times. Repeats BENCH_RUNS times to get a good average.
- * Then measures the C reference with BENCH_RUNS / 4 runs and reports X factor and average cycles.*/
+ * Then measures the C reference with BENCH_RUNS / 4 runs and reports X factor and average cycles.
+ * With --perf every sample is kept instead and the medians and percentiles of
+ * the performance counters are reported per call */
 #define REPORT_SPEEDUP(RUNOPT, RUNREF, ...) \
-    { \
+    if (HPerf.isEnabled()) { \
+        PERF_SAMPLE(HPerf.m_opt, PERF_BENCH_SAMPLES, RUNOPT, __VA_ARGS__); \
+        PERF_SAMPLE(HPerf.m_ref, PERF_BENCH_SAMPLES / 4, RUNREF, __VA_ARGS__); \
+        x265_emms(); \
+        HPerf.report(); \
+    } \
+    else { \
         uint32_t cycles = 0; int runs = 0; \
         RUNOPT(__VA_ARGS__); \
         for (int ti = 0; ti < BENCH_RUNS; ti++) { \
@@ -485,6 +485,11 @@ typedef struct x265_picture
     uint32_t picStruct;
 
     int    width;
+
+    /* Set by x265_encoder_alloc_input() when the planes are the encoder's own
+     * padded picture buffer, which x265_encoder_encode() then takes without a
+     * copy. Must be NULL for pictures whose planes the application owns */
+    void*  inputFrame;
 } x265_picture;
 
 typedef enum
@@ -1948,6 +1953,30 @@ typedef struct x265_param
 
     /* The offset by which QP is incremented for non-referenced inter-frames before a scenecut when bEnableSceneCutAwareQp is 2 or 3. */
     double    bwdNonRefQpDelta;
+
+    /* Number of angular intra modes, ranked by the edge-orientation histogram
+     * of the source block, which are measured with SATD during intra mode
+     * pre-selection (DC, planar and the most probable modes are always
+     * measured). 0 measures all 33 angles. Value is preset dependent. */
+    int       intraGradModes;
+
+    /* Skip the forward transform and quant of inter TUs whose residual SAD
+     * proves every coefficient would quantize to zero. The test is exact, so
+     * the output is identical whether it is enabled or not; disabling it is
+     * only useful to verify that. Default enabled */
+    int       bEnableZeroBlockSkip;
+
+    /* Filename of a Chrome trace (JSON, viewable in chrome://tracing or
+     * Perfetto) of the profiling events of every encoder thread, written when
+     * the encoder is closed. Only builds configured with ENABLE_TRACE record
+     * events, others ignore it with a warning. Default NULL */
+    const char* traceFile;
+
+    /* Write the encode cost of every CTU (wall time, RD evaluations, motion
+     * searches and bits) of each frame to a binary map named after the CSV
+     * log file, with the suffix ".ctucost". Frames are written in encode
+     * order. Requires csvfn, ignored otherwise. Default disabled */
+    int       bCTUCostMap;
 } x265_param;
 
 /* x265_param_alloc:
@@ -2167,6 +2196,29 @@ int x265_encoder_intra_refresh(x265_encoder *);
  */
 int x265_encoder_ctu_info(x265_encoder *, int poc, x265_ctu_info_t** ctu);
 
+/* x265_encoder_alloc_input:
+ *      Lend the application an encoder picture buffer to write the next input
+ *      picture into, saving the copy x265_encoder_encode() makes of the planes
+ *      of other pictures. The planes, strides, width, height, bit depth and
+ *      color space of pic are set to those of the buffer, which is in the
+ *      internal bit depth and color space; they must not be changed. All other
+ *      fields of pic are left as set by the application, and are used as for
+ *      any other input picture; quantOffsets, for instance, is copied by
+ *      x265_encoder_encode() as usual. The buffer is given
+ *      back by passing pic to x265_encoder_encode() as pic_in, or to
+ *      x265_encoder_free_input() if it is not going to be encoded.
+ *
+ *      Not supported with frame duplication, histogram based scene cut
+ *      detection or with copy-pic disabled. Must be called from the thread
+ *      calling x265_encoder_encode(). Returns negative on error, 0 on success */
+int x265_encoder_alloc_input(x265_encoder *, x265_picture *pic);
+
+/* x265_encoder_free_input:
+ *      Give back a picture buffer returned by x265_encoder_alloc_input()
+ *      without encoding it. Buffers still lent out are freed by
+ *      x265_encoder_close() */
+void x265_encoder_free_input(x265_encoder *, x265_picture *pic);
+
 /* x265_get_slicetype_poc_and_scenecut:
  *     get the slice type, poc and scene cut information for the current frame,
  *     returns negative on error, 0 when access unit were output.
@@ -2283,6 +2335,8 @@ typedef struct x265_api
     void          (*vmaf_encoder_log)(x265_encoder*, int, char**, x265_param *, x265_vmaf_data *);
 #endif
     int           (*zone_param_parse)(x265_param*, const char*, const char*);
+    int           (*encoder_alloc_input)(x265_encoder*, x265_picture*);
+    void          (*encoder_free_input)(x265_encoder*, x265_picture*);
     /* add new pointers to the end, or increment X265_MAJOR_VERSION */
 } x265_api;
 
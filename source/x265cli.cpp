@@ -63,6 +63,8 @@ namespace X265_NS {
         H0("   --no-progress                 Disable CLI progress reports\n");
         H0("   --csv <filename>              Comma separated log file, if csv-log-level > 0 frame level statistics, else one line per run\n");
         H0("   --csv-log-level <integer>     Level of csv logging, if csv-log-level > 0 frame level statistics, else one line per run: 0-2\n");
+        H1("   --trace <filename>            Chrome trace JSON of the encoder thread events, needs a build with ENABLE_TRACE\n");
+        H1("   --[no-]ctu-cost-map           Write the per-CTU encode cost of each frame to <csv>.ctucost. Default %s\n", OPT(param->bCTUCostMap));
         H0("\nInput Options:\n");
         H0("   --input <filename>            Raw YUV or Y4M input file name. `-` for stdin\n");
         H1("   --y4m                         Force parsing of input stream as YUV4MPEG2 regardless of file extension\n");
@@ -74,6 +76,7 @@ namespace X265_NS {
         H1("                                 1 - i420 (4:2:0 default)\n");
         H1("                                 2 - i422 (4:2:2)\n");
         H1("                                 3 - i444 (4:4:4)\n");
+        H1("   --input-io <string>           How the input file is read: stdio, mmap, direct. Default stdio\n");
 #if ENABLE_HDR10_PLUS
         H0("   --dhdr10-info <filename>      JSON file containing the Creative Intent Metadata to be encoded as Dynamic Tone Mapping\n");
         H0("   --[no-]dhdr10-opt             Insert tone mapping SEI only for IDR frames and when the tone mapping information changes. Default disabled\n");
@@ -130,6 +133,7 @@ namespace X265_NS {
         H0("   --rskip <Integer>             Enable recursion skip for early exit from CTU analysis during inter prediction. 1: exit using RD cost & CU homogeneity. 2: exit using CU edge density. 0: disabled. Default %d\n", param->recursionSkipMode);
         H1("   --rskip-edge-threshold        Threshold in terms of percentage (an integer of range [0,100]) for minimum edge density in CU's used to prune the recursion depth. Applicable only to rskip mode 2. Value is preset dependent. Default: %.f\n", param->edgeVarThreshold*100.0f);
         H1("   --[no-]tskip-fast             Enable fast intra transform skipping. Default %s\n", OPT(param->bEnableTSkipFast));
+        H1("   --[no-]zero-block-skip        Skip transform and quant of inter TUs proven to quantize to zero. Default %s\n", OPT(param->bEnableZeroBlockSkip));
         H1("   --[no-]splitrd-skip           Enable skipping split RD analysis when sum of split CU rdCost larger than one split CU rdCost for Intra CU. Default %s\n", OPT(param->bEnableSplitRdSkip));
         H1("   --nr-intra <integer>          An integer value in range of 0 to 2000, which denotes strength of noise reduction in intra CUs. Default 0\n");
         H1("   --nr-inter <integer>          An integer value in range of 0 to 2000, which denotes strength of noise reduction in inter CUs. Default 0\n");
@@ -163,6 +167,7 @@ namespace X265_NS {
         H0("   --[no-]constrained-intra      Constrained intra prediction (use only intra coded reference pixels) Default %s\n", OPT(param->bEnableConstrainedIntra));
         H0("   --[no-]b-intra                Enable intra in B frames in veryslow presets. Default %s\n", OPT(param->bIntraInBFrames));
         H0("   --[no-]fast-intra             Enable faster search method for angular intra predictions. Default %s\n", OPT(param->bEnableFastIntra));
+        H1("   --intra-grad-modes <0..33>    Number of angular intra modes, ranked by edge-orientation histogram, measured in intra analysis. 0: all. Default %d\n", param->intraGradModes);
         H0("   --rdpenalty <0..2>            penalty for 32x32 intra TU in non-I slices. 0:disabled 1:RD-penalty 2:maximum. Default %d\n", param->rdPenalty);
         H0("\nSlice decision options:\n");
         H0("   --[no-]open-gop               Enable open-GOP, allows I slices to be non-IDR. Default %s\n", OPT(param->bOpenGOP));
@@ -687,6 +692,18 @@ namespace X265_NS {
                 OPT("dither") this->bDither = true;
                 OPT("recon-depth") reconFileBitDepth = (uint32_t)x265_atoi(optarg, bError);
                 OPT("y4m") this->bForceY4m = true;
+                OPT("input-io")
+                {
+                    int mode = 0;
+                    while (x265_input_io_names[mode] && strcmp(optarg, x265_input_io_names[mode]))
+                        mode++;
+                    if (!x265_input_io_names[mode])
+                    {
+                        x265_log(NULL, X265_LOG_ERROR, "invalid input-io mode <%s>\n", optarg);
+                        return true;
+                    }
+                    this->inputIOMode = mode;
+                }
                 OPT("profile") /* handled above */;
                 OPT("preset")  /* handled above */;
                 OPT("tune")    /* handled above */;
@@ -785,6 +802,7 @@ namespace X265_NS {
         info.sarWidth = param->vui.sarWidth;
         info.sarHeight = param->vui.sarHeight;
         info.skipFrames = seek;
+        info.ioMode = inputIOMode;
         info.frameCount = 0;
         getParamAspectRatio(param, info.sarWidth, info.sarHeight);
 
@@ -73,6 +73,9 @@ static const struct option long_options[] =
     { "no-allow-non-conformance",no_argument, NULL, 0 },
     { "csv",            required_argument, NULL, 0 },
     { "csv-log-level",  required_argument, NULL, 0 },
+    { "trace",          required_argument, NULL, 0 },
+    { "ctu-cost-map",         no_argument, NULL, 0 },
+    { "no-ctu-cost-map",      no_argument, NULL, 0 },
     { "no-cu-stats",          no_argument, NULL, 0 },
     { "cu-stats",             no_argument, NULL, 0 },
     { "y4m",                  no_argument, NULL, 0 },
@@ -83,6 +86,7 @@ static const struct option long_options[] =
     { "input-depth",    required_argument, NULL, 0 },
     { "input-res",      required_argument, NULL, 0 },
     { "input-csp",      required_argument, NULL, 0 },
+    { "input-io",       required_argument, NULL, 0 },
     { "interlace",      required_argument, NULL, 0 },
     { "no-interlace",         no_argument, NULL, 0 },
     { "field",                no_argument, NULL, 0 },
@@ -125,6 +129,8 @@ static const struct option long_options[] =
     { "tskip",                no_argument, NULL, 0 },
     { "no-tskip-fast",        no_argument, NULL, 0 },
     { "tskip-fast",           no_argument, NULL, 0 },
+    { "no-zero-block-skip",   no_argument, NULL, 0 },
+    { "zero-block-skip",      no_argument, NULL, 0 },
     { "cu-lossless",          no_argument, NULL, 0 },
     { "no-cu-lossless",       no_argument, NULL, 0 },
     { "no-constrained-intra", no_argument, NULL, 0 },
@@ -133,6 +139,7 @@ static const struct option long_options[] =
     { "no-cip",               no_argument, NULL, 0 },
     { "fast-intra",           no_argument, NULL, 0 },
     { "no-fast-intra",        no_argument, NULL, 0 },
+    { "intra-grad-modes",     required_argument, NULL, 0 },
     { "no-open-gop",          no_argument, NULL, 0 },
     { "open-gop",             no_argument, NULL, 0 },
     { "keyint",         required_argument, NULL, 'I' },
@@ -395,6 +402,7 @@ static const struct option long_options[] =
         bool bProgress;
         bool bForceY4m;
         bool bDither;
+        int inputIOMode;            // InputIOMode used to read the input file
         uint32_t seek;              // number of frames to skip from the beginning
         uint32_t framesToBeEncoded; // number of frames to encode
         uint64_t totalbytes;
@@ -436,6 +444,7 @@ static const struct option long_options[] =
             startTime = x265_mdate();
             prevUpdateTime = 0;
             bDither = false;
+            inputIOMode = INPUT_IO_STDIO;
             isAbrLadderConfig = false;
             enableScaler = false;
             encName = NULL;